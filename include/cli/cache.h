@@ -0,0 +1,54 @@
+/* gen_ignore: true */
+
+#ifndef __GRAMINA_CLI_CACHE_H
+#define __GRAMINA_CLI_CACHE_H
+
+#include <llvm-c/Types.h>
+
+#include "cli/state.h"
+
+#include "common/def.h"
+
+#ifdef GRAMINA_UNIX_BUILD
+#  include <pthread.h>
+#endif
+
+// Hex digest of everything that can change a unit's module
+#define CACHE_KEY_LENGTH 32
+
+/**
+ * On-disk store of optimised bitcode, one `<key>.bc` file per module, where
+ * the key hashes the source bytes together with the compiler build and the
+ * target/optimisation options. Files are written under a temporary name and
+ * renamed, so concurrent compilers sharing a directory never see partial
+ * entries. Loading an entry bumps its mtime, `cli_cache_trim` evicts the
+ * least recently used entries.
+ */
+struct CompileCache {
+    const char *dir;
+    size_t max_size;
+
+    size_t hits;
+    size_t misses;
+    size_t stores;
+    size_t evictions;
+    size_t n_temps;
+
+#ifdef GRAMINA_UNIX_BUILD
+    pthread_mutex_t lock;
+#endif
+};
+
+bool cli_cache_init(CompileCache *this, const char *dir, size_t max_size);
+
+void cli_cache_key(const CliState *S, const struct gramina_string_view *source, char *key);
+
+LLVMModuleRef cli_cache_load(CompileCache *this, const char *key, LLVMContextRef context);
+void cli_cache_store(CompileCache *this, const char *key, LLVMModuleRef mod);
+
+void cli_cache_trim(CompileCache *this);
+void cli_cache_report(const CompileCache *this);
+
+void cli_cache_free(CompileCache *this);
+
+#endif
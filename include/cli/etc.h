@@ -9,7 +9,11 @@
 
 bool cli_handle_args(CliState *S, int argc, char **argv);
 
-LLVMTargetMachineRef cli_get_machine();
+// Runs the whole pipeline on `S->sources` with `S->machine`, returns the exit status
+int cli_compile(CliState *S);
+
+LLVMTargetMachineRef cli_get_machine(const CliState *S);
+LLVMTargetMachineRef cli_dup_machine(const CliState *S);
 
 bool cli_link_objects(CliState *S, const struct gramina_string_view *files, size_t n_files);
 
@@ -0,0 +1,12 @@
+/* gen_ignore: true */
+
+#ifndef __GRAMINA_CLI_JOBS_H
+#define __GRAMINA_CLI_JOBS_H
+
+#include "cli/state.h"
+
+typedef bool (*JobProcessor)(CliState *S, void *data, size_t i);
+
+bool cli_run_jobs(CliState *S, size_t n_items, JobProcessor process, void *data);
+
+#endif
@@ -0,0 +1,30 @@
+/* gen_ignore: true */
+
+#ifndef __GRAMINA_CLI_SERVER_H
+#define __GRAMINA_CLI_SERVER_H
+
+#include "cli/state.h"
+
+#include "compiler/session.h"
+
+/**
+ * `gramina --server <socket>` stays resident and runs the compilations that
+ * clients forward to it, one at a time. LLVM's targets are initialised once,
+ * target machines are kept per CPU and optimisation level, and every source
+ * file keeps a compile session so unchanged functions aren't regenerated.
+ *
+ * A client passes its working directory, the environment variables the
+ * compilation reads, its arguments and its stdout and stderr, which the
+ * server writes to while handling the request. The exit status is sent back
+ * once it is done. A client the server doesn't pick up right away, because
+ * it is busy with another request, compiles locally instead of queueing.
+ */
+bool cli_serve(CliState *S);
+
+// Returns true if the server could not be reached, was busy or gave no answer
+bool cli_forward(CliState *S, int argc, char **argv, int *status);
+
+// NULL outside of the server
+struct gramina_compile_session *cli_server_session(CliState *S, const char *file);
+
+#endif
@@ -7,15 +7,39 @@
 
 #include "common/arg.h"
 
+typedef struct CompileCache CompileCache;
+typedef struct CliServer CliServer;
+
 typedef struct {
     struct gramina_array(_GraminaArgString) link_libs;
     struct gramina_array(_GraminaArgString) sources;
+
+    // Definitions that stay visible to the linker under LTO, besides `#extern` ones
+    struct gramina_array(_GraminaArgString) exports;
     const char *self_path;
     const char *out_file;
     const char *ast_dump_file;
     const char *ir_dump_file;
     const char *linker_prog;
 
+    // CPU the target machine is created for, "native" means the host
+    const char *cpu;
+
+    // NULL if caching is disabled, the cache size is in bytes
+    const char *cache_dir;
+    size_t cache_size;
+    CompileCache *cache;
+
+    // Unix socket `--server` listens on, and the one compilations are forwarded to
+    const char *server_socket;
+    const char *connect_socket;
+
+    // Only set while the server handles a request
+    CliServer *server;
+
+    // Number of translation units processed concurrently
+    size_t jobs;
+
     bool keep_temps;
     bool wants_help;
 
@@ -25,6 +49,21 @@ typedef struct {
         COMPILATION_STAGE_BIN,
     } max_stage;
 
+    enum {
+        OPT_LEVEL_0,
+        OPT_LEVEL_1,
+        OPT_LEVEL_2,
+        OPT_LEVEL_3,
+        OPT_LEVEL_S,
+    } opt_level;
+
+    // Whole program optimisation of the merged module in binary mode
+    enum {
+        LTO_NONE,
+        LTO_FULL,
+        LTO_THIN,
+    } lto;
+
     LLVMTargetMachineRef machine;
 } CliState;
 
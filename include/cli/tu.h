@@ -6,8 +6,11 @@
 #include <llvm-c/TargetMachine.h>
 #include <llvm-c/Types.h>
 
+#include "cli/cache.h"
 #include "cli/state.h"
 
+#include "common/mapped.h"
+
 #include "compiler/compiler.h"
 
 #include "parser/lexer.h"
@@ -20,11 +23,18 @@ typedef enum {
 
 typedef struct {
     const char *file;
-    struct gramina_stream fstream;
+    struct gramina_mapped_file source;
     struct gramina_lex_result lex_result;
     struct gramina_parse_result parse_result;
     struct gramina_compile_result compile_result;
+    LLVMContextRef context; // Owned, NULL if `module` belongs to another unit's context
     LLVMModuleRef module;
+
+    // Borrowed from the server, NULL when compiling outside of it
+    struct gramina_compile_session *session;
+
+    char cache_key[CACHE_KEY_LENGTH + 1];
+    bool from_cache; // `module` was loaded by `tu_cache_load`
 } TranslationUnit;
 
 GRAMINA_DECLARE_ARRAY(TranslationUnit);
@@ -34,6 +44,7 @@ typedef bool (*CompilationStageProcessor)(CliState *S, TranslationUnit *T);
 typedef struct {
     CompilationStageProcessor processor;
     const char *name;
+    bool skip_if_cached;
 } CompilationStage;
 
 GRAMINA_DECLARE_ARRAY(CompilationStage);
@@ -50,16 +61,29 @@ bool tu_load(CliState *S, TranslationUnit *T);
 bool tu_lex(CliState *S, TranslationUnit *T);
 bool tu_parse(CliState *S, TranslationUnit *T);
 bool tu_compile(CliState *S, TranslationUnit *T);
+bool tu_optimize(CliState *S, TranslationUnit *T);
+
+bool tu_cache_load(CliState *S, TranslationUnit *T);
+bool tu_cache_store(CliState *S, TranslationUnit *T);
 
 bool tu_pipe(CliState *S, const Pipeline *P, TranslationUnit *T);
+bool tu_pipe_all(CliState *S, const Pipeline *P, TranslationUnit *tus, size_t n_tus);
 
 bool tu_ast_log(CliState *S, TranslationUnit *T);
 bool tu_ast_dump(CliState *S, TranslationUnit *T);
 
 bool tu_ir_dump(CliState *S, TranslationUnit *T);
 
+// Links copies of the modules of `tus` into a new unit, leaving `tus` untouched
+bool tu_merge(CliState *S, TranslationUnit *out, TranslationUnit *tus, size_t n_tus);
+// Same as `tu_merge`, but consumes the modules of `tus` one at a time
 LLVMModuleRef tu_link(CliState *S, TranslationUnit *tus, size_t n_tus);
 bool tu_emit_objects(CliState *S, TranslationUnit *tus, size_t n_tus, ObjectFileType type);
+bool tu_lto(CliState *S, TranslationUnit *T);
+size_t tu_partition_count(CliState *S, TranslationUnit *T);
+bool tu_emit_partitions(CliState *S, TranslationUnit *T, char *const *files, size_t n_parts);
+
+// Consumes the modules of `tus`
 bool tu_emit_binary(CliState *S, TranslationUnit *tus, size_t n_tus);
 
 void tu_free(TranslationUnit *this);
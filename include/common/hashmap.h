@@ -3,14 +3,15 @@
 #ifndef gramina_hashmap_foreach
 #  define gramina_hashmap_foreach(T, _key, _value, hashmap) \
    GRAMINA_BEGIN_BLOCK_DECL() \
-   GRAMINA_BLOCK_DECL(struct gramina_string_view _key) \
+   GRAMINA_BLOCK_DECL(gramina_symbol _key) \
    GRAMINA_BLOCK_DECL(T *_value) \
    GRAMINA_BLOCK_DECL(struct gramina_hashmap __hashmap = (hashmap)) \
-   for (size_t __bi = 0; __bi < __hashmap.n_buckets; ++__bi) \
-   for (size_t __ii = 0; __ii < __hashmap.buckets[__bi].length \
-        && (_key = gramina_str_as_view(&__hashmap.buckets[__bi].items[__ii].key), \
-            _value = __hashmap.buckets[__bi].items[__ii].value); \
-        ++__ii) \
+   for (size_t __ii = 0; __ii < __hashmap.capacity; ++__ii) \
+   if (__hashmap.items[__ii].hash == 0) {} else \
+   for (bool __once = (_key = __hashmap.items[__ii].key, \
+                       _value = __hashmap.items[__ii].value, true); \
+        __once; \
+        __once = false) \
 
 #endif
 #if !defined(hashmap_foreach) && defined(GRAMINA_NO_NAMESPACE)
@@ -20,27 +21,46 @@
 #ifndef __GRAMINA_COMMON_HASHMAP_H
 #define __GRAMINA_COMMON_HASHMAP_H
 
-#include "array.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#include "intern.h"
+#include "mem.h"
 #include "str.h"
 
+/**
+ * `hash` is cached so that probing and growing never recompute it. Zero marks
+ * an empty slot, real hashes always have their top bit set.
+ */
 typedef struct {
-    struct gramina_string key;
+    gramina_symbol key;
+    uint32_t hash;
     void *value;
 } HashmapItem;
 
-GRAMINA_DECLARE_ARRAY(HashmapItem)
-
+/**
+ * Open-addressing table using Robin Hood probing. Keys are interned, so
+ * hashing and comparing them never touches the string. The table grows by
+ * doubling once it is 3/4 full, and removal shifts the following run back
+ * instead of leaving tombstones.
+ */
 struct gramina_hashmap {
-    size_t n_buckets;
-    struct gramina_array(HashmapItem) *buckets; // Array of arrays, not pointer to Array
+    size_t capacity; // Always zero or a power of two
+    size_t count;
+    HashmapItem *items;
     void (*object_freer)(void *);
 };
 
-struct gramina_hashmap gramina_mk_hashmap(size_t n_buckets);
+// `capacity` is only a hint, nothing is allocated until the first insertion
+struct gramina_hashmap gramina_mk_hashmap(size_t capacity);
 struct gramina_hashmap gramina_hashmap_dup(const struct gramina_hashmap *this);
 
 size_t gramina_hashmap_count(const struct gramina_hashmap *this);
 
+void gramina_hashmap_set_sym(struct gramina_hashmap *this, gramina_symbol key, void *value);
+void *gramina_hashmap_get_sym(const struct gramina_hashmap *this, gramina_symbol key);
+void gramina_hashmap_remove_sym(struct gramina_hashmap *this, gramina_symbol key);
+
 void gramina_hashmap_set(struct gramina_hashmap *this, struct gramina_string_view key, void *value);
 void *gramina_hashmap_get(const struct gramina_hashmap *this, struct gramina_string_view key);
 void gramina_hashmap_remove(struct gramina_hashmap *this, struct gramina_string_view key);
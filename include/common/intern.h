@@ -0,0 +1,42 @@
+#ifndef __GRAMINA_COMMON_INTERN_H
+#define __GRAMINA_COMMON_INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/str.h"
+
+/**
+ * Process-wide string interner. Every distinct string is stored once and
+ * identified by a small integer, so names can be compared with `==` and
+ * carried around without owning any memory. Symbols stay valid until
+ * `gramina_cleanup` is called.
+ */
+typedef uint32_t gramina_symbol;
+
+// Symbol of the empty string, also what zero-initialised symbols refer to
+#define GRAMINA_SYMBOL_EMPTY ((gramina_symbol)0)
+
+gramina_symbol gramina_intern(const struct gramina_string_view *str);
+gramina_symbol gramina_intern_c(const char *cstr);
+
+// The returned view is NUL terminated and lives as long as the interner
+struct gramina_string_view gramina_symbol_view(gramina_symbol symbol);
+const char *gramina_symbol_cstr(gramina_symbol symbol);
+
+size_t gramina_symbol_count();
+
+void __gramina_intern_cleanup(); /* ignore */
+
+#endif
+
+#if defined(GRAMINA_NO_NAMESPACE) && !defined(GRAMINA_SYMBOL_DEFINED)
+#  define GRAMINA_SYMBOL_DEFINED
+   typedef gramina_symbol Symbol;
+#endif
+#if defined(GRAMINA_WANT_TAGLESS) && !defined(GRAMINA_GSYMBOL_DEFINED)
+#  define GRAMINA_GSYMBOL_DEFINED
+   typedef gramina_symbol GraminaSymbol;
+#endif
+
+#include "gen/common/intern.h"
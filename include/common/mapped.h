@@ -0,0 +1,23 @@
+#ifndef __GRAMINA_COMMON_MAPPED_H
+#define __GRAMINA_COMMON_MAPPED_H
+
+#include <stdbool.h>
+
+#include "common/str.h"
+
+/**
+ * Read-only view of a whole file. On Unix builds the file is mmap'd and the
+ * kernel pages it in on demand, elsewhere it is read into a heap buffer.
+ * `contents` stays valid until `gramina_mapped_file_free` is called.
+ */
+struct gramina_mapped_file {
+    struct gramina_string_view contents;
+    bool is_mapped;
+};
+
+// Returns 0 on success and an errno value on failure
+int gramina_map_file(struct gramina_mapped_file *this, const char *filename);
+void gramina_mapped_file_free(struct gramina_mapped_file *this);
+
+#endif
+#include "gen/common/mapped.h"
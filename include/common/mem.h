@@ -18,5 +18,35 @@
 #endif
 #endif
 
+#include <stddef.h>
+
+#ifndef GRAMINA_ARENA_DEFAULT_BLOCK_SIZE
+#  define GRAMINA_ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+#endif
+
+#define GRAMINA_ARENA_ALIGNMENT 16
+
+struct gramina_arena_block;
+
+/**
+ * Bump allocator for objects that share a lifetime. Allocations are carved out
+ * of large blocks and cannot be freed individually; `gramina_arena_free`
+ * releases everything at once. A zero-initialised arena is valid and uses
+ * `GRAMINA_ARENA_DEFAULT_BLOCK_SIZE`.
+ */
+struct gramina_arena {
+    struct gramina_arena_block *head;
+    size_t block_size;
+};
+
+struct gramina_arena gramina_mk_arena(size_t block_size);
+void gramina_arena_free(struct gramina_arena *this);
+
+/**
+ * Returns zeroed memory aligned to `GRAMINA_ARENA_ALIGNMENT`, or `NULL` if the
+ * underlying allocation fails.
+ */
+void *gramina_arena_alloc(struct gramina_arena *this, size_t size);
+
 #endif
 #include "gen/common/mem.h"
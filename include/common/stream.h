@@ -9,6 +9,17 @@
 
 // All functions in this header return 0 on success and `EOF` on EOF, including callbacks
 
+/**
+ * Streams made with `gramina_mk_stream` (and every constructor built on it)
+ * buffer both directions. Buffered output reaches the writer when
+ *   - the buffer would overflow,
+ *   - a newline is written to a line buffered stream,
+ *   - the stream is read from,
+ *   - `gramina_stream_flush` or `gramina_stream_free` is called.
+ * Zero initialised streams have a buffer size of 0 and are unbuffered.
+ */
+#define GRAMINA_STREAM_DEFAULT_BUFFER_SIZE 4096
+
 struct gramina_stream;
 
 typedef int (*gramina_stream_reader)(struct gramina_stream *this, uint8_t *buf, size_t bufsize, size_t *read);
@@ -25,9 +36,13 @@ struct gramina_stream {
     gramina_stream_validator validator;
 
     void *userdata;
-    // TODO: proper buffering
-    // size_t max_buffered_bytes;
-    // struct gramina_string out_buffer;
+
+    size_t max_buffered_bytes;
+    bool line_buffered;
+    struct gramina_string out_buffer;
+    struct gramina_string in_buffer;
+    size_t in_buffer_idx;
+    int in_status; // What the reader returned when `in_buffer` was filled
 };
 
 struct gramina_stream gramina_mk_stream();
@@ -37,6 +52,9 @@ struct gramina_stream gramina_mk_stream_open_c(const char *filename, const char
 
 struct gramina_stream gramina_mk_stream_str_own(struct gramina_string str, bool readable, bool writable);
 
+// Flushes pending output before resizing, 0 disables buffering
+int gramina_stream_set_buffering(struct gramina_stream *this, size_t max_buffered_bytes, bool line_buffered);
+
 void gramina_stream_shrink(struct gramina_stream *this);
 void gramina_stream_free(struct gramina_stream *this);
 
@@ -44,6 +62,7 @@ bool gramina_stream_is_readable(const struct gramina_stream *this);
 bool gramina_stream_is_writable(const struct gramina_stream *this);
 bool gramina_stream_is_valid(const struct gramina_stream *this);
 
+// Hands buffered output to the writer, then calls the flusher
 int gramina_stream_flush(struct gramina_stream *this);
 
 int gramina_stream_write_sv(struct gramina_stream *this, const struct gramina_string_view *sv);
@@ -42,7 +42,10 @@ void gramina_free_compile_error(struct gramina_compile_error *this);
 
 struct gramina_compile_result gramina_compile(struct gramina_ast_node *root);
 struct gramina_compile_result gramina_compile_for_machine(struct gramina_ast_node *root, LLVMTargetMachineRef tm);
-struct gramina_compile_result gramina_compile(struct gramina_ast_node *root);
+struct gramina_compile_result gramina_compile_in_context(struct gramina_ast_node *root, LLVMTargetMachineRef tm, LLVMContextRef context);
+
+struct gramina_compile_session;
+struct gramina_compile_result gramina_compile_in_session(struct gramina_compile_session *session, struct gramina_ast_node *root, LLVMTargetMachineRef tm, LLVMContextRef context);
 
 #endif
 #include "gen/compiler/compiler.h"
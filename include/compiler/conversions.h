@@ -5,11 +5,14 @@
 #include "compiler/value.h"
 
 struct gramina_value gramina_primitive_convert(struct gramina_compiler_state *S, const struct gramina_value *from, const struct gramina_type *to);
+struct gramina_value gramina_vector_convert(struct gramina_compiler_state *S, const struct gramina_value *from, const struct gramina_type *to);
+struct gramina_value gramina_splat(struct gramina_compiler_state *S, const struct gramina_value *scalar, const struct gramina_type *to);
 struct gramina_value gramina_array_to_slice(struct gramina_compiler_state *S, const struct gramina_value *from, const struct gramina_type *slice_elem_type);
 bool gramina_convert_inplace(struct gramina_compiler_state *S, struct gramina_value *value, const struct gramina_type *to);
 struct gramina_value gramina_convert(struct gramina_compiler_state *S, const struct gramina_value *from, const struct gramina_type *to);
 
 struct gramina_coercion_result gramina_coerce_primitives(struct gramina_compiler_state *S, const struct gramina_value *left, const struct gramina_value *right, struct gramina_value *result_lhs, struct gramina_value *result_rhs);
+struct gramina_type gramina_coerce_vectors(struct gramina_compiler_state *S, const struct gramina_value *left, const struct gramina_value *right, struct gramina_value *result_lhs, struct gramina_value *result_rhs);
 
 struct gramina_value gramina_pointer_to_int(struct gramina_compiler_state *S, const struct gramina_value *ptr);
 
@@ -11,7 +11,9 @@
 
 #include "common/stream.h"
 
+#include "compiler/session.h"
 #include "compiler/typedecl.h"
+#include "compiler/typetable.h"
 
 struct gramina_reflection {
     size_t depth;
@@ -22,29 +24,36 @@ typedef struct gramina_reflection _GraminaReflection;
 GRAMINA_DECLARE_ARRAY(_GraminaReflection);
 
 struct gramina_compiler_state {
+    LLVMContextRef llvm_context;
     LLVMModuleRef llvm_module;
     LLVMBuilderRef llvm_builder;
+    LLVMBuilderRef llvm_alloca_builder; // Kept at the end of the current function's "alloc" block
     LLVMTargetMachineRef llvm_target_machine;
     LLVMTargetDataRef llvm_target_data;
 
+    // Functions it reuses are only declared, `NULL` outside of a session
+    const struct gramina_compile_session *session;
+
+    // Return slot optimisations, see `function_def` and `declaration_statement`
+    LLVMValueRef sret_destination; // Where the next aggregate-returning call writes, `NULL` for a temporary
+    gramina_symbol nrvo_local; // Local living in the current function's sret slot, if any
+    const struct gramina_type *nrvo_type;
+    size_t loop_depth;
+
     size_t reflection_depth;
     struct gramina_array(_GraminaReflection) reflection;
-    struct gramina_array(GraminaScope) scopes;
+    struct gramina_symbol_table symbols;
+    struct gramina_type_table types;
     struct gramina_compile_error error;
     int status;
     bool has_error;
 };
 
-#define GRAMINA_CURRENT_SCOPE(S) (array_last(GraminaScope, &(S)->scopes))
 #define GRAMINA_REFLECT(S, index) ((S)->reflection.items + (index))
 
 #endif
 #include "gen/compiler/cstate.h"
 
-#if !defined(CURRENT_SCOPE) && defined(GRAMINA_NO_NAMESPACE)
-#  define CURRENT_SCOPE(S) GRAMINA_CURRENT_SCOPE(S)
-#endif
-
 #if !defined(REFLECT) && defined(GRAMINA_NO_NAMESPACE)
 #  define REFLECT(S, index) GRAMINA_REFLECT(S, index)
 #endif
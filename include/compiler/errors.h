@@ -28,6 +28,11 @@ void gramina_err_no_attrib_arg(struct gramina_compiler_state *S, const struct gr
 void gramina_err_const_assign(struct gramina_compiler_state *S, const struct gramina_type *type);
 void gramina_err_discard_const(struct gramina_compiler_state *S, const struct gramina_type *from, const struct gramina_type *to);
 void gramina_err_bad_type(struct gramina_compiler_state *S, const struct gramina_type *type);
+void gramina_err_cannot_iterate(struct gramina_compiler_state *S, const struct gramina_type *type);
+void gramina_err_vector_lane(struct gramina_compiler_state *S, const struct gramina_type *type);
+void gramina_err_infer_vector(struct gramina_compiler_state *S, const struct gramina_string_view *builtin);
+void gramina_err_shuffle_index(struct gramina_compiler_state *S, size_t n_lanes);
+void gramina_err_not_vector(struct gramina_compiler_state *S, const struct gramina_type *type, const struct gramina_string_view *builtin);
 
 #endif
 #include "gen/compiler/errors.h"
@@ -9,5 +9,10 @@ void gramina_function_def(struct gramina_compiler_state *S, struct gramina_ast_n
 
 struct gramina_value gramina_call(struct gramina_compiler_state *S, const struct gramina_identifier *func, const struct gramina_value *args, size_t n_args);
 
+void gramina_function_strip_body(LLVMValueRef func);
+
+// Whether `func` was named with `#extern`
+bool gramina_function_is_extern(LLVMValueRef func);
+
 #endif
 #include "gen/compiler/function.h"
\ No newline at end of file
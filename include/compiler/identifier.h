@@ -33,8 +33,8 @@ struct gramina_identifier {
 
 GRAMINA_DECLARE_ARRAY(GraminaIdentifier);
 
-struct gramina_identifier *gramina_scope_resolve(const struct gramina_scope *this, const struct gramina_string_view *ident_name);
-struct gramina_identifier *gramina_resolve(const struct gramina_compiler_state *S, const struct gramina_string_view *ident_name);
+struct gramina_identifier *gramina_resolve(const struct gramina_compiler_state *S, gramina_symbol ident_name);
+struct gramina_identifier *gramina_resolve_local(const struct gramina_compiler_state *S, gramina_symbol ident_name);
 
 void gramina_identifier_free(struct gramina_identifier *this);
 
@@ -1,10 +1,24 @@
 #ifndef __GRAMINA_COMPILER_SCOPE_H
 
+#include <stdint.h>
+
 #include "common/array.h"
-#include "common/hashmap.h"
+#include "common/intern.h"
+
+struct gramina_identifier;
 
+/**
+ * A scope is only an undo marker into the symbol table's bindings, so
+ * entering one allocates nothing.
+ */
 struct gramina_scope {
-    struct gramina_hashmap identifiers;
+    size_t first_binding;
+};
+
+struct gramina_binding {
+    gramina_symbol name;
+    uint32_t shadowed; // Index + 1 of the binding hidden by this one, 0 if none
+    struct gramina_identifier *identifier;
 };
 
 #define GRAMINA_WANT_TAGLESS
@@ -16,9 +30,31 @@ struct gramina_scope {
 #undef GRAMINA_WANT_TAGLESS
 
 GRAMINA_DECLARE_ARRAY(GraminaScope);
+GRAMINA_DECLARE_ARRAY(GraminaBinding);
+
+/**
+ * Every identifier visible anywhere is a binding, in declaration order.
+ * `innermost` is indexed directly by symbol, so lookups never depend on
+ * the nesting depth. Popping a scope walks its own bindings back and
+ * restores whatever they shadowed.
+ */
+struct gramina_symbol_table {
+    struct gramina_array(GraminaScope) scopes;
+    struct gramina_array(GraminaBinding) bindings;
+    uint32_t *innermost; // Index + 1 of the visible binding, 0 if unbound
+    size_t n_innermost;
+};
+
+struct gramina_symbol_table gramina_mk_symbol_table();
+
+void gramina_symbol_table_push(struct gramina_symbol_table *this);
+void gramina_symbol_table_pop(struct gramina_symbol_table *this);
+
+void gramina_symbol_table_bind(struct gramina_symbol_table *this, gramina_symbol name, struct gramina_identifier *ident);
 
-struct gramina_scope gramina_mk_scope();
+struct gramina_identifier *gramina_symbol_table_get(const struct gramina_symbol_table *this, gramina_symbol name);
+struct gramina_identifier *gramina_symbol_table_get_local(const struct gramina_symbol_table *this, gramina_symbol name);
 
-void gramina_scope_free(struct gramina_scope *this);
+void gramina_symbol_table_free(struct gramina_symbol_table *this);
 
 #endif
@@ -0,0 +1,51 @@
+#ifndef __GRAMINA_COMPILER_SESSION_H
+#define __GRAMINA_COMPILER_SESSION_H
+
+#include <llvm-c/TargetMachine.h>
+#include <llvm-c/Types.h>
+
+#include "common/hashmap.h"
+#include "common/intern.h"
+
+#include "parser/ast.h"
+
+struct gramina_fingerprint {
+    uint64_t hash;
+    gramina_symbol cname; // Name of the LLVM function, `#extern` may change it
+    bool reuse;
+};
+
+/**
+ * Carries what compiling a source leaves behind for compiling it again, so a
+ * long-running process only regenerates the functions that changed.
+ *
+ * Every top-level function definition is fingerprinted from its AST along
+ * with the interfaces of the structs and functions it refers to. A function
+ * whose fingerprint did not change is only declared, and its body is linked
+ * in from the previous module afterwards.
+ */
+struct gramina_compile_session {
+    LLVMMemoryBufferRef previous; // Bitcode of the last module, before any optimisation
+    struct gramina_hashmap fingerprints; // Symbol -> struct gramina_fingerprint *, for `previous`
+    struct gramina_hashmap pending; // Same as above, for the compilation in progress
+
+    size_t n_reused;
+    size_t n_compiled;
+};
+
+struct gramina_compile_session gramina_mk_compile_session();
+void gramina_compile_session_free(struct gramina_compile_session *this);
+
+void gramina_session_prepare(struct gramina_compile_session *this, const struct gramina_ast_node *root, LLVMTargetMachineRef tm);
+bool gramina_session_reuses(const struct gramina_compile_session *this, gramina_symbol name);
+
+/**
+ * Completes `module` with the reused bodies and remembers it for the next
+ * compilation. Returns true on error, in which case the session is left as it
+ * was before `gramina_session_prepare`.
+ */
+bool gramina_session_commit(struct gramina_compile_session *this, LLVMModuleRef module, LLVMTargetMachineRef tm);
+void gramina_session_abort(struct gramina_compile_session *this);
+
+#endif
+#include "gen/compiler/session.h"
@@ -3,7 +3,7 @@
 
 #include "compiler/cstate.h"
 
-struct gramina_scope *gramina_push_scope(struct gramina_compiler_state *S);
+void gramina_push_scope(struct gramina_compiler_state *S);
 void gramina_pop_scope(struct gramina_compiler_state *S);
 
 void gramina_push_reflection(struct gramina_compiler_state *S, const struct gramina_type *type);
@@ -5,7 +5,7 @@
 #include "compiler/value.h"
 #include <llvm-c/Types.h>
 
-struct gramina_identifier *gramina_declaration(struct gramina_compiler_state *S, const struct gramina_string_view *name, const struct gramina_type *type, const struct gramina_value *init);
+struct gramina_identifier *gramina_declaration(struct gramina_compiler_state *S, gramina_symbol name, const struct gramina_type *type, const struct gramina_value *init, LLVMValueRef storage);
 
 void gramina_declaration_statement(struct gramina_compiler_state *S, LLVMValueRef function, struct gramina_ast_node *node);
 
@@ -17,6 +17,8 @@ void gramina_while_statement(struct gramina_compiler_state *S, LLVMValueRef func
 
 void gramina_for_statement(struct gramina_compiler_state *S, LLVMValueRef function, struct gramina_ast_node *node);
 
+void gramina_foreach_statement(struct gramina_compiler_state *S, LLVMValueRef function, struct gramina_ast_node *node);
+
 bool gramina_block(struct gramina_compiler_state *S, LLVMValueRef function, struct gramina_ast_node *node);
 
 #endif
@@ -6,6 +6,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "common/hashmap.h"
+
 #include "parser/ast.h"
 #include "compiler/scope.h"
 
@@ -17,6 +19,8 @@ enum gramina_primitive {
     GRAMINA_PRIMITIVE_USHORT,
     GRAMINA_PRIMITIVE_INT,
     GRAMINA_PRIMITIVE_UINT,
+    GRAMINA_PRIMITIVE_ISIZE, // As wide as a pointer, at most as wide as `long`
+    GRAMINA_PRIMITIVE_USIZE,
     GRAMINA_PRIMITIVE_LONG,
     GRAMINA_PRIMITIVE_ULONG,
     GRAMINA_PRIMITIVE_FLOAT,
@@ -28,6 +32,7 @@ enum gramina_type_kind {
     GRAMINA_TYPE_VOID,
     GRAMINA_TYPE_PRIMITIVE,
     GRAMINA_TYPE_ARRAY,
+    GRAMINA_TYPE_VECTOR,
     GRAMINA_TYPE_SLICE,
     GRAMINA_TYPE_POINTER,
     GRAMINA_TYPE_FUNCTION,
@@ -59,13 +64,13 @@ struct gramina_type {
         };
         /* POINTER */ struct gramina_type *pointer_type;
         /* SLICE */ struct gramina_type *slice_type;
-        /* ARRAY */ struct {
+        /* ARRAY, VECTOR */ struct {
             struct gramina_type *element_type;
             size_t length;
         };
         /* STRUCT */ struct {
             struct gramina_hashmap fields;
-            struct gramina_string struct_name;
+            gramina_symbol struct_name;
         };
         /* GENERIC */ struct {
             struct gramina_array(_GraminaType) generic_params;
@@ -0,0 +1,37 @@
+#ifndef __GRAMINA_COMPILER_TYPETABLE_H
+#define __GRAMINA_COMPILER_TYPETABLE_H
+
+#include <stdint.h>
+
+#include "common/mem.h"
+
+#include "compiler/typedecl.h"
+
+struct gramina_type_node;
+
+/**
+ * Holds one canonical copy of every type that another type refers to
+ * (pointees, elements, return types) and of every struct and function
+ * type. `Type` values only point into the table, so copying one is a
+ * plain struct copy and two canonical types are the same type exactly
+ * when their pointers are equal. Everything is released together with
+ * the table at the end of a compilation.
+ */
+struct gramina_type_table {
+    struct gramina_type_node **slots;
+    size_t n_slots;
+    size_t count;
+    struct gramina_arena nodes;
+};
+
+struct gramina_type_table gramina_mk_type_table();
+
+struct gramina_type *gramina_type_table_intern(struct gramina_type_table *this, struct gramina_type *shape);
+struct gramina_type *gramina_type_table_find(const struct gramina_type_table *this, const struct gramina_type *shape);
+
+const struct gramina_type *gramina_type_unqualified(const struct gramina_type *canonical);
+
+void gramina_type_table_free(struct gramina_type_table *this);
+
+#endif
+#include "gen/compiler/typetable.h"
@@ -47,7 +47,7 @@ void gramina_value_free(struct gramina_value *this);
 struct gramina_value gramina_value_dup(const struct gramina_value *this);
 struct gramina_value gramina_invalid_value();
 
-struct gramina_value gramina_mk_primitive_value(enum gramina_primitive primitive, union gramina_primitive_initialiser val);
+struct gramina_value gramina_mk_primitive_value(const struct gramina_compiler_state *S, enum gramina_primitive primitive, union gramina_primitive_initialiser val);
 
 #endif
 #include "gen/compiler/value.h"
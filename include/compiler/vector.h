@@ -0,0 +1,26 @@
+#ifndef __GRAMINA_COMPILER_VECTOR_H
+#define __GRAMINA_COMPILER_VECTOR_H
+
+#include <llvm-c/Types.h>
+
+#include "common/intern.h"
+
+#include "compiler/cstate.h"
+#include "compiler/value.h"
+
+/**
+ * Vector operations which have no operator are called like functions:
+ *
+ *     load(xs, i)               the lanes at `xs[i]` onwards, of the vector type expected in place
+ *     store(xs, i, v)           writes the lanes of `v` to `xs[i]` onwards
+ *     shuffle(a, [b,] i...)     picks lanes of `a`, then `b`, by literal indices
+ *     select(mask, a, b)        each lane from `a` where `mask` is set, from `b` otherwise
+ *
+ * `xs` may be an array, a slice or a pointer. These names are only looked up
+ * when no function with the same name is in scope.
+ */
+bool gramina_is_vector_builtin(gramina_symbol name);
+struct gramina_value gramina_vector_builtin_expr(struct gramina_compiler_state *S, LLVMValueRef function, struct gramina_ast_node *node);
+
+#endif
+#include "gen/compiler/vector.h"
@@ -4,6 +4,8 @@
 #include <stdint.h>
 
 #include "common/error.h"
+#include "common/intern.h"
+#include "common/mem.h"
 #include "common/stream.h"
 
 #include "parser/attributes.h"
@@ -28,6 +30,7 @@ enum gramina_ast_node_type {
 
     GRAMINA_AST_TYPE_SLICE,
     GRAMINA_AST_TYPE_ARRAY,
+    GRAMINA_AST_TYPE_VECTOR,
     GRAMINA_AST_TYPE_POINTER,
 
     GRAMINA_AST_CONTROL_FLOW,
@@ -38,6 +41,7 @@ enum gramina_ast_node_type {
     GRAMINA_AST_RETURN_STATEMENT,
     GRAMINA_AST_IF_STATEMENT,
     GRAMINA_AST_FOR_STATEMENT,
+    GRAMINA_AST_FOREACH_STATEMENT,
     GRAMINA_AST_WHILE_STATEMENT,
 
     GRAMINA_AST_ELSE_CLAUSE,
@@ -139,34 +143,42 @@ union gramina_ast_node_value {
 
     uint8_t _char;
 
-    size_t array_length;
+    uint64_t array_length;
 
     bool logical;
 
-    struct gramina_string string;
+    struct gramina_string_view string;
 
     struct {
-        struct gramina_string identifier;
-        struct gramina_array(_GraminaSymAttr) attributes;
+        gramina_symbol identifier;
+
+        // Out-of-line since few nodes carry any, `NULL` if there are none
+        struct gramina_array(_GraminaSymAttr) *attributes;
     };
 };
 
+/**
+ * Kept at 48 bytes: `type` and `flags` are narrowed to 16 bits and positions
+ * to 32 bits, identifiers are interned and attributes live out-of-line.
+ * Nodes have no parent pointer.
+ */
 struct gramina_ast_node {
-    uint64_t flags;
-
-    struct gramina_token_position pos;
+    struct gramina_ast_node *left;
+    struct gramina_ast_node *right;
 
-    enum gramina_ast_node_type type;
     union gramina_ast_node_value value;
+    struct gramina_token_position pos;
 
-    struct gramina_ast_node *parent;
-    struct gramina_ast_node *left;
-    struct gramina_ast_node *right;
+    uint16_t type; // enum gramina_ast_node_type
+    uint16_t flags; // enum gramina_ast_node_flag
 };
 
-struct gramina_ast_node *gramina_mk_ast_node(struct gramina_ast_node *parent);
-struct gramina_ast_node *gramina_mk_ast_node_lr(struct gramina_ast_node *parent, struct gramina_ast_node *l, struct gramina_ast_node *r);
-void gramina_ast_node_free(struct gramina_ast_node *this);
+/**
+ * Nodes, along with their identifiers, strings and attributes, are owned by
+ * `arena` and released together with it. There is no per-node free.
+ */
+struct gramina_ast_node *gramina_mk_ast_node(struct gramina_arena *arena, struct gramina_ast_node *parent);
+struct gramina_ast_node *gramina_mk_ast_node_lr(struct gramina_arena *arena, struct gramina_ast_node *parent, struct gramina_ast_node *l, struct gramina_ast_node *r);
 
 void gramina_ast_node_child_l(struct gramina_ast_node *this, struct gramina_ast_node *new_child);
 void gramina_ast_node_child_r(struct gramina_ast_node *this, struct gramina_ast_node *new_child);
@@ -22,6 +22,7 @@ typedef struct gramina_symbol_attribute _GraminaSymAttr;
 
 GRAMINA_DECLARE_ARRAY(_GraminaSymAttr);
 
+struct gramina_symbol_attribute gramina_symattr_dup(const struct gramina_symbol_attribute *this);
 void gramina_symattr_free(struct gramina_symbol_attribute *this);
 
 enum gramina_symbol_attribute_kind gramina_get_attrib_kind(const struct gramina_string_view *name);
@@ -4,6 +4,7 @@
 #define GRAMINA_WANT_TAGLESS
 
 #include "common/array.h"
+#include "common/str.h"
 #include "common/stream.h"
 #include "token.h"
 
@@ -19,13 +20,21 @@ enum gramina_lex_error_code {
     GRAMINA_LEX_ERR_OCCUPIED,
 };
 
+typedef struct gramina_string _GraminaLexLiteral;
+
+GRAMINA_DECLARE_ARRAY(_GraminaLexLiteral);
+
 struct gramina_lex_result {
-    GraminaArray(GraminaToken) tokens;
+    struct gramina_token_slab tokens;
+    GraminaArray(_GraminaLexLiteral) literals; // Unescaped string literals
+    struct gramina_string owned_source; // Only set by `gramina_lex`
     enum gramina_lex_error_code status;
     struct gramina_token_position error_position;
     struct gramina_string error_description;
 };
 
+// Token contents point into `source`, which must outlive the result
+struct gramina_lex_result gramina_lex_sv(const struct gramina_string_view *source);
 struct gramina_lex_result gramina_lex(GraminaStream *source);
 struct gramina_string_view gramina_lex_error_code_to_str(enum gramina_lex_error_code code);
 void gramina_lex_result_free(struct gramina_lex_result *this);
@@ -6,6 +6,7 @@
 
 #include "common/str.h"
 #include "common/array.h"
+#include "common/mem.h"
 
 struct gramina_parse_error {
     struct gramina_string description;
@@ -25,10 +26,16 @@ GRAMINA_DECLARE_ARRAY(GraminaParseError);
 struct gramina_parse_result {
     struct gramina_ast_node *root;
     struct gramina_parse_error error;
+
+    /**
+     * Owns every node reachable from `root`, released as a whole by
+     * `gramina_parse_result_free`
+     */
+    struct gramina_arena arena;
 };
 
 void gramina_parse_result_free(struct gramina_parse_result *this);
 
-struct gramina_parse_result gramina_parse(const GraminaSlice(GraminaToken) *tokens); /* symname: "gramina_parse" */
+struct gramina_parse_result gramina_parse(const struct gramina_token_slab *tokens); /* symname: "gramina_parse" */
 
 #endif
@@ -0,0 +1,38 @@
+#ifndef __GRAMINA_PARSER_SCAN_H
+#define __GRAMINA_PARSER_SCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Bulk character classification used by the lexer. Every kernel looks at
+ * `length` bytes starting from `data` and never reads past them. The best
+ * backend the CPU supports is picked on first use.
+ */
+enum gramina_scan_backend {
+    GRAMINA_SCAN_SCALAR,
+    GRAMINA_SCAN_SSE2,
+    GRAMINA_SCAN_AVX2,
+};
+
+// Returns false if the backend is not available on this machine
+bool gramina_scan_use_backend(enum gramina_scan_backend backend);
+enum gramina_scan_backend gramina_scan_current_backend();
+
+// Length of the leading run of ' ', '\t', '\n', '\v', '\f' and '\r'
+size_t gramina_scan_whitespace(const char *data, size_t length);
+// Length of the leading run of 'A-Za-z0-9_'
+size_t gramina_scan_word(const char *data, size_t length);
+// Length of the leading run of '0-9'
+size_t gramina_scan_digits(const char *data, size_t length);
+// Index of the first `a` or `b`, `length` if there is none
+size_t gramina_scan_until(const char *data, size_t length, char a, char b);
+
+/**
+ * Number of line breaks ('\n' or '\r') in the range. If there is at least
+ * one, `last` receives the index of the last of them.
+ */
+size_t gramina_scan_newlines(const char *data, size_t length, size_t *last);
+
+#endif
+#include "gen/parser/scan.h"
@@ -10,6 +10,7 @@
 #include "common/def.h"
 #include "common/str.h"
 #include "common/array.h"
+#include "common/intern.h"
 
 enum gramina_token_type {
     GRAMINA_TOK_EOF = -2,
@@ -114,10 +115,11 @@ enum gramina_token_type {
     GRAMINA_TOK_LIT_F64,
 };
 
+// Sources larger than 4 GiB are not supported
 struct gramina_token_position {
-    size_t line;
-    size_t column;
-    size_t depth;
+    uint32_t line;
+    uint32_t column;
+    uint32_t depth;
 };
 
 union gramina_token_data {
@@ -131,18 +133,42 @@ union gramina_token_data {
 
     float f32;
     double f64;
+
+    // Identifiers are interned as they are lexed
+    gramina_symbol symbol;
 };
 
+/**
+ * `contents` never owns its memory. It either points into the lexed source or,
+ * for string literals containing escapes, into storage owned by the lex result.
+ */
 struct gramina_token {
     enum gramina_token_type type;
-    struct gramina_string contents;
+    struct gramina_string_view contents;
     union gramina_token_data data;
-    uint64_t flags;
 
     struct gramina_token_position pos;
 };
 
-void gramina_token_free(struct gramina_token *this);
+/**
+ * Structure of arrays token storage, `types[i]`, `positions[i]`, `data[i]`
+ * and `contents[i]` together describe the `i`th token.
+ */
+struct gramina_token_slab {
+    size_t length;
+    size_t capacity;
+
+    enum gramina_token_type *types;
+    struct gramina_token_position *positions;
+    union gramina_token_data *data;
+    struct gramina_string_view *contents;
+};
+
+struct gramina_token_slab gramina_mk_token_slab(size_t capacity);
+void gramina_token_slab_reserve(struct gramina_token_slab *this, size_t capacity);
+void gramina_token_slab_push(struct gramina_token_slab *this, const struct gramina_token *tok);
+struct gramina_token gramina_token_slab_get(const struct gramina_token_slab *this, size_t index);
+void gramina_token_slab_free(struct gramina_token_slab *this);
 
 struct gramina_string_view gramina_token_type_to_str(enum gramina_token_type t);
 enum gramina_token_type gramina_classify_wordlike(const struct gramina_string_view *wordlike);
@@ -1,5 +1,6 @@
 #define GRAMINA_NO_NAMESPACE
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "cli/etc.h"
@@ -19,6 +20,17 @@ enum {
     LINK_LIB_ARG,
     LINKER_PROG_ARG,
     KEEP_TEMPS_ARG,
+    JOBS_ARG,
+    OPT_LEVEL_ARG,
+    MARCH_ARG,
+    MCPU_ARG,
+    LTO_ARG,
+    THIN_LTO_ARG,
+    EXPORT_ARG,
+    CACHE_ARG,
+    CACHE_SIZE_ARG,
+    SERVER_ARG,
+    CONNECT_ARG,
 };
 
 static bool determine_log_level(Arguments *args) {
@@ -84,6 +96,133 @@ static bool determine_max_stage(CliState *S, Arguments *args) {
     return false;
 }
 
+static bool determine_jobs(CliState *S, Arguments *args) {
+    ArgumentInfo *jobs_arg = &args->named.items[JOBS_ARG];
+
+    if (!jobs_arg->found) {
+        S->jobs = 1;
+        return false;
+    }
+
+    char *end;
+    unsigned long jobs = strtoul(jobs_arg->param, &end, 10);
+    if (*jobs_arg->param == '\0' || *end != '\0' || jobs == 0) {
+        elog_fmt("Invalid job count '{cstr}'\n", jobs_arg->param);
+        return true;
+    }
+
+    S->jobs = jobs;
+
+    // Every translation unit would race to overwrite the same dump file
+    if (S->jobs > 1 && (S->ast_dump_file || S->ir_dump_file)) {
+        wlog_fmt("'--ast-dump' and '--ir-dump' override '-j'\n");
+        S->jobs = 1;
+    }
+
+    return false;
+}
+
+static bool determine_opt_level(CliState *S, Arguments *args) {
+    ArgumentInfo *opt_level_arg = &args->named.items[OPT_LEVEL_ARG];
+
+    if (!opt_level_arg->found) {
+        S->opt_level = OPT_LEVEL_0;
+        return false;
+    }
+
+    if (false) {
+    } else if (strcmp(opt_level_arg->param, "0") == 0) {
+        S->opt_level = OPT_LEVEL_0;
+    } else if (strcmp(opt_level_arg->param, "1") == 0) {
+        S->opt_level = OPT_LEVEL_1;
+    } else if (strcmp(opt_level_arg->param, "2") == 0) {
+        S->opt_level = OPT_LEVEL_2;
+    } else if (strcmp(opt_level_arg->param, "3") == 0) {
+        S->opt_level = OPT_LEVEL_3;
+    } else if (strcmp(opt_level_arg->param, "s") == 0) {
+        S->opt_level = OPT_LEVEL_S;
+    } else {
+        elog_fmt("Unknown optimisation level '{cstr}'\n", opt_level_arg->param);
+        return true;
+    }
+
+    return false;
+}
+
+static bool determine_cpu(CliState *S, Arguments *args) {
+    ArgumentInfo *march_arg = &args->named.items[MARCH_ARG];
+    ArgumentInfo *mcpu_arg = &args->named.items[MCPU_ARG];
+
+    S->cpu = "generic";
+
+    if (mcpu_arg->found) {
+        S->cpu = mcpu_arg->param;
+    }
+
+    if (march_arg->found) {
+        S->cpu = march_arg->param;
+
+        if (mcpu_arg->found) {
+            wlog_fmt("'--march' will override '--mcpu'\n");
+        }
+    }
+
+    return false;
+}
+
+static bool determine_lto(CliState *S, Arguments *args) {
+    ArgumentInfo *lto_arg = &args->named.items[LTO_ARG];
+    ArgumentInfo *thin_lto_arg = &args->named.items[THIN_LTO_ARG];
+
+    S->lto = LTO_NONE;
+
+    if (lto_arg->found) {
+        S->lto = LTO_FULL;
+    }
+
+    if (thin_lto_arg->found) {
+        S->lto = LTO_THIN;
+
+        if (lto_arg->found) {
+            wlog_fmt("'--thin-lto' will override '--lto'\n");
+        }
+    }
+
+    // Objects are never merged, so the pre-link pipeline would only lose optimisations
+    if (S->lto != LTO_NONE && S->max_stage != COMPILATION_STAGE_BIN) {
+        wlog_fmt("Link-time optimisation only applies when emitting a binary\n");
+        S->lto = LTO_NONE;
+    }
+
+    return false;
+}
+
+static bool determine_cache(CliState *S, Arguments *args) {
+    ArgumentInfo *cache_arg = &args->named.items[CACHE_ARG];
+    ArgumentInfo *cache_size_arg = &args->named.items[CACHE_SIZE_ARG];
+
+    S->cache_dir = cache_arg->found
+                 ? cache_arg->param
+                 : getenv("GRAMINA_CACHE_DIR");
+
+    S->cache_size = 512;
+    if (cache_size_arg->found) {
+        char *end;
+        unsigned long size = strtoul(cache_size_arg->param, &end, 10);
+        if (*cache_size_arg->param == '\0' || *end != '\0') {
+            elog_fmt("Invalid cache size '{cstr}'\n", cache_size_arg->param);
+            return true;
+        }
+
+        S->cache_size = size;
+    }
+
+    // Given in MiB
+    S->cache_size *= 1024 * 1024;
+
+    return false;
+}
+
 static bool populate_fields(CliState *S, Arguments *args) {
     ArgumentInfo *help_arg = &args->named.items[HELP_ARG];
 
@@ -99,7 +238,19 @@ static bool populate_fields(CliState *S, Arguments *args) {
         return false;
     }
 
-    if (args->positional.length == 0) {
+    ArgumentInfo *server_arg = &args->named.items[SERVER_ARG];
+    ArgumentInfo *connect_arg = &args->named.items[CONNECT_ARG];
+
+    S->server_socket = server_arg->found
+                     ? server_arg->param
+                     : NULL;
+
+    S->connect_socket = connect_arg->found
+                      ? connect_arg->param
+                      : getenv("GRAMINA_SERVER");
+
+    // The server gets its files from each request
+    if (args->positional.length == 0 && !S->server_socket) {
         elog_fmt("Missing file argument\n");
         return true;
     }
@@ -139,6 +290,26 @@ static bool populate_fields(CliState *S, Arguments *args) {
         return true;
     }
 
+    if (determine_jobs(S, args)) {
+        return true;
+    }
+
+    if (determine_opt_level(S, args)) {
+        return true;
+    }
+
+    if (determine_cpu(S, args)) {
+        return true;
+    }
+
+    if (determine_lto(S, args)) {
+        return true;
+    }
+
+    if (determine_cache(S, args)) {
+        return true;
+    }
+
     return false;
 }
 
@@ -207,6 +378,75 @@ bool cli_handle_args(CliState *S, int argc, char **argv) {
             .param_needs = GRAMINA_PARAM_NONE,
             .override_behavior = GRAMINA_OVERRIDE_OK,
         },
+        [JOBS_ARG] = {
+            .flag = 'j',
+            .name = "jobs",
+            .type = GRAMINA_ARG_FLAG | GRAMINA_ARG_LONG,
+            .param_needs = GRAMINA_PARAM_REQUIRED,
+            .override_behavior = GRAMINA_OVERRIDE_WARN,
+        },
+        [OPT_LEVEL_ARG] = {
+            .flag = 'O',
+            .name = "opt-level",
+            .type = GRAMINA_ARG_FLAG | GRAMINA_ARG_LONG,
+            .param_needs = GRAMINA_PARAM_REQUIRED,
+            .override_behavior = GRAMINA_OVERRIDE_OK,
+        },
+        [MARCH_ARG] = {
+            .name = "march",
+            .type = GRAMINA_ARG_LONG,
+            .param_needs = GRAMINA_PARAM_REQUIRED,
+            .override_behavior = GRAMINA_OVERRIDE_WARN,
+        },
+        [MCPU_ARG] = {
+            .name = "mcpu",
+            .type = GRAMINA_ARG_LONG,
+            .param_needs = GRAMINA_PARAM_REQUIRED,
+            .override_behavior = GRAMINA_OVERRIDE_WARN,
+        },
+        [LTO_ARG] = {
+            .name = "lto",
+            .type = GRAMINA_ARG_LONG,
+            .param_needs = GRAMINA_PARAM_NONE,
+            .override_behavior = GRAMINA_OVERRIDE_OK,
+        },
+        [THIN_LTO_ARG] = {
+            .name = "thin-lto",
+            .type = GRAMINA_ARG_LONG,
+            .param_needs = GRAMINA_PARAM_NONE,
+            .override_behavior = GRAMINA_OVERRIDE_OK,
+        },
+        [EXPORT_ARG] = {
+            .name = "export",
+            .type = GRAMINA_ARG_LONG,
+            .param_needs = GRAMINA_PARAM_MULTI,
+            .override_behavior = GRAMINA_OVERRIDE_OK,
+            .multi_params = &S->exports,
+        },
+        [CACHE_ARG] = {
+            .name = "cache",
+            .type = GRAMINA_ARG_LONG,
+            .param_needs = GRAMINA_PARAM_REQUIRED,
+            .override_behavior = GRAMINA_OVERRIDE_WARN,
+        },
+        [CACHE_SIZE_ARG] = {
+            .name = "cache-size",
+            .type = GRAMINA_ARG_LONG,
+            .param_needs = GRAMINA_PARAM_REQUIRED,
+            .override_behavior = GRAMINA_OVERRIDE_WARN,
+        },
+        [SERVER_ARG] = {
+            .name = "server",
+            .type = GRAMINA_ARG_LONG,
+            .param_needs = GRAMINA_PARAM_REQUIRED,
+            .override_behavior = GRAMINA_OVERRIDE_FORBID,
+        },
+        [CONNECT_ARG] = {
+            .name = "connect",
+            .type = GRAMINA_ARG_LONG,
+            .param_needs = GRAMINA_PARAM_REQUIRED,
+            .override_behavior = GRAMINA_OVERRIDE_WARN,
+        },
     };
 
     Arguments args = {
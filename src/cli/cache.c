@@ -0,0 +1,326 @@
+#define GRAMINA_NO_NAMESPACE
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <llvm-c/BitReader.h>
+#include <llvm-c/BitWriter.h>
+#include <llvm-c/Core.h>
+#include <llvm-c/TargetMachine.h>
+
+#include "cli/cache.h"
+
+#include "common/array.h"
+#include "common/log.h"
+#include "common/mem.h"
+
+#ifdef GRAMINA_UNIX_BUILD
+#  include <dirent.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  include <utime.h>
+
+#  define LOCK(C) pthread_mutex_lock(&(C)->lock)
+#  define UNLOCK(C) pthread_mutex_unlock(&(C)->lock)
+#else
+#  define LOCK(C)
+#  define UNLOCK(C)
+#endif
+
+#define ENTRY_EXTENSION ".bc"
+
+// Two independent 64-bit hashes, FNV-1a and a multiplicative one
+typedef struct {
+    uint64_t a;
+    uint64_t b;
+} Digest;
+
+static void digest_bytes(Digest *this, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+
+    for (size_t i = 0; i < size; ++i) {
+        this->a = (this->a ^ bytes[i]) * 0x100000001b3ULL;
+
+        this->b = (this->b + bytes[i] + 1) * 0x9e3779b97f4a7c15ULL;
+        this->b ^= this->b >> 29;
+    }
+}
+
+// Fields are length-prefixed so that no two sequences of them digest the same bytes
+static void digest_field(Digest *this, const void *data, size_t size) {
+    uint64_t size64 = size;
+    digest_bytes(this, &size64, sizeof size64);
+    digest_bytes(this, data, size);
+}
+
+static void digest_cstr(Digest *this, const char *str) {
+    digest_field(this, str, strlen(str));
+}
+
+// Rebuilding the compiler without bumping its version must not reuse old entries
+static void digest_self(Digest *this, const CliState *S) {
+#ifdef GRAMINA_UNIX_BUILD
+    struct stat info;
+    if (stat("/proc/self/exe", &info) == 0
+     || (S->self_path && stat(S->self_path, &info) == 0)) {
+        uint64_t identity[] = {
+            (uint64_t)info.st_size,
+            (uint64_t)info.st_mtime,
+        };
+
+        digest_field(this, identity, sizeof identity);
+    }
+#endif
+}
+
+static char *entry_path(const CompileCache *this, const char *name, const char *suffix) {
+    String path = str_cfmt("{cstr}/{cstr}{cstr}", this->dir, name, suffix);
+    char *path_cstr = str_to_cstr(&path);
+    str_free(&path);
+
+    return path_cstr;
+}
+
+bool cli_cache_init(CompileCache *this, const char *dir, size_t max_size) {
+#ifdef GRAMINA_UNIX_BUILD
+    if (mkdir(dir, 0755) && errno != EEXIST) {
+        elog_fmt("Cannot create cache directory '{cstr}': {cstr}\n", dir, strerror(errno));
+        return true;
+    }
+
+    *this = (CompileCache) {
+        .dir = dir,
+        .max_size = max_size,
+    };
+
+    pthread_mutex_init(&this->lock, NULL);
+
+    return false;
+#else
+    wlog_fmt("The compilation cache isn't supported on non-POSIX systems\n");
+    return true;
+#endif
+}
+
+void cli_cache_key(const CliState *S, const StringView *source, char *key) {
+    Digest digest = {
+        .a = 0xcbf29ce484222325ULL,
+        .b = 0x2545f4914f6cdd1dULL,
+    };
+
+    digest_cstr(&digest, GRAMINA_VERSION);
+    digest_self(&digest, S);
+
+    char *triple = LLVMGetTargetMachineTriple(S->machine);
+    char *cpu = LLVMGetTargetMachineCPU(S->machine);
+    char *features = LLVMGetTargetMachineFeatureString(S->machine);
+
+    digest_cstr(&digest, triple);
+    digest_cstr(&digest, cpu);
+    digest_cstr(&digest, features);
+
+    LLVMDisposeMessage(triple);
+    LLVMDisposeMessage(cpu);
+    LLVMDisposeMessage(features);
+
+    uint32_t options[] = {
+        S->opt_level,
+        S->lto,
+    };
+
+    digest_field(&digest, options, sizeof options);
+    digest_field(&digest, source->data, source->length);
+
+    snprintf(
+        key, CACHE_KEY_LENGTH + 1, "%016llx%016llx",
+        (unsigned long long)digest.a,
+        (unsigned long long)digest.b
+    );
+}
+
+// LLVM's default handler exits on errors, but a bad entry is only a miss
+static void ignore_diagnostic(LLVMDiagnosticInfoRef info, void *_) {}
+
+LLVMModuleRef cli_cache_load(CompileCache *this, const char *key, LLVMContextRef context) {
+    char *path = entry_path(this, key, ENTRY_EXTENSION);
+
+    LLVMMemoryBufferRef bitcode;
+    char *err;
+    if (LLVMCreateMemoryBufferWithContentsOfFile(path, &bitcode, &err)) {
+        LLVMDisposeMessage(err);
+        gramina_free(path);
+
+        LOCK(this);
+        ++this->misses;
+        UNLOCK(this);
+
+        return NULL;
+    }
+
+    LLVMDiagnosticHandler old_handler = LLVMContextGetDiagnosticHandler(context);
+    void *old_context = LLVMContextGetDiagnosticContext(context);
+    LLVMContextSetDiagnosticHandler(context, ignore_diagnostic, NULL);
+
+    LLVMModuleRef mod;
+    if (LLVMParseBitcodeInContext2(context, bitcode, &mod)) {
+        wlog_fmt("Removing unreadable cache entry '{cstr}'\n", path);
+        remove(path);
+        mod = NULL;
+    }
+
+    LLVMContextSetDiagnosticHandler(context, old_handler, old_context);
+
+#ifdef GRAMINA_UNIX_BUILD
+    if (mod) {
+        utime(path, NULL);
+    }
+#endif
+
+    LLVMDisposeMemoryBuffer(bitcode);
+    gramina_free(path);
+
+    LOCK(this);
+    if (mod) {
+        ++this->hits;
+    } else {
+        ++this->misses;
+    }
+    UNLOCK(this);
+
+    return mod;
+}
+
+void cli_cache_store(CompileCache *this, const char *key, LLVMModuleRef mod) {
+    LOCK(this);
+    size_t temp_id = this->n_temps++;
+    UNLOCK(this);
+
+    String suffix = str_cfmt(ENTRY_EXTENSION ".{u64}.{sz}.tmp", (uint64_t)getpid(), temp_id);
+    char *suffix_cstr = str_to_cstr(&suffix);
+    str_free(&suffix);
+
+    char *temp_path = entry_path(this, key, suffix_cstr);
+    char *path = entry_path(this, key, ENTRY_EXTENSION);
+
+    // A failed store only costs a recompilation next time
+    if (LLVMWriteBitcodeToFile(mod, temp_path) || rename(temp_path, path)) {
+        wlog_fmt("Failed to write cache entry '{cstr}'\n", path);
+        remove(temp_path);
+    } else {
+        LOCK(this);
+        ++this->stores;
+        UNLOCK(this);
+    }
+
+    gramina_free(suffix_cstr);
+    gramina_free(temp_path);
+    gramina_free(path);
+}
+
+#ifdef GRAMINA_UNIX_BUILD
+
+typedef struct {
+    char *path;
+    size_t size;
+    time_t mtime;
+} Entry;
+
+GRAMINA_DECLARE_ARRAY(Entry, static);
+GRAMINA_IMPLEMENT_ARRAY(Entry, static);
+
+static int older_first(const void *_a, const void *_b) {
+    const Entry *a = _a;
+    const Entry *b = _b;
+
+    if (a->mtime != b->mtime) {
+        return a->mtime < b->mtime ? -1 : 1;
+    }
+
+    return strcmp(a->path, b->path);
+}
+
+static bool is_entry(const char *name) {
+    size_t length = strlen(name);
+    size_t ext_length = strlen(ENTRY_EXTENSION);
+
+    return length == CACHE_KEY_LENGTH + ext_length
+        && strcmp(name + CACHE_KEY_LENGTH, ENTRY_EXTENSION) == 0;
+}
+
+#endif
+
+// Removes the least recently used entries until the cache fits in `max_size`
+void cli_cache_trim(CompileCache *this) {
+#ifdef GRAMINA_UNIX_BUILD
+    DIR *dir = opendir(this->dir);
+    if (!dir) {
+        wlog_fmt("Cannot open cache directory '{cstr}': {cstr}\n", this->dir, strerror(errno));
+        return;
+    }
+
+    Array(Entry) entries = mk_array(Entry);
+    size_t total_size = 0;
+
+    struct dirent *dirent;
+    while ((dirent = readdir(dir))) {
+        if (!is_entry(dirent->d_name)) {
+            continue;
+        }
+
+        char *path = entry_path(this, dirent->d_name, "");
+
+        struct stat info;
+        if (stat(path, &info)) {
+            gramina_free(path);
+            continue;
+        }
+
+        array_append(Entry, &entries, ((Entry) {
+            .path = path,
+            .size = info.st_size,
+            .mtime = info.st_mtime,
+        }));
+
+        total_size += info.st_size;
+    }
+
+    closedir(dir);
+
+    if (total_size > this->max_size) {
+        qsort(entries.items, entries.length, sizeof *entries.items, older_first);
+
+        array_foreach_ref(Entry, _, entry, entries) {
+            if (total_size <= this->max_size) {
+                break;
+            }
+
+            if (remove(entry->path) == 0) {
+                total_size -= entry->size;
+                ++this->evictions;
+            }
+        }
+    }
+
+    array_foreach_ref(Entry, _, entry, entries) {
+        gramina_free(entry->path);
+    }
+
+    array_free(Entry, &entries);
+#endif
+}
+
+void cli_cache_report(const CompileCache *this) {
+    ilog_fmt(
+        "Cache: {sz} hits, {sz} misses, {sz} stored, {sz} evicted\n",
+        this->hits, this->misses, this->stores, this->evictions
+    );
+}
+
+void cli_cache_free(CompileCache *this) {
+#ifdef GRAMINA_UNIX_BUILD
+    pthread_mutex_destroy(&this->lock);
+#endif
+}
@@ -0,0 +1,92 @@
+#define GRAMINA_NO_NAMESPACE
+
+#include "cli/cache.h"
+#include "cli/etc.h"
+#include "cli/server.h"
+#include "cli/state.h"
+#include "cli/tu.h"
+
+#include "common/log.h"
+
+static void finish_cache(CliState *S) {
+    if (!S->cache) {
+        return;
+    }
+
+    cli_cache_trim(S->cache);
+    cli_cache_report(S->cache);
+    cli_cache_free(S->cache);
+    S->cache = NULL;
+}
+
+int cli_compile(CliState *S) {
+    CompileCache cache;
+    if (S->cache_dir && !cli_cache_init(&cache, S->cache_dir, S->cache_size)) {
+        S->cache = &cache;
+    }
+
+    Pipeline P = pipeline_default(S);
+
+    TranslationUnit tus[S->sources.length];
+    const size_t length = (sizeof tus) / (sizeof tus[0]);
+
+    array_foreach(_GraminaArgString, i, source, S->sources) {
+        tus[i] = (TranslationUnit) {
+            .file = source,
+            .session = cli_server_session(S, source),
+        };
+
+        // A file given twice would have both units race on the same session
+        for (size_t j = 0; j < i; ++j) {
+            if (tus[j].session == tus[i].session) {
+                tus[i].session = NULL;
+                break;
+            }
+        }
+    }
+
+    if (tu_pipe_all(S, &P, tus, length)) {
+        for (size_t i = 0; i < length; ++i) {
+            tu_free(tus + i);
+        }
+
+        pipeline_free(&P);
+        finish_cache(S);
+
+        return 1;
+    }
+
+    bool err = false;
+    const char *emit_type;
+    if (S->max_stage == COMPILATION_STAGE_OBJ
+     || S->max_stage == COMPILATION_STAGE_ASM) {
+        emit_type = S->max_stage == COMPILATION_STAGE_OBJ
+                  ? "object"
+                  : "assembly";
+
+        err = tu_emit_objects(
+            S, tus, length,
+            S->max_stage == COMPILATION_STAGE_OBJ
+                ? OBJECT_FILE
+                : ASM_FILE
+        );
+    } else {
+        emit_type = "binary";
+        err = tu_emit_binary(S, tus, length);
+    }
+
+    int status = 0;
+    if (err) {
+        elog_fmt("Failed to emit {cstr} file\n", emit_type);
+        status = 1;
+    }
+
+    for (size_t i = 0; i < length; ++i) {
+        tu_free(tus + i);
+    }
+
+    pipeline_free(&P);
+    finish_cache(S);
+
+    return status;
+}
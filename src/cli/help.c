@@ -21,6 +21,19 @@ void cli_show_general_help() {
         "\t-s, --stage [stage]              Set the stage at which the compilation will stop\n"
         "\t--linker [prog]                  Use the given program as the linker\n"
         "\t--keep-temps                     Do not remove temporary object files created after use\n"
+        "\t-j, --jobs [n]                   Compile source files and generate code on up to n threads\n"
+        "\t-O, --opt-level [level]          Set the optimisation level (`--help opt-level` for more information)\n"
+        "\t--march [cpu], --mcpu [cpu]      Generate code for the given CPU, 'native' selects the host\n"
+        "\t--lto                            Optimise the whole program after merging source files\n"
+        "\t--thin-lto                       Like '--lto', but using LLVM's ThinLTO pipelines\n"
+        "\t--export [symbol]                Keep the definition of symbol visible to linked libraries under LTO\n"
+        "\t                                 '_start', 'main' and '#extern' functions are always kept\n"
+        "\t--cache [dir]                    Reuse modules compiled from identical sources, kept in dir\n"
+        "\t                                 Defaults to $GRAMINA_CACHE_DIR, caching is disabled if neither is set\n"
+        "\t--cache-size [MiB]               Evict the least recently used cache entries beyond this size (default: 512)\n"
+        "\t--server [socket]                Stay resident and compile for clients connecting to the given Unix socket\n"
+        "\t--connect [socket]               Have the server listening on the given socket compile instead\n"
+        "\t                                 Defaults to $GRAMINA_SERVER, compiles locally if the server is busy or can't be reached\n"
         "";
 
     printf("%s", help);
@@ -33,6 +46,7 @@ void cli_show_specific_help(const char *topic) {
             "List of available help topics:\n"
             "\thelp\n"
             "\tlog-level\n"
+            "\topt-level\n"
             "\tstage\n"
             "";
 
@@ -51,6 +65,19 @@ void cli_show_specific_help(const char *topic) {
 
         printf("%s", log_level_help);
 
+    } else if (strcmp(topic, "opt-level") == 0) {
+        const char *opt_level_help =
+            "List of available optimisation levels:\n"
+            "\t0 (default, no optimisation passes are run)\n"
+            "\t1\n"
+            "\t2\n"
+            "\t3\n"
+            "\ts (optimise for size)\n"
+            "The level may be attached to the flag, as in '-O2'\n"
+            "";
+
+        printf("%s", opt_level_help);
+
     } else if (strcmp(topic, "stage") == 0) {
         const char *stage_help =
             "List of available stages:\n"
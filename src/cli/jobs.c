@@ -0,0 +1,120 @@
+#define GRAMINA_NO_NAMESPACE
+
+#include "cli/etc.h"
+#include "cli/jobs.h"
+
+#include "common/def.h"
+#include "common/log.h"
+
+#ifdef GRAMINA_UNIX_BUILD
+#  include <pthread.h>
+#endif
+
+#ifdef GRAMINA_UNIX_BUILD
+
+typedef struct {
+    CliState *S;
+    JobProcessor process;
+    void *data;
+    size_t n_items;
+
+    pthread_mutex_t lock;
+    size_t next;
+    bool failed;
+} JobQueue;
+
+static void fail(JobQueue *Q) {
+    pthread_mutex_lock(&Q->lock);
+    Q->failed = true;
+    pthread_mutex_unlock(&Q->lock);
+}
+
+static void *job_worker(void *_queue) {
+    JobQueue *Q = _queue;
+
+    // Everything but the target machine is shared with the other workers
+    CliState S = *Q->S;
+    S.machine = cli_dup_machine(Q->S);
+    if (!S.machine) {
+        fail(Q);
+        return NULL;
+    }
+
+    while (true) {
+        pthread_mutex_lock(&Q->lock);
+        size_t i = Q->next++;
+        bool stop = Q->failed;
+        pthread_mutex_unlock(&Q->lock);
+
+        if (stop || i >= Q->n_items) {
+            break;
+        }
+
+        if (Q->process(&S, Q->data, i)) {
+            fail(Q);
+        }
+    }
+
+    LLVMDisposeTargetMachine(S.machine);
+
+    return NULL;
+}
+
+#endif
+
+/**
+ * Calls `process` for every item in [0, n_items), on up to `S->jobs`
+ * threads. Each thread gets a shallow copy of `S` with a target machine of
+ * its own, items must not touch LLVM state another item uses. No new item
+ * is started after a failure.
+ */
+bool cli_run_jobs(CliState *S, size_t n_items, JobProcessor process, void *data) {
+    size_t n_workers = S->jobs < n_items
+                     ? S->jobs
+                     : n_items;
+
+#ifdef GRAMINA_UNIX_BUILD
+    if (n_workers > 1) {
+        JobQueue Q = {
+            .S = S,
+            .process = process,
+            .data = data,
+            .n_items = n_items,
+            .next = 0,
+            .failed = false,
+        };
+
+        pthread_mutex_init(&Q.lock, NULL);
+
+        pthread_t workers[n_workers];
+        size_t n_started = 0;
+        for (; n_started < n_workers; ++n_started) {
+            if (pthread_create(workers + n_started, NULL, job_worker, &Q)) {
+                break;
+            }
+        }
+
+        // Whatever couldn't be handed to a thread is processed here
+        if (n_started < n_workers) {
+            wlog_fmt("Started {sz} of {sz} jobs\n", n_started, n_workers);
+            job_worker(&Q);
+        }
+
+        for (size_t i = 0; i < n_started; ++i) {
+            pthread_join(workers[i], NULL);
+        }
+
+        pthread_mutex_destroy(&Q.lock);
+
+        return Q.failed;
+    }
+#endif
+
+    for (size_t i = 0; i < n_items; ++i) {
+        if (process(S, data, i)) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -1,5 +1,7 @@
 #define GRAMINA_NO_NAMESPACE
 
+#include <string.h>
+
 #include <llvm-c/Core.h>
 #include <llvm-c/Error.h>
 #include <llvm-c/TargetMachine.h>
@@ -8,7 +10,23 @@
 
 #include "common/log.h"
 
-LLVMTargetMachineRef cli_get_machine() {
+static LLVMCodeGenOptLevel codegen_level(const CliState *S) {
+    switch (S->opt_level) {
+    case OPT_LEVEL_0:
+        return LLVMCodeGenLevelNone;
+    case OPT_LEVEL_1:
+        return LLVMCodeGenLevelLess;
+    case OPT_LEVEL_2:
+    case OPT_LEVEL_S:
+        return LLVMCodeGenLevelDefault;
+    case OPT_LEVEL_3:
+        return LLVMCodeGenLevelAggressive;
+    }
+
+    return LLVMCodeGenLevelDefault;
+}
+
+static LLVMTargetMachineRef create_machine(const CliState *S, bool log) {
     char *err;
     char *triple = LLVMGetDefaultTargetTriple();
     LLVMTargetRef target;
@@ -19,19 +37,48 @@ LLVMTargetMachineRef cli_get_machine() {
         return NULL;
     }
 
-    ilog_fmt("Determined target triple: {cstr}\n", triple);
+    if (log) {
+        ilog_fmt("Determined target triple: {cstr}\n", triple);
+    }
+
+    // The host CPU name alone doesn't account for features the OS disabled
+    bool native = strcmp(S->cpu, "native") == 0;
+    char *cpu = native
+              ? LLVMGetHostCPUName()
+              : NULL;
+    char *features = native
+                   ? LLVMGetHostCPUFeatures()
+                   : NULL;
+
+    if (log) {
+        ilog_fmt("Determined target CPU: {cstr}\n", native ? cpu : S->cpu);
+    }
 
     LLVMTargetMachineRef machine = LLVMCreateTargetMachine(
         target,
         triple,
-        "generic",
-        "",
-        LLVMCodeGenLevelDefault,
+        native ? cpu : S->cpu,
+        native ? features : "",
+        codegen_level(S),
         LLVMRelocDefault,
         LLVMCodeModelDefault
     );
 
+    if (native) {
+        LLVMDisposeMessage(cpu);
+        LLVMDisposeMessage(features);
+    }
+
     LLVMDisposeMessage(triple);
 
     return machine;
 }
+
+LLVMTargetMachineRef cli_get_machine(const CliState *S) {
+    return create_machine(S, true);
+}
+
+// Target machines can't be shared between threads, every job makes its own
+LLVMTargetMachineRef cli_dup_machine(const CliState *S) {
+    return create_machine(S, false);
+}
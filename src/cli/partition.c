@@ -0,0 +1,297 @@
+#define GRAMINA_NO_NAMESPACE
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <llvm-c/BitReader.h>
+#include <llvm-c/BitWriter.h>
+#include <llvm-c/Core.h>
+#include <llvm-c/Error.h>
+#include <llvm-c/TargetMachine.h>
+#include <llvm-c/Transforms/PassBuilder.h>
+
+#include "cli/jobs.h"
+#include "cli/state.h"
+#include "cli/tu.h"
+
+#include "common/log.h"
+
+#include "compiler/function.h"
+
+#define NO_PARTITION SIZE_MAX
+
+typedef struct {
+    LLVMMemoryBufferRef *bitcode; // Released by the job that emits the partition
+    char *const *files;
+} PartitionJob;
+
+typedef struct {
+    size_t index;
+    size_t size;
+} FunctionWeight;
+
+static bool is_local(LLVMValueRef val) {
+    switch (LLVMGetLinkage(val)) {
+    case LLVMInternalLinkage:
+    case LLVMPrivateLinkage:
+    case LLVMLinkerPrivateLinkage:
+    case LLVMLinkerPrivateWeakLinkage:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Local symbols may be referenced from another partition, so the linker has to see them
+static void externalize(LLVMValueRef val) {
+    size_t length;
+    LLVMGetValueName2(val, &length);
+
+    // Unnamed values can't be referenced across objects, LLVM makes the name unique
+    if (length == 0) {
+        LLVMSetValueName2(val, "__gramina_partition_global", 26);
+    }
+
+    LLVMSetLinkage(val, LLVMExternalLinkage);
+    LLVMSetVisibility(val, LLVMHiddenVisibility);
+}
+
+static size_t function_size(LLVMValueRef fn) {
+    size_t size = 0;
+
+    for (LLVMBasicBlockRef bb = LLVMGetFirstBasicBlock(fn); bb; bb = LLVMGetNextBasicBlock(bb)) {
+        for (LLVMValueRef inst = LLVMGetFirstInstruction(bb); inst; inst = LLVMGetNextInstruction(inst)) {
+            ++size;
+        }
+    }
+
+    return size;
+}
+
+static int heavier_first(const void *_a, const void *_b) {
+    const FunctionWeight *a = _a;
+    const FunctionWeight *b = _b;
+
+    if (a->size != b->size) {
+        return a->size < b->size ? 1 : -1;
+    }
+
+    // Keeps the assignment independent of how qsort orders equal elements
+    return a->index < b->index ? -1 : 1;
+}
+
+static size_t count_functions(LLVMModuleRef mod, size_t *n_definitions) {
+    size_t n_functions = 0;
+    *n_definitions = 0;
+
+    for (LLVMValueRef fn = LLVMGetFirstFunction(mod); fn; fn = LLVMGetNextFunction(fn)) {
+        ++n_functions;
+
+        if (!LLVMIsDeclaration(fn)) {
+            ++*n_definitions;
+        }
+    }
+
+    return n_functions;
+}
+
+/**
+ * Makes every symbol of `mod` that another partition might reference
+ * external, then hands each defined function to the partition with the
+ * fewest instructions so far, largest functions first.
+ */
+static size_t *assign_partitions(LLVMModuleRef mod, size_t n_parts) {
+    size_t n_definitions;
+    size_t n_functions = count_functions(mod, &n_definitions);
+
+    size_t *owners = gramina_malloc(n_functions * sizeof *owners);
+    FunctionWeight *weights = gramina_malloc(n_definitions * sizeof *weights);
+
+    size_t i = 0;
+    size_t j = 0;
+    for (LLVMValueRef fn = LLVMGetFirstFunction(mod); fn; fn = LLVMGetNextFunction(fn), ++i) {
+        owners[i] = NO_PARTITION;
+
+        if (LLVMIsDeclaration(fn)) {
+            continue;
+        }
+
+        if (is_local(fn)) {
+            externalize(fn);
+        }
+
+        weights[j++] = (FunctionWeight) {
+            .index = i,
+            .size = function_size(fn),
+        };
+    }
+
+    // Constants that don't need a unique address are simply copied into every partition
+    for (LLVMValueRef gv = LLVMGetFirstGlobal(mod); gv; gv = LLVMGetNextGlobal(gv)) {
+        bool copyable = LLVMIsGlobalConstant(gv)
+                     && LLVMGetUnnamedAddress(gv) == LLVMGlobalUnnamedAddr;
+
+        if (is_local(gv) && !copyable) {
+            externalize(gv);
+        }
+    }
+
+    qsort(weights, n_definitions, sizeof *weights, heavier_first);
+
+    size_t loads[n_parts];
+    for (size_t k = 0; k < n_parts; ++k) {
+        loads[k] = 0;
+    }
+
+    for (size_t k = 0; k < n_definitions; ++k) {
+        size_t lightest = 0;
+        for (size_t l = 1; l < n_parts; ++l) {
+            if (loads[l] < loads[lightest]) {
+                lightest = l;
+            }
+        }
+
+        owners[weights[k].index] = lightest;
+        loads[lightest] += weights[k].size + 1;
+    }
+
+    gramina_free(weights);
+
+    return owners;
+}
+
+/**
+ * Clones `mod` with only the bodies `part` owns, as bitcode. Partitions are
+ * split one after another, so besides the module itself only a single
+ * clone is ever in memory, next to the much smaller partitions split so far.
+ */
+static LLVMMemoryBufferRef split_partition(CliState *S, LLVMModuleRef mod, const size_t *owners, size_t part, const char *file) {
+    LLVMModuleRef clone = LLVMCloneModule(mod);
+
+    size_t i = 0;
+    for (LLVMValueRef fn = LLVMGetFirstFunction(clone); fn; fn = LLVMGetNextFunction(fn), ++i) {
+        size_t owner = owners[i];
+        if (owner != NO_PARTITION && owner != part) {
+            function_strip_body(fn);
+        }
+    }
+
+    // Globals that weren't copied are defined by the first partition only
+    for (LLVMValueRef gv = LLVMGetFirstGlobal(clone); gv; gv = LLVMGetNextGlobal(gv)) {
+        if (part != 0 && !is_local(gv) && !LLVMIsDeclaration(gv)) {
+            LLVMSetInitializer(gv, NULL);
+            LLVMSetLinkage(gv, LLVMExternalLinkage);
+        }
+    }
+
+    // Drops the copied constants this partition doesn't use
+    LLVMPassBuilderOptionsRef opt = LLVMCreatePassBuilderOptions();
+    LLVMErrorRef pass_err = LLVMRunPasses(clone, "globaldce", S->machine, opt);
+    LLVMDisposePassBuilderOptions(opt);
+
+    if (pass_err) {
+        char *msg = LLVMGetErrorMessage(pass_err);
+        elog_fmt("{cstr}: LLVMRunPasses: {cstr}\n", file, msg);
+        LLVMDisposeErrorMessage(msg);
+
+        LLVMDisposeModule(clone);
+        return NULL;
+    }
+
+    LLVMMemoryBufferRef bitcode = LLVMWriteBitcodeToMemoryBuffer(clone);
+    LLVMDisposeModule(clone);
+
+    return bitcode;
+}
+
+static bool partition_job(CliState *S, void *_job, size_t part) {
+    PartitionJob *job = _job;
+    char *file = job->files[part];
+
+    // Every partition is codegen'd in a context of its own so they can run in parallel
+    LLVMContextRef context = LLVMContextCreate();
+
+    LLVMModuleRef mod;
+    bool parse_err = LLVMParseBitcodeInContext2(context, job->bitcode[part], &mod);
+
+    LLVMDisposeMemoryBuffer(job->bitcode[part]);
+    job->bitcode[part] = NULL;
+
+    if (parse_err) {
+        elog_fmt("{cstr}: Failed to load partition\n", file);
+        LLVMContextDispose(context);
+        return true;
+    }
+
+    char *err;
+    if (LLVMTargetMachineEmitToFile(S->machine, mod, file, LLVMObjectFile, &err)) {
+        elog_fmt("{cstr}: {cstr}\n", file, err);
+        LLVMDisposeErrorMessage(err);
+
+        LLVMDisposeModule(mod);
+        LLVMContextDispose(context);
+        return true;
+    }
+
+    LLVMDisposeModule(mod);
+    LLVMContextDispose(context);
+
+    return false;
+}
+
+// The number of objects `tu_emit_partitions` would split `T` into
+size_t tu_partition_count(CliState *S, TranslationUnit *T) {
+    size_t n_definitions;
+    count_functions(T->module, &n_definitions);
+
+    if (n_definitions < S->jobs) {
+        return n_definitions > 0
+             ? n_definitions
+             : 1;
+    }
+
+    return S->jobs;
+}
+
+/**
+ * Splits the module of `T` into `n_parts` objects, one per entry of
+ * `files`, and emits them on up to `S->jobs` threads. Each function is
+ * defined in exactly one of the objects, so they have to be linked
+ * together. Consumes the module of `T`.
+ */
+bool tu_emit_partitions(CliState *S, TranslationUnit *T, char *const *files, size_t n_parts) {
+    size_t *owners = assign_partitions(T->module, n_parts);
+
+    LLVMMemoryBufferRef bitcode[n_parts];
+    for (size_t i = 0; i < n_parts; ++i) {
+        bitcode[i] = NULL;
+    }
+
+    bool err = false;
+    for (size_t i = 0; i < n_parts && !err; ++i) {
+        bitcode[i] = split_partition(S, T->module, owners, i, files[i]);
+        err = bitcode[i] == NULL;
+    }
+
+    LLVMDisposeModule(T->module);
+    T->module = NULL;
+    gramina_free(owners);
+
+    if (!err) {
+        PartitionJob job = {
+            .bitcode = bitcode,
+            .files = files,
+        };
+
+        err = cli_run_jobs(S, n_parts, partition_job, &job);
+    }
+
+    // Partitions that were never emitted
+    for (size_t i = 0; i < n_parts; ++i) {
+        if (bitcode[i]) {
+            LLVMDisposeMemoryBuffer(bitcode[i]);
+        }
+    }
+
+    return err;
+}
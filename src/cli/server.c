@@ -0,0 +1,650 @@
+#define GRAMINA_NO_NAMESPACE
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <llvm-c/TargetMachine.h>
+
+#include "cli/etc.h"
+#include "cli/server.h"
+#include "cli/state.h"
+
+#include "common/hashmap.h"
+#include "common/log.h"
+
+#ifdef GRAMINA_UNIX_BUILD
+#  include <fcntl.h>
+#  include <limits.h>
+#  include <poll.h>
+#  include <signal.h>
+#  include <sys/socket.h>
+#  include <sys/time.h>
+#  include <sys/un.h>
+#  include <unistd.h>
+
+#  ifndef MSG_NOSIGNAL
+#    define MSG_NOSIGNAL 0
+#  endif
+
+// Generous bounds, only there so a confused client can't make the server allocate without limit
+#define MAX_REQUEST_STRINGS 4096
+#define MAX_REQUEST_STRING_LENGTH (1 << 20)
+
+// How long a client waits for the server to pick it up before compiling locally
+#define READY_TIMEOUT_MS 100
+
+// A client that stops sending halfway can only hold the server up for this long
+#define REQUEST_TIMEOUT_S 5
+
+// What a compilation reads from the environment, each request brings the client's values
+static const char *const forwarded_env[] = {
+    "PATH",
+    "GRAMINA_CACHE_DIR",
+    "GRAMINA_LINKER",
+};
+
+#define N_FORWARDED_ENV (sizeof forwarded_env / sizeof forwarded_env[0])
+
+typedef struct {
+    char *cpu;
+    int opt_level;
+    LLVMTargetMachineRef machine;
+} WarmMachine;
+
+GRAMINA_DECLARE_ARRAY(WarmMachine, static);
+GRAMINA_IMPLEMENT_ARRAY(WarmMachine, static);
+
+struct CliServer {
+    Hashmap sessions; // Real path of a source -> CompileSession *
+    Array(WarmMachine) machines;
+    char *own_env[N_FORWARDED_ENV]; // Restored after each request, NULL if unset
+};
+
+typedef struct {
+    uint32_t n_env;
+    uint32_t n_strings;
+} RequestHeader;
+
+typedef struct {
+    char **strings; // The working directory, `n_env` variables as `NAME=value`, then the arguments
+    size_t n_strings;
+    size_t n_env;
+    int out;
+    int err;
+} Request;
+
+static volatile sig_atomic_t stopping = 0;
+
+static void stop(int sig) {
+    stopping = 1;
+}
+
+static bool write_all(int fd, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+    while (size > 0) {
+        ssize_t written = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (written <= 0) {
+            return true;
+        }
+
+        bytes += written;
+        size -= written;
+    }
+
+    return false;
+}
+
+static bool read_all(int fd, void *data, size_t size) {
+    uint8_t *bytes = data;
+    while (size > 0) {
+        ssize_t got = recv(fd, bytes, size, 0);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (got <= 0) {
+            return true;
+        }
+
+        bytes += got;
+        size -= got;
+    }
+
+    return false;
+}
+
+static bool write_string(int fd, const char *string) {
+    uint32_t length = strlen(string);
+
+    return write_all(fd, &length, sizeof length)
+        || write_all(fd, string, length);
+}
+
+static bool write_env(int fd, const char *name) {
+    const char *value = getenv(name);
+    uint32_t length = strlen(name) + 1 + strlen(value);
+
+    return write_all(fd, &length, sizeof length)
+        || write_all(fd, name, strlen(name))
+        || write_all(fd, "=", 1)
+        || write_all(fd, value, strlen(value));
+}
+
+static void request_free(Request *this) {
+    for (size_t i = 0; i < this->n_strings; ++i) {
+        gramina_free(this->strings[i]);
+    }
+
+    gramina_free(this->strings);
+
+    if (this->out >= 0) {
+        close(this->out);
+    }
+
+    if (this->err >= 0) {
+        close(this->err);
+    }
+}
+
+// The string counts travel together with the client's stdout and stderr
+static bool receive_request(int conn, Request *req) {
+    *req = (Request) {
+        .out = -1,
+        .err = -1,
+    };
+
+    RequestHeader header;
+    struct iovec iov = {
+        .iov_base = &header,
+        .iov_len = sizeof header,
+    };
+
+    union {
+        struct cmsghdr header;
+        char buf[CMSG_SPACE(2 * sizeof(int))];
+    } control;
+
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control.buf,
+        .msg_controllen = sizeof control.buf,
+    };
+
+    if (recvmsg(conn, &msg, MSG_WAITALL) != sizeof header) {
+        return true;
+    }
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg
+     || cmsg->cmsg_level != SOL_SOCKET
+     || cmsg->cmsg_type != SCM_RIGHTS
+     || cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int))) {
+        return true;
+    }
+
+    int fds[2];
+    memcpy(fds, CMSG_DATA(cmsg), sizeof fds);
+    req->out = fds[0];
+    req->err = fds[1];
+
+    // At least the working directory and `argv[0]`
+    uint32_t n_strings = header.n_strings;
+    if (n_strings < 2 || n_strings > MAX_REQUEST_STRINGS || header.n_env > n_strings - 2) {
+        return true;
+    }
+
+    req->n_env = header.n_env;
+    req->strings = gramina_malloc(n_strings * sizeof *req->strings);
+
+    for (; req->n_strings < n_strings; ++req->n_strings) {
+        uint32_t length;
+        if (read_all(conn, &length, sizeof length) || length > MAX_REQUEST_STRING_LENGTH) {
+            return true;
+        }
+
+        char *string = gramina_malloc(length + 1);
+        if (read_all(conn, string, length)) {
+            gramina_free(string);
+            return true;
+        }
+
+        string[length] = '\0';
+        req->strings[req->n_strings] = string;
+    }
+
+    return false;
+}
+
+static const char *find_env(const Request *req, const char *name) {
+    size_t length = strlen(name);
+
+    for (size_t i = 1; i <= req->n_env; ++i) {
+        const char *entry = req->strings[i];
+        if (strncmp(entry, name, length) == 0 && entry[length] == '=') {
+            return entry + length + 1;
+        }
+    }
+
+    return NULL;
+}
+
+// Variables the client doesn't have are unset, rather than taken from the server
+static void set_env(const char *name, const char *value) {
+    if (value) {
+        setenv(name, value, true);
+    } else {
+        unsetenv(name);
+    }
+}
+
+static LLVMTargetMachineRef warm_machine(CliServer *server, const CliState *R) {
+    array_foreach_ref(WarmMachine, _, warm, server->machines) {
+        if (warm->opt_level == R->opt_level && strcmp(warm->cpu, R->cpu) == 0) {
+            return warm->machine;
+        }
+    }
+
+    LLVMTargetMachineRef machine = cli_get_machine(R);
+    if (!machine) {
+        return NULL;
+    }
+
+    char *cpu = gramina_malloc(strlen(R->cpu) + 1);
+    strcpy(cpu, R->cpu);
+
+    array_append(WarmMachine, &server->machines, ((WarmMachine) {
+        .cpu = cpu,
+        .opt_level = R->opt_level,
+        .machine = machine,
+    }));
+
+    return machine;
+}
+
+static int handle_request(CliServer *server, const CliState *S, int argc, char **argv) {
+    CliState R = {
+        .link_libs = mk_array(_GraminaArgString),
+        .sources = mk_array(_GraminaArgString),
+        .exports = mk_array(_GraminaArgString),
+        .self_path = S->self_path,
+    };
+
+    if (cli_handle_args(&R, argc, argv)) {
+        cli_state_free(&R);
+        return 1;
+    }
+
+    if (R.wants_help) {
+        cli_state_free(&R);
+        return 0;
+    }
+
+    if (R.server_socket) {
+        elog_fmt("'--server' cannot be forwarded to a server\n");
+        cli_state_free(&R);
+        return 1;
+    }
+
+    if (!(R.machine = warm_machine(server, &R))) {
+        cli_state_free(&R);
+        return 1;
+    }
+
+    R.server = server;
+    int status = cli_compile(&R);
+
+    // Both belong to the server
+    R.machine = NULL;
+    R.server = NULL;
+
+    cli_state_free(&R);
+
+    return status;
+}
+
+static void serve_connection(CliServer *server, const CliState *S, int conn, int home, LogLevel log_level) {
+    // Clients only send their request once they know it is being handled
+    uint8_t ready = 1;
+    if (write_all(conn, &ready, sizeof ready)) {
+        return;
+    }
+
+    Request req;
+    if (receive_request(conn, &req)) {
+        // Another server checking for a live one hangs up before sending anything
+        if (req.out >= 0) {
+            wlog_fmt("Dropped a malformed request\n");
+        }
+
+        request_free(&req);
+        return;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+
+    int saved_out = dup(STDOUT_FILENO);
+    int saved_err = dup(STDERR_FILENO);
+    dup2(req.out, STDOUT_FILENO);
+    dup2(req.err, STDERR_FILENO);
+
+    for (size_t i = 0; i < N_FORWARDED_ENV; ++i) {
+        set_env(forwarded_env[i], find_env(&req, forwarded_env[i]));
+    }
+
+    size_t first_arg = 1 + req.n_env;
+
+    int32_t status = 1;
+    if (chdir(req.strings[0])) {
+        elog_fmt("Cannot enter '{cstr}': {cstr}\n", req.strings[0], strerror(errno));
+    } else {
+        status = handle_request(server, S, req.n_strings - first_arg, req.strings + first_arg);
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+
+    dup2(saved_out, STDOUT_FILENO);
+    dup2(saved_err, STDERR_FILENO);
+    close(saved_out);
+    close(saved_err);
+
+    if (fchdir(home)) {
+        wlog_fmt("Cannot return to the server's directory: {cstr}\n", strerror(errno));
+    }
+
+    // Requests may change it with '-v' or '--log-level'
+    gramina_global_log_level = log_level;
+
+    for (size_t i = 0; i < N_FORWARDED_ENV; ++i) {
+        set_env(forwarded_env[i], server->own_env[i]);
+    }
+
+    write_all(conn, &status, sizeof status);
+    request_free(&req);
+}
+
+static void session_free(void *session) {
+    compile_session_free(session);
+    gramina_free(session);
+}
+
+static bool socket_address(const char *path, struct sockaddr_un *addr) {
+    *addr = (struct sockaddr_un) {
+        .sun_family = AF_UNIX,
+    };
+
+    if (strlen(path) >= sizeof addr->sun_path) {
+        elog_fmt("Socket path '{cstr}' is too long\n", path);
+        return true;
+    }
+
+    strcpy(addr->sun_path, path);
+
+    return false;
+}
+
+bool cli_serve(CliState *S) {
+    struct sockaddr_un addr;
+    if (socket_address(S->server_socket, &addr)) {
+        return true;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        elog_fmt("socket: {cstr}\n", strerror(errno));
+        return true;
+    }
+
+    // Neither the linker nor anything else the server spawns needs these
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    // A socket left behind by a server that is gone gets replaced, a live one doesn't
+    if (connect(fd, (struct sockaddr *)&addr, sizeof addr) == 0) {
+        elog_fmt("A server is already listening on '{cstr}'\n", S->server_socket);
+        close(fd);
+        return true;
+    }
+
+    unlink(S->server_socket);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof addr) || listen(fd, SOMAXCONN)) {
+        elog_fmt("Cannot listen on '{cstr}': {cstr}\n", S->server_socket, strerror(errno));
+        close(fd);
+        return true;
+    }
+
+    int home = open(".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (home < 0) {
+        elog_fmt("Cannot open the working directory: {cstr}\n", strerror(errno));
+        close(fd);
+        unlink(S->server_socket);
+        return true;
+    }
+
+    // No SA_RESTART, `accept` has to return for the loop to notice
+    struct sigaction action = {
+        .sa_handler = stop,
+    };
+
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    CliServer server = {
+        .sessions = mk_hashmap(16),
+        .machines = mk_array(WarmMachine),
+    };
+
+    server.sessions.object_freer = session_free;
+
+    for (size_t i = 0; i < N_FORWARDED_ENV; ++i) {
+        const char *value = getenv(forwarded_env[i]);
+
+        server.own_env[i] = value
+                          ? strcpy(gramina_malloc(strlen(value) + 1), value)
+                          : NULL;
+    }
+
+    LogLevel log_level = gramina_global_log_level;
+
+    ilog_fmt("Listening on '{cstr}'\n", S->server_socket);
+
+    bool err = false;
+    while (!stopping) {
+        int conn = accept(fd, NULL, NULL);
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+
+            elog_fmt("accept: {cstr}\n", strerror(errno));
+            err = true;
+            break;
+        }
+
+        fcntl(conn, F_SETFD, FD_CLOEXEC);
+
+        struct timeval timeout = {
+            .tv_sec = REQUEST_TIMEOUT_S,
+        };
+
+        setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+
+        serve_connection(&server, S, conn, home, log_level);
+        close(conn);
+    }
+
+    ilog_fmt("Shutting down\n");
+
+    array_foreach_ref(WarmMachine, _, warm, server.machines) {
+        gramina_free(warm->cpu);
+        LLVMDisposeTargetMachine(warm->machine);
+    }
+
+    array_free(WarmMachine, &server.machines);
+    hashmap_free(&server.sessions);
+
+    for (size_t i = 0; i < N_FORWARDED_ENV; ++i) {
+        gramina_free(server.own_env[i]);
+    }
+
+    close(home);
+    close(fd);
+    unlink(S->server_socket);
+
+    return err;
+}
+
+bool cli_forward(CliState *S, int argc, char **argv, int *status) {
+    struct sockaddr_un addr;
+    if (socket_address(S->connect_socket, &addr)) {
+        return true;
+    }
+
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof cwd)) {
+        elog_fmt("Cannot determine the working directory: {cstr}\n", strerror(errno));
+        return true;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        wlog_fmt("Compiling without the server at '{cstr}'\n", S->connect_socket);
+        return true;
+    }
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof addr)) {
+        wlog_fmt("Compiling without the server at '{cstr}'\n", S->connect_socket);
+        close(fd);
+        return true;
+    }
+
+    // Requests are handled one at a time, waiting for the ones before this one would be slower than compiling
+    struct pollfd ready_poll = {
+        .fd = fd,
+        .events = POLLIN,
+    };
+
+    uint8_t ready;
+    if (poll(&ready_poll, 1, READY_TIMEOUT_MS) != 1 || read_all(fd, &ready, sizeof ready)) {
+        vlog_fmt("The server at '{cstr}' is busy, compiling locally\n", S->connect_socket);
+        close(fd);
+        return true;
+    }
+
+    const char *env[N_FORWARDED_ENV];
+    size_t n_env = 0;
+    for (size_t i = 0; i < N_FORWARDED_ENV; ++i) {
+        if (getenv(forwarded_env[i])) {
+            env[n_env++] = forwarded_env[i];
+        }
+    }
+
+    RequestHeader header = {
+        .n_env = n_env,
+        .n_strings = 1 + n_env + argc,
+    };
+
+    struct iovec iov = {
+        .iov_base = &header,
+        .iov_len = sizeof header,
+    };
+
+    union {
+        struct cmsghdr header;
+        char buf[CMSG_SPACE(2 * sizeof(int))];
+    } control;
+
+    memset(&control, 0, sizeof control);
+
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control.buf,
+        .msg_controllen = sizeof control.buf,
+    };
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+
+    int fds[2] = { STDOUT_FILENO, STDERR_FILENO };
+    memcpy(CMSG_DATA(cmsg), fds, sizeof fds);
+
+    bool err = sendmsg(fd, &msg, MSG_NOSIGNAL) != sizeof header
+            || write_string(fd, cwd);
+
+    for (size_t i = 0; i < n_env && !err; ++i) {
+        err = write_env(fd, env[i]);
+    }
+
+    for (int i = 0; i < argc && !err; ++i) {
+        err = write_string(fd, argv[i]);
+    }
+
+    int32_t reply;
+    if (!err && read_all(fd, &reply, sizeof reply)) {
+        elog_fmt("The server at '{cstr}' hung up before finishing\n", S->connect_socket);
+        err = true;
+    }
+
+    close(fd);
+
+    if (!err) {
+        *status = reply;
+    }
+
+    return err;
+}
+
+CompileSession *cli_server_session(CliState *S, const char *file) {
+    if (!S->server) {
+        return NULL;
+    }
+
+    // Loading the file reports it if it doesn't exist
+    char *path = realpath(file, NULL);
+    if (!path) {
+        return NULL;
+    }
+
+    Symbol key = intern_c(path);
+    free(path);
+
+    CompileSession *session = hashmap_get_sym(&S->server->sessions, key);
+    if (!session) {
+        session = gramina_malloc(sizeof *session);
+        *session = mk_compile_session();
+
+        hashmap_set_sym(&S->server->sessions, key, session);
+    }
+
+    return session;
+}
+
+#else
+
+bool cli_serve(CliState *S) {
+    elog_fmt("'--server' needs Unix domain sockets, which this build lacks\n");
+    return true;
+}
+
+bool cli_forward(CliState *S, int argc, char **argv, int *status) {
+    return true;
+}
+
+CompileSession *cli_server_session(CliState *S, const char *file) {
+    return NULL;
+}
+
+#endif
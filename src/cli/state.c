@@ -7,5 +7,6 @@
 void cli_state_free(CliState *this) {
     array_free(_GraminaArgString, &this->link_libs);
     array_free(_GraminaArgString, &this->sources);
+    array_free(_GraminaArgString, &this->exports);
     LLVMDisposeTargetMachine(this->machine);
 }
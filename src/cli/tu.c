@@ -4,19 +4,26 @@
 #include <llvm-c/Types.h>
 
 #include <errno.h>
+#include <stdio.h>
 #include <string.h>
 
+#include <llvm-c/BitReader.h>
+#include <llvm-c/BitWriter.h>
 #include <llvm-c/Core.h>
 #include <llvm-c/Error.h>
 #include <llvm-c/Linker.h>
+#include <llvm-c/Transforms/PassBuilder.h>
 
 #include "cli/etc.h"
 #include "cli/highlight.h"
+#include "cli/jobs.h"
 #include "cli/state.h"
 #include "cli/tu.h"
 
 #include "common/log.h"
 
+#include "compiler/function.h"
+
 GRAMINA_IMPLEMENT_ARRAY(TranslationUnit);
 GRAMINA_IMPLEMENT_ARRAY(CompilationStage);
 
@@ -34,6 +41,12 @@ static const char *get_name(CompilationStageProcessor p) {
         return "AST_LOG";
     } else if (p == tu_compile) {
         return "COMPILE";
+    } else if (p == tu_optimize) {
+        return "OPTIMIZE";
+    } else if (p == tu_cache_load) {
+        return "CACHE_LOAD";
+    } else if (p == tu_cache_store) {
+        return "CACHE_STORE";
     } else if (p == tu_ir_dump) {
         return "IR_DUMP";
     }
@@ -60,8 +73,14 @@ Pipeline pipeline_default(CliState *S) {
         .stages = mk_array(CompilationStage),
     };
 
+    // A cached module can't reproduce the AST, so it is only looked up when no one wants it
+    bool wants_ast = S->ast_dump_file || gramina_global_log_level == GRAMINA_LOG_LEVEL_VERBOSE;
+
     CompilationStageProcessor stages[] = {
         tu_load,
+        S->cache && !wants_ast
+            ? tu_cache_load
+            : NULL,
         tu_lex,
         tu_parse,
         S->ast_dump_file
@@ -71,6 +90,12 @@ Pipeline pipeline_default(CliState *S) {
             ? tu_ast_log
             : NULL,
         tu_compile,
+        S->opt_level != OPT_LEVEL_0
+            ? tu_optimize
+            : NULL,
+        S->cache
+            ? tu_cache_store
+            : NULL,
         S->ir_dump_file
             ? tu_ir_dump
             : NULL,
@@ -85,6 +110,9 @@ Pipeline pipeline_default(CliState *S) {
         array_append(CompilationStage, &P.stages, ((CompilationStage) {
             .name = get_name(proc),
             .processor = proc,
+            .skip_if_cached = proc != tu_load
+                           && proc != tu_cache_load
+                           && proc != tu_ir_dump,
         }));
     }
 
@@ -101,6 +129,10 @@ bool tu_pipe(CliState *S, const Pipeline *P, TranslationUnit *T) {
             stage->name = "<unknown>";
         }
 
+        if (T->from_cache && stage->skip_if_cached) {
+            continue;
+        }
+
         ilog_fmt("{cstr}: Stage '{cstr}'\n", T->file, stage->name);
 
         if (stage->processor(S, T)) {
@@ -112,11 +144,35 @@ bool tu_pipe(CliState *S, const Pipeline *P, TranslationUnit *T) {
     return false;
 }
 
+typedef struct {
+    const Pipeline *P;
+    TranslationUnit *tus;
+} PipeJob;
+
+static bool pipe_job(CliState *S, void *_job, size_t i) {
+    PipeJob *job = _job;
+    return tu_pipe(S, job->P, job->tus + i);
+}
+
+/**
+ * Runs `P` over every unit, on up to `S->jobs` threads. Units never share
+ * LLVM state since `tu_compile` gives each one its own context. No new unit
+ * is started after a failure, units that were never started stay zeroed.
+ */
+bool tu_pipe_all(CliState *S, const Pipeline *P, TranslationUnit *tus, size_t n_tus) {
+    PipeJob job = {
+        .P = P,
+        .tus = tus,
+    };
+
+    return cli_run_jobs(S, n_tus, pipe_job, &job);
+}
+
 bool tu_load(CliState *S, TranslationUnit *T) {
-    T->fstream = mk_stream_open_c(T->file, "r");
+    int status = map_file(&T->source, T->file);
 
-    if (!stream_is_valid(&T->fstream)) {
-        elog_fmt("Cannot open file '{cstr}': {cstr}\n", T->file, strerror(errno));
+    if (status) {
+        elog_fmt("Cannot open file '{cstr}': {cstr}\n", T->file, strerror(status));
         return true;
     }
 
@@ -124,7 +180,7 @@ bool tu_load(CliState *S, TranslationUnit *T) {
 }
 
 bool tu_lex(CliState *S, TranslationUnit *T) {
-    T->lex_result = lex(&T->fstream);
+    T->lex_result = lex_sv(&T->source.contents);
 
     if (T->lex_result.status != GRAMINA_LEX_ERR_NONE) {
         StringView err_type = lex_error_code_to_str(T->lex_result.status);
@@ -133,7 +189,7 @@ bool tu_lex(CliState *S, TranslationUnit *T) {
         elog_fmt(
             "{cstr} ({sz}:{sz}) {sv}: {s}\n",
             T->file,
-            pos.line, pos.column,
+            (size_t)pos.line, (size_t)pos.column,
             &err_type,
             &T->lex_result.error_description
         );
@@ -146,8 +202,7 @@ bool tu_lex(CliState *S, TranslationUnit *T) {
 }
 
 bool tu_parse(CliState *S, TranslationUnit *T) {
-    Slice(GraminaToken) tokens = array_as_slice(GraminaToken, &T->lex_result.tokens);
-    T->parse_result = parse(&tokens);
+    T->parse_result = parse(&T->lex_result.tokens);
 
     if (!T->parse_result.root) {
         TokenPosition pos = T->parse_result.error.pos;
@@ -155,8 +210,8 @@ bool tu_parse(CliState *S, TranslationUnit *T) {
         elog_fmt(
             "{cstr} ({sz}:{sz}) {s}\n",
             T->file,
-            T->parse_result.error.pos.line,
-            T->parse_result.error.pos.column,
+            (size_t)pos.line,
+            (size_t)pos.column,
             &T->parse_result.error.description
         );
 
@@ -168,7 +223,10 @@ bool tu_parse(CliState *S, TranslationUnit *T) {
 }
 
 bool tu_compile(CliState *S, TranslationUnit *T) {
-    T->compile_result = compile_for_machine(T->parse_result.root, S->machine);
+    T->context = LLVMContextCreate();
+    T->compile_result = T->session
+                      ? compile_in_session(T->session, T->parse_result.root, S->machine, T->context)
+                      : compile_in_context(T->parse_result.root, S->machine, T->context);
 
     if (T->compile_result.status) {
         CompileError *err = &T->compile_result.error;
@@ -178,8 +236,8 @@ bool tu_compile(CliState *S, TranslationUnit *T) {
             "Status: {sv}\n{cstr} ({sz}:{sz}) {s}\n",
             &code_str,
             T->file,
-            err->pos.line,
-            err->pos.column,
+            (size_t)err->pos.line,
+            (size_t)err->pos.column,
             &err->description
         );
 
@@ -193,6 +251,171 @@ bool tu_compile(CliState *S, TranslationUnit *T) {
     return false;
 }
 
+static const char *opt_level_name(CliState *S) {
+    switch (S->opt_level) {
+    case OPT_LEVEL_0:
+        return "O0";
+    case OPT_LEVEL_1:
+        return "O1";
+    case OPT_LEVEL_2:
+        return "O2";
+    case OPT_LEVEL_3:
+        return "O3";
+    case OPT_LEVEL_S:
+        return "Os";
+    }
+
+    return "O0";
+}
+
+static bool run_passes(CliState *S, TranslationUnit *T, const char *passes) {
+    vlog_fmt("{cstr}: Running passes '{cstr}'\n", T->file, passes);
+
+    LLVMPassBuilderOptionsRef opt = LLVMCreatePassBuilderOptions();
+
+#ifdef GRAMINA_DEBUG_BUILD
+    // Catches malformed IR from the compiler right at the pass that trips on it
+    LLVMPassBuilderOptionsSetVerifyEach(opt, true);
+#endif
+
+    LLVMErrorRef err = LLVMRunPasses(T->module, passes, S->machine, opt);
+    LLVMDisposePassBuilderOptions(opt);
+
+    if (err) {
+        char *msg = LLVMGetErrorMessage(err);
+        elog_fmt("{cstr}: LLVMRunPasses: {cstr}\n", T->file, msg);
+        LLVMDisposeErrorMessage(msg);
+        return true;
+    }
+
+    return false;
+}
+
+bool tu_optimize(CliState *S, TranslationUnit *T) {
+    // With LTO, work that needs the whole program is left for `tu_lto`
+    const char *pipeline;
+    switch (S->lto) {
+    case LTO_NONE:
+        pipeline = "default";
+        break;
+    case LTO_FULL:
+        pipeline = "lto-pre-link";
+        break;
+    case LTO_THIN:
+        pipeline = "thinlto-pre-link";
+        break;
+    }
+
+    char passes[32];
+    snprintf(passes, sizeof passes, "%s<%s>", pipeline, opt_level_name(S));
+
+    return run_passes(S, T, passes);
+}
+
+// Entry points the linker has to see whatever the command line says
+static const char *lto_exports[] = {
+    "_start",
+    "main",
+};
+
+/**
+ * Linked libraries may call back into `#extern` functions and `--export`
+ * symbols, so only the remaining definitions are internal to the binary.
+ */
+static bool is_exported(CliState *S, LLVMValueRef val) {
+    if (LLVMIsAFunction(val) && function_is_extern(val)) {
+        return true;
+    }
+
+    size_t length;
+    const char *name = LLVMGetValueName2(val, &length);
+
+    for (size_t i = 0; i < (sizeof lto_exports) / (sizeof lto_exports[0]); ++i) {
+        if (strcmp(name, lto_exports[i]) == 0) {
+            return true;
+        }
+    }
+
+    array_foreach(_GraminaArgString, _, export, S->exports) {
+        if (strcmp(name, export) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void internalize(CliState *S, LLVMValueRef val) {
+    if (LLVMIsDeclaration(val) || is_exported(S, val)) {
+        return;
+    }
+
+    LLVMSetLinkage(val, LLVMInternalLinkage);
+    LLVMSetVisibility(val, LLVMDefaultVisibility);
+}
+
+/**
+ * Optimises the merged module `T` as a whole program. Every definition
+ * that isn't exported is made internal first, which lets the inliner
+ * see calls across translation units and global DCE drop what's left.
+ */
+bool tu_lto(CliState *S, TranslationUnit *T) {
+    LLVMModuleRef mod = T->module;
+
+    for (LLVMValueRef fn = LLVMGetFirstFunction(mod); fn; fn = LLVMGetNextFunction(fn)) {
+        internalize(S, fn);
+    }
+
+    for (LLVMValueRef gv = LLVMGetFirstGlobal(mod); gv; gv = LLVMGetNextGlobal(gv)) {
+        internalize(S, gv);
+    }
+
+    // -O0 has no link-time pipeline, only the cross-module part is done
+    if (S->opt_level == OPT_LEVEL_0) {
+        return run_passes(S, T, "cgscc(inline),globaldce");
+    }
+
+    char passes[32];
+    snprintf(
+        passes, sizeof passes, "%s<%s>",
+        S->lto == LTO_THIN
+            ? "thinlto"
+            : "lto",
+        opt_level_name(S)
+    );
+
+    return run_passes(S, T, passes);
+}
+
+bool tu_cache_load(CliState *S, TranslationUnit *T) {
+    cli_cache_key(S, &T->source.contents, T->cache_key);
+
+    T->context = LLVMContextCreate();
+    T->module = cli_cache_load(S->cache, T->cache_key, T->context);
+
+    if (T->module) {
+        vlog_fmt("{cstr}: Cache hit ({cstr})\n", T->file, T->cache_key);
+        T->from_cache = true;
+    } else {
+        // `tu_compile` makes its own
+        LLVMContextDispose(T->context);
+        T->context = NULL;
+    }
+
+    return false;
+}
+
+bool tu_cache_store(CliState *S, TranslationUnit *T) {
+    // Without a lookup there is no key yet
+    if (!T->cache_key[0]) {
+        cli_cache_key(S, &T->source.contents, T->cache_key);
+    }
+
+    cli_cache_store(S->cache, T->cache_key, T->module);
+
+    return false;
+}
+
 bool tu_ast_log(CliState *S, TranslationUnit *T) {
     if (gramina_global_log_level > GRAMINA_LOG_LEVEL_VERBOSE) {
         return false;
@@ -242,52 +465,47 @@ bool tu_ir_dump(CliState *S, TranslationUnit *T) {
     return false;
 }
 
-LLVMModuleRef tu_link(CliState *S, TranslationUnit *tus, size_t n_tus) {
-    LLVMModuleRef final_mod = tus->module;
+typedef struct {
+    TranslationUnit *tus;
+    ObjectFileType type;
+} EmitJob;
 
-    for (size_t i = 1; i < n_tus; ++i) {
-        TranslationUnit *T = tus + i;
+static bool emit_job(CliState *S, void *_job, size_t i) {
+    EmitJob *job = _job;
+    TranslationUnit *T = job->tus + i;
 
-        if (LLVMLinkModules2(final_mod, T->module)) {
-            return NULL;
-        }
+    char *replaced = replace_extension(
+        T->file,
+        job->type == OBJECT_FILE
+            ? ".o"
+            : ".S"
+    );
 
-        T->module = NULL;
+    char *err;
+    if (LLVMTargetMachineEmitToFile(S->machine, T->module, replaced, (LLVMCodeGenFileType)job->type, &err)) {
+        elog_fmt("{cstr}: {cstr}\n", replaced, err);
+        LLVMDisposeErrorMessage(err);
+        gramina_free(replaced);
+        return true;
     }
 
-    return final_mod;
+    gramina_free(replaced);
+
+    return false;
 }
 
+// Units are emitted on up to `S->jobs` threads, each with its own target machine
 bool tu_emit_objects(CliState *S, TranslationUnit *tus, size_t n_tus, ObjectFileType type) {
     if (n_tus == 0) {
         return true;
     }
 
-    for (size_t i = 0; i < n_tus; ++i) {
-        TranslationUnit *T = tus + i;
-
-        LLVMModuleRef mod = T->module;
-
-        char *replaced = replace_extension(
-            T->file,
-            type == OBJECT_FILE
-                ? ".o"
-                : ".S"
-        );
-
-        char *err;
-        if (LLVMTargetMachineEmitToFile(S->machine, mod, replaced, (LLVMCodeGenFileType)type, &err)) {
-            elog_fmt("{cstr}: {cstr}\n", replaced, err);
-            LLVMDisposeErrorMessage(err);
-            LLVMDisposeTargetMachine(S->machine);
-            free(replaced);
-            return true;
-        }
-
-        gramina_free(replaced);
-    }
+    EmitJob job = {
+        .tus = tus,
+        .type = type,
+    };
 
-    return false;
+    return cli_run_jobs(S, n_tus, emit_job, &job);
 }
 
 static void handler(LLVMDiagnosticInfoRef info, void *_) {
@@ -296,32 +514,80 @@ static void handler(LLVMDiagnosticInfoRef info, void *_) {
     LLVMDisposeMessage(msg);
 }
 
-bool tu_merge(CliState *S, TranslationUnit *out, TranslationUnit *tus, size_t n_tus) {
+/**
+ * Modules can only be linked within a single context. With `move` the
+ * module is consumed, so a module that is already in `context` is reused
+ * as is, and one that isn't is freed before its copy is parsed.
+ */
+static LLVMModuleRef module_into_context(LLVMModuleRef mod, LLVMContextRef context, bool move) {
+    if (LLVMGetModuleContext(mod) == context) {
+        return move
+             ? mod
+             : LLVMCloneModule(mod);
+    }
+
+    LLVMMemoryBufferRef bitcode = LLVMWriteBitcodeToMemoryBuffer(mod);
+    if (move) {
+        LLVMDisposeModule(mod);
+    }
+
+    LLVMModuleRef moved;
+    if (LLVMParseBitcodeInContext2(context, bitcode, &moved)) {
+        moved = NULL;
+    }
+
+    LLVMDisposeMemoryBuffer(bitcode);
+
+    return moved;
+}
+
+static LLVMModuleRef merge(CliState *S, TranslationUnit *tus, size_t n_tus, bool move) {
     if (n_tus == 0) {
-        return true;
+        return NULL;
     }
 
-    LLVMDiagnosticHandler old_handler = LLVMContextGetDiagnosticHandler(LLVMGetGlobalContext());
-    void *old_context = LLVMContextGetDiagnosticContext(LLVMGetGlobalContext());
+    // The merged module lives in the first unit's context
+    LLVMContextRef context = LLVMGetModuleContext(tus->module);
 
-    LLVMModuleRef mod = LLVMCloneModule(tus->module);
-    LLVMContextSetDiagnosticHandler(LLVMGetGlobalContext(), handler, NULL);
+    LLVMDiagnosticHandler old_handler = LLVMContextGetDiagnosticHandler(context);
+    void *old_context = LLVMContextGetDiagnosticContext(context);
+
+    LLVMModuleRef mod = module_into_context(tus->module, context, move);
+    if (move) {
+        tus->module = NULL;
+    }
+
+    LLVMContextSetDiagnosticHandler(context, handler, NULL);
 
     for (size_t i = 1; i < n_tus; ++i) {
         TranslationUnit *T = tus + i;
 
-        LLVMModuleRef copy = LLVMCloneModule(T->module);
-        if (LLVMLinkModules2(mod, copy)) {
+        // Either way `src` is gone after linking, so at most one extra module is alive
+        LLVMModuleRef src = module_into_context(T->module, context, move);
+        if (move) {
+            T->module = NULL;
+        }
+
+        if (!src || LLVMLinkModules2(mod, src)) {
             elog_fmt("Failed to link '{cstr}'\n", T->file);
 
-            LLVMContextSetDiagnosticHandler(LLVMGetGlobalContext(), old_handler, old_context);
+            LLVMContextSetDiagnosticHandler(context, old_handler, old_context);
             LLVMDisposeModule(mod);
-            LLVMDisposeModule(copy);
-            return true;
+
+            return NULL;
         }
     }
 
-    LLVMContextSetDiagnosticHandler(LLVMGetGlobalContext(), old_handler, old_context);
+    LLVMContextSetDiagnosticHandler(context, old_handler, old_context);
+
+    return mod;
+}
+
+bool tu_merge(CliState *S, TranslationUnit *out, TranslationUnit *tus, size_t n_tus) {
+    LLVMModuleRef mod = merge(S, tus, n_tus, false);
+    if (!mod) {
+        return true;
+    }
 
     *out = (TranslationUnit) {
         .module = mod,
@@ -330,44 +596,69 @@ bool tu_merge(CliState *S, TranslationUnit *out, TranslationUnit *tus, size_t n_
     return false;
 }
 
+LLVMModuleRef tu_link(CliState *S, TranslationUnit *tus, size_t n_tus) {
+    return merge(S, tus, n_tus, true);
+}
+
 // Currently bundles all objects
 bool tu_emit_binary(CliState *S, TranslationUnit *tus, size_t n_tus) {
-    TranslationUnit merged;
-    if (tu_merge(S, &merged, tus, n_tus)) {
+    // Nothing needs the per-unit modules after this, so they are linked destructively
+    TranslationUnit merged = {
+        .file = S->out_file,
+        .module = tu_link(S, tus, n_tus),
+    };
+
+    if (!merged.module) {
         return true;
     }
 
-    char *merged_file = replace_extension(S->out_file, ".temp.o");
-    merged.file = merged_file;
-
-    if (tu_emit_objects(S, &merged, 1, OBJECT_FILE)) {
+    if (S->lto != LTO_NONE && tu_lto(S, &merged)) {
         tu_free(&merged);
-        gramina_free(merged_file);
         return true;
     }
 
-    StringView filename_view = mk_sv_c(merged_file);
-    if (cli_link_objects(S, &filename_view, 1)) {
-        if (!S->keep_temps) {
-            remove(merged_file);
+    size_t n_parts = tu_partition_count(S, &merged);
+
+    char *files[n_parts];
+    StringView file_views[n_parts];
+
+    for (size_t i = 0; i < n_parts; ++i) {
+        char extension[32] = ".temp.o";
+        if (n_parts > 1) {
+            snprintf(extension, sizeof extension, ".temp.%zu.o", i);
         }
 
-        tu_free(&merged);
-        gramina_free(merged_file);
-        return true;
+        files[i] = replace_extension(S->out_file, extension);
+        file_views[i] = mk_sv_c(files[i]);
     }
 
-    if (!S->keep_temps) {
-        remove(merged_file);
+    bool err;
+    if (n_parts > 1) {
+        err = tu_emit_partitions(S, &merged, files, n_parts);
+    } else {
+        merged.file = files[0];
+        err = tu_emit_objects(S, &merged, 1, OBJECT_FILE);
     }
 
     tu_free(&merged);
-    gramina_free(merged_file);
-    return false;
+
+    if (!err) {
+        err = cli_link_objects(S, file_views, n_parts);
+    }
+
+    for (size_t i = 0; i < n_parts; ++i) {
+        if (!S->keep_temps) {
+            remove(files[i]);
+        }
+
+        gramina_free(files[i]);
+    }
+
+    return err;
 }
 
 void tu_free(TranslationUnit *this) {
-    stream_free(&this->fstream);
+    mapped_file_free(&this->source);
 
     lex_result_free(&this->lex_result);
     parse_result_free(&this->parse_result);
@@ -383,4 +674,8 @@ void tu_free(TranslationUnit *this) {
     if (this->compile_result.module) {
         LLVMDisposeModule(this->compile_result.module);
     }
+
+    if (this->context) {
+        LLVMContextDispose(this->context);
+    }
 }
@@ -78,6 +78,14 @@ static bool populate_arg(int argc, char **argv, size_t *i, ArgumentInfo *info, A
     return false;
 }
 
+static void attach_param(ArgumentInfo *info, const char *param) {
+    if (info->param_needs != GRAMINA_PARAM_MULTI) {
+        info->param = param;
+    } else {
+        array_append(_GraminaArgString, info->multi_params, param);
+    }
+}
+
 static bool validate_arg(Arguments *S, ArgumentInfo *this) {
     if (!this->found) {
         return false;
@@ -116,7 +124,12 @@ bool gramina_args_parse(Arguments *this, int argc, char **argv) {
         }
 
         if (current[0] == '-' && current[1] == '-') {
-            StringView long_arg = mk_sv_c(current + 2);
+            // `--name=param` carries its parameter in the same word
+            char *attached = strchr(current + 2, '=');
+
+            StringView long_arg = attached
+                                ? mk_sv_buf((uint8_t *)current + 2, attached - current - 2)
+                                : mk_sv_c(current + 2);
 
             ArgumentInfo *info = find_named(this, &long_arg);
             if (!info) {
@@ -130,6 +143,16 @@ bool gramina_args_parse(Arguments *this, int argc, char **argv) {
 
             info->found = true;
 
+            if (attached) {
+                if (info->param_needs == GRAMINA_PARAM_NONE) {
+                    this->error = str_cfmt("Argument '{sv}' does not take a parameter", &long_arg);
+                    return true;
+                }
+
+                attach_param(info, attached + 1);
+                continue;
+            }
+
             if (populate_arg(argc, argv, &i, info, this)) {
                 return true;
             }
@@ -158,6 +181,12 @@ bool gramina_args_parse(Arguments *this, int argc, char **argv) {
 
                 info->found = true;
 
+                // The rest of the word is the parameter, as in `-O2` or `-j4`
+                if (info->param_needs != GRAMINA_PARAM_NONE && j + 1 < flags.length) {
+                    attach_param(info, current + 2 + j);
+                    break;
+                }
+
                 if (j + 1 == flags.length) {
                     bool status = populate_arg(argc, argv, &i, info, this);
                     if (status) {
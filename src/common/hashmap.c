@@ -1,159 +1,243 @@
 #define GRAMINA_NO_NAMESPACE
 
 #include <stdint.h>
+#include <string.h>
 
 #include "common/hashmap.h"
 
-GRAMINA_IMPLEMENT_ARRAY(HashmapItem)
+#define MIN_CAPACITY 8
 
-// FNV-1a
-static uint64_t hash_str(const StringView *str) {
-    uint64_t h = 0xCBF29CE484222325;
+// Fibonacci hashing, symbols are dense small integers
+static uint32_t hash_symbol(Symbol key) {
+    return (uint32_t)(((uint64_t)key * 0x9E3779B97F4A7C15) >> 32) | 0x80000000;
+}
+
+static size_t probe_distance(const Hashmap *this, uint32_t hash, size_t slot) {
+    return (slot - (hash & (this->capacity - 1))) & (this->capacity - 1);
+}
 
-    sv_foreach(_, b, *str) {
-        h ^= b;
-        h *= 0x100000001B3;
+static size_t round_capacity(size_t n) {
+    size_t capacity = MIN_CAPACITY;
+    while (capacity < n) {
+        capacity *= 2;
     }
 
-    return h;
+    return capacity;
 }
 
-static size_t get_bucket(const Hashmap *this, const StringView *str) {
-    return hash_str(str) % this->n_buckets;
+// Assumes `key` is not present and there is room for it
+static void insert_new(Hashmap *this, HashmapItem item) {
+    size_t mask = this->capacity - 1;
+    size_t slot = item.hash & mask;
+    size_t dist = 0;
+
+    while (true) {
+        HashmapItem *cur = &this->items[slot];
+        if (cur->hash == 0) {
+            *cur = item;
+            ++this->count;
+            return;
+        }
+
+        // Robin Hood: take the slot from entries closer to their home
+        size_t cur_dist = probe_distance(this, cur->hash, slot);
+        if (cur_dist < dist) {
+            HashmapItem evicted = *cur;
+            *cur = item;
+            item = evicted;
+            dist = cur_dist;
+        }
+
+        slot = (slot + 1) & mask;
+        ++dist;
+    }
 }
 
-Hashmap gramina_mk_hashmap(size_t n_buckets) {
-    if (n_buckets == 0) {
-        return (Hashmap) {
-            .n_buckets = 0,
-            .buckets = NULL,
-            .object_freer = NULL,
-        };
+static bool resize(Hashmap *this, size_t capacity) {
+    HashmapItem *items = gramina_malloc(capacity * sizeof *items);
+    if (!items) {
+        return false;
     }
 
-    Hashmap this = {
-        .n_buckets = n_buckets
-    };
+    memset(items, 0, capacity * sizeof *items);
+
+    HashmapItem *old_items = this->items;
+    size_t old_capacity = this->capacity;
+
+    this->items = items;
+    this->capacity = capacity;
+    this->count = 0;
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_items[i].hash != 0) {
+            insert_new(this, old_items[i]);
+        }
+    }
 
-    this.buckets = gramina_malloc((sizeof *this.buckets) * n_buckets);
-    if (!this.buckets) {
-        return (Hashmap) {
-            .n_buckets = 0,
-            .buckets = NULL,
-            .object_freer = NULL,
-        };
+    gramina_free(old_items);
+    return true;
+}
+
+static HashmapItem *find(const Hashmap *this, Symbol key) {
+    if (this->count == 0) {
+        return NULL;
+    }
+
+    uint32_t hash = hash_symbol(key);
+    size_t mask = this->capacity - 1;
+    size_t slot = hash & mask;
+
+    for (size_t dist = 0; ; ++dist) {
+        HashmapItem *cur = &this->items[slot];
+
+        // An entry closer to home than we are means the key can't be further
+        if (cur->hash == 0 || probe_distance(this, cur->hash, slot) < dist) {
+            return NULL;
+        }
+
+        if (cur->hash == hash && cur->key == key) {
+            return cur;
+        }
+
+        slot = (slot + 1) & mask;
     }
+}
+
+Hashmap gramina_mk_hashmap(size_t capacity) {
+    Hashmap this = {
+        .capacity = 0,
+        .count = 0,
+        .items = NULL,
+        .object_freer = NULL,
+    };
 
-    for (size_t i = 0; i < n_buckets; ++i) {
-        this.buckets[i] = mk_array(HashmapItem);
+    if (capacity != 0) {
+        // Leave room so `capacity` entries fit without growing
+        resize(&this, round_capacity(capacity + capacity / 3 + 1));
     }
 
-    this.object_freer = NULL;
     return this;
 }
 
 Hashmap gramina_hashmap_dup(const Hashmap *this) {
-    Hashmap that = mk_hashmap(this->n_buckets);
-    that.object_freer = this->object_freer;
-
-    that.buckets = gramina_malloc((sizeof *that.buckets) * that.n_buckets);
-    if (!that.buckets) {
-        return (Hashmap) {
-            .n_buckets = 0,
-            .buckets = NULL,
-            .object_freer = NULL,
-        };
+    Hashmap that = {
+        .capacity = 0,
+        .count = 0,
+        .items = NULL,
+        .object_freer = this->object_freer,
+    };
+
+    if (this->capacity == 0) {
+        return that;
     }
 
-    for (size_t i = 0; i < that.n_buckets; ++i) {
-        that.buckets[i] = array_dup(HashmapItem, &this->buckets[i]);
+    that.items = gramina_malloc(this->capacity * sizeof *that.items);
+    if (!that.items) {
+        return that;
     }
 
+    memcpy(that.items, this->items, this->capacity * sizeof *that.items);
+    that.capacity = this->capacity;
+    that.count = this->count;
+
     return that;
 }
 
 size_t gramina_hashmap_count(const Hashmap *this) {
-    size_t count = 0;
-
-    for (size_t i = 0; i < this->n_buckets; ++i) {
-        count += this->buckets[i].length;
-    }
-
-    return count;
+    return this->count;
 }
 
-void gramina_hashmap_set(Hashmap *this, StringView key, void *value) {
-    size_t bucket = get_bucket(this, &key);
+void gramina_hashmap_set_sym(Hashmap *this, Symbol key, void *value) {
+    HashmapItem *existing = find(this, key);
+    if (existing) {
+        if (this->object_freer) {
+            this->object_freer(existing->value);
+        }
 
-    array_foreach_ref(HashmapItem, _, item, this->buckets[bucket]) {
-        StringView this_key = str_as_view(&item->key);
-        if (sv_cmp(&this_key, &key) == 0) {
-            if (this->object_freer) {
-                this->object_freer(item->value);
-            }
+        existing->value = value;
+        return;
+    }
 
-            str_free(&item->key);
+    // Keep the load factor at or below 3/4
+    if ((this->count + 1) * 4 > this->capacity * 3) {
+        size_t capacity = this->capacity == 0
+                        ? MIN_CAPACITY
+                        : this->capacity * 2;
 
-            item->value = value;
+        if (!resize(this, capacity)) {
             return;
         }
     }
 
-    HashmapItem item = {
-        .key = sv_dup(&key),
+    insert_new(this, (HashmapItem) {
+        .key = key,
+        .hash = hash_symbol(key),
         .value = value,
-    };
-
-    array_append(HashmapItem, &this->buckets[bucket], item);
+    });
 }
 
-void *gramina_hashmap_get(const Hashmap *this, StringView key) {
-    size_t bucket = get_bucket(this, &key);
+void *gramina_hashmap_get_sym(const Hashmap *this, Symbol key) {
+    HashmapItem *item = find(this, key);
+    return item ? item->value : NULL;
+}
 
-    array_foreach_ref(HashmapItem, _, item, this->buckets[bucket]) {
-        StringView this_key = str_as_view(&item->key);
-        if (sv_cmp(&this_key, &key) == 0) {
-            return item->value;
-        }
+void gramina_hashmap_remove_sym(Hashmap *this, Symbol key) {
+    HashmapItem *item = find(this, key);
+    if (!item) {
+        return;
     }
 
-    return NULL;
-}
-
-void gramina_hashmap_remove(Hashmap *this, StringView key) {
-    size_t bucket = get_bucket(this, &key);
+    if (this->object_freer) {
+        this->object_freer(item->value);
+    }
 
-    array_foreach_ref(HashmapItem, idx, item, this->buckets[bucket]) {
-        StringView this_key = str_as_view(&item->key);
-        if (sv_cmp(&this_key, &key) == 0) {
-            if (this->object_freer) {
-                this->object_freer(item->value);
-            }
+    // Backward shift deletion: pull the rest of the run one slot closer to
+    // home until an empty slot or an entry already at home is reached
+    size_t mask = this->capacity - 1;
+    size_t slot = item - this->items;
 
-            str_free(&item->key);
+    while (true) {
+        size_t next = (slot + 1) & mask;
+        HashmapItem *cur = &this->items[next];
 
-            array_remove(HashmapItem, &this->buckets[bucket], idx);
+        if (cur->hash == 0 || probe_distance(this, cur->hash, next) == 0) {
             break;
         }
+
+        this->items[slot] = *cur;
+        slot = next;
     }
+
+    this->items[slot] = (HashmapItem) {};
+    --this->count;
+}
+
+void gramina_hashmap_set(Hashmap *this, StringView key, void *value) {
+    gramina_hashmap_set_sym(this, intern(&key), value);
+}
+
+void *gramina_hashmap_get(const Hashmap *this, StringView key) {
+    return gramina_hashmap_get_sym(this, intern(&key));
+}
+
+void gramina_hashmap_remove(Hashmap *this, StringView key) {
+    gramina_hashmap_remove_sym(this, intern(&key));
 }
 
 void gramina_hashmap_free(Hashmap *this) {
-    for (size_t i = 0; i < this->n_buckets; ++i) {
-        array_foreach(HashmapItem, _, el, this->buckets[i]) {
-            if (this->object_freer) {
-                this->object_freer(el.value);
+    if (this->object_freer) {
+        for (size_t i = 0; i < this->capacity; ++i) {
+            if (this->items[i].hash != 0) {
+                this->object_freer(this->items[i].value);
             }
-
-            str_free(&el.key);
         }
-
-        array_free(HashmapItem, &this->buckets[i]);
     }
 
-    gramina_free(this->buckets);
+    gramina_free(this->items);
 
-    this->buckets = NULL;
+    this->items = NULL;
+    this->capacity = 0;
+    this->count = 0;
     this->object_freer = NULL;
 }
 
@@ -1,8 +1,10 @@
 #include "common/init.h"
+#include "common/intern.h"
 #include "common/log.h"
 
 void gramina_init() {}
 
 void gramina_cleanup() {
     __gramina_log_cleanup();
+    __gramina_intern_cleanup();
 }
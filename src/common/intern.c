@@ -0,0 +1,214 @@
+#define GRAMINA_NO_NAMESPACE
+
+#include <string.h>
+
+#include "common/def.h"
+#include "common/intern.h"
+#include "common/mem.h"
+
+#ifdef GRAMINA_UNIX_BUILD
+#  include <pthread.h>
+
+// Translation units may be lexed and compiled on several threads at once
+static pthread_mutex_t interner_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#  define LOCK() pthread_mutex_lock(&interner_lock)
+#  define UNLOCK() pthread_mutex_unlock(&interner_lock)
+#else
+#  define LOCK()
+#  define UNLOCK()
+#endif
+
+#define INITIAL_SLOTS 1024
+
+typedef struct {
+    StringView str;
+    uint32_t hash;
+} Entry;
+
+/**
+ * `slots` is an open-addressing table of `symbol + 1` (zero marks an empty
+ * slot), probed linearly. Entries are never removed, so no tombstones are
+ * needed. String bytes live in `storage` and never move.
+ */
+static struct {
+    Entry *entries;
+    size_t n_entries;
+    size_t entry_capacity;
+
+    uint32_t *slots;
+    size_t n_slots;
+
+    Arena storage;
+} interner;
+
+// FNV-1a
+static uint32_t hash_sv(const StringView *str) {
+    uint32_t h = 0x811C9DC5;
+
+    for (size_t i = 0; i < str->length; ++i) {
+        h ^= (uint8_t)str->data[i];
+        h *= 0x01000193;
+    }
+
+    return h;
+}
+
+static void insert_slot(uint32_t *slots, size_t n_slots, uint32_t hash, Symbol symbol) {
+    size_t mask = n_slots - 1;
+    size_t i = hash & mask;
+
+    while (slots[i] != 0) {
+        i = (i + 1) & mask;
+    }
+
+    slots[i] = symbol + 1;
+}
+
+static bool grow_slots() {
+    size_t n_slots = interner.n_slots == 0
+                   ? INITIAL_SLOTS
+                   : interner.n_slots * 2;
+
+    uint32_t *slots = gramina_malloc(n_slots * sizeof *slots);
+    if (slots == NULL) {
+        return false;
+    }
+
+    memset(slots, 0, n_slots * sizeof *slots);
+
+    for (size_t i = 0; i < interner.n_entries; ++i) {
+        insert_slot(slots, n_slots, interner.entries[i].hash, (Symbol)i);
+    }
+
+    gramina_free(interner.slots);
+    interner.slots = slots;
+    interner.n_slots = n_slots;
+
+    return true;
+}
+
+static Symbol push_entry(const StringView *str, uint32_t hash) {
+    if (interner.n_entries == interner.entry_capacity) {
+        size_t capacity = interner.entry_capacity == 0
+                        ? INITIAL_SLOTS / 2
+                        : interner.entry_capacity * 2;
+
+        Entry *entries = gramina_realloc(interner.entries, capacity * sizeof *entries);
+        gramina_assert(entries != NULL, "out of memory while interning\n");
+
+        interner.entries = entries;
+        interner.entry_capacity = capacity;
+    }
+
+    char *data = arena_alloc(&interner.storage, str->length + 1);
+    gramina_assert(data != NULL, "out of memory while interning\n");
+
+    memcpy(data, str->data, str->length);
+
+    Symbol symbol = (Symbol)interner.n_entries++;
+    interner.entries[symbol] = (Entry) {
+        .str = {
+            .length = str->length,
+            .data = data,
+        },
+        .hash = hash,
+    };
+
+    return symbol;
+}
+
+// Symbol 0 is always the empty string
+static void ensure_init() {
+    if (interner.n_slots != 0) {
+        return;
+    }
+
+    if (!grow_slots()) {
+        gramina_assert(false, "out of memory while interning\n");
+    }
+
+    StringView empty = { .length = 0, .data = "" };
+    uint32_t hash = hash_sv(&empty);
+    insert_slot(interner.slots, interner.n_slots, hash, push_entry(&empty, hash));
+}
+
+static Symbol intern_locked(const StringView *str) {
+    ensure_init();
+
+    // Keep the load factor at or below 1/2
+    if ((interner.n_entries + 1) * 2 > interner.n_slots) {
+        if (!grow_slots()) {
+            gramina_assert(false, "out of memory while interning\n");
+        }
+    }
+
+    uint32_t hash = hash_sv(str);
+    size_t mask = interner.n_slots - 1;
+    size_t i = hash & mask;
+
+    while (interner.slots[i] != 0) {
+        const Entry *entry = &interner.entries[interner.slots[i] - 1];
+        if (entry->hash == hash
+         && entry->str.length == str->length
+         && memcmp(entry->str.data, str->data, str->length) == 0) {
+            return interner.slots[i] - 1;
+        }
+
+        i = (i + 1) & mask;
+    }
+
+    Symbol symbol = push_entry(str, hash);
+    interner.slots[i] = symbol + 1;
+
+    return symbol;
+}
+
+Symbol gramina_intern(const StringView *str) {
+    LOCK();
+    Symbol symbol = intern_locked(str);
+    UNLOCK();
+
+    return symbol;
+}
+
+Symbol gramina_intern_c(const char *cstr) {
+    StringView str = mk_sv_c(cstr);
+    return intern(&str);
+}
+
+StringView gramina_symbol_view(Symbol symbol) {
+    LOCK();
+
+    // `entries` may be reallocated by a concurrent `intern`, the bytes never move
+    if (symbol >= interner.n_entries) {
+        UNLOCK();
+        gramina_assert(symbol == GRAMINA_SYMBOL_EMPTY, "invalid symbol %u\n", (unsigned)symbol);
+        return (StringView) { .length = 0, .data = "" };
+    }
+
+    StringView view = interner.entries[symbol].str;
+    UNLOCK();
+
+    return view;
+}
+
+const char *gramina_symbol_cstr(Symbol symbol) {
+    return symbol_view(symbol).data;
+}
+
+size_t gramina_symbol_count() {
+    LOCK();
+    size_t count = interner.n_entries;
+    UNLOCK();
+
+    return count;
+}
+
+void __gramina_intern_cleanup() {
+    gramina_free(interner.entries);
+    gramina_free(interner.slots);
+    arena_free(&interner.storage);
+
+    memset(&interner, 0, sizeof interner);
+}
@@ -82,6 +82,9 @@ Stream gramina_mk_stream_log(LogLevel level) {
     base.cleaner = log_stream_cleaner,
     base.writer = log_stream_writer;
 
+    // Each flushed chunk becomes its own log entry, so keep them to whole lines
+    base.line_buffered = true;
+
     return base;
 }
 
@@ -0,0 +1,138 @@
+#define GRAMINA_NO_NAMESPACE
+
+#include <errno.h>
+#include <stdio.h>
+
+#include "common/def.h"
+#include "common/mapped.h"
+#include "common/mem.h"
+
+#ifdef GRAMINA_UNIX_BUILD
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
+// Pipes can't be sized up front, so the buffer grows until EOF
+static int read_whole_file(MappedFile *this, FILE *file) {
+    size_t capacity = 4096;
+    size_t length = 0;
+    char *buf = gramina_malloc(capacity);
+
+    while (true) {
+        length += fread(buf + length, 1, capacity - length, file);
+
+        if (ferror(file)) {
+            gramina_free(buf);
+            fclose(file);
+            return EIO;
+        }
+
+        if (feof(file)) {
+            break;
+        }
+
+        if (length == capacity) {
+            capacity *= 2;
+            buf = gramina_realloc(buf, capacity);
+        }
+    }
+
+    fclose(file);
+
+    *this = (MappedFile) {
+        .contents = {
+            .data = buf,
+            .length = length,
+        },
+        .is_mapped = false,
+    };
+
+    return 0;
+}
+
+#ifndef GRAMINA_UNIX_BUILD
+static int open_and_read(MappedFile *this, const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        return errno;
+    }
+
+    return read_whole_file(this, file);
+}
+#else
+// Reading through the descriptor that was already opened keeps one-shot files like pipes intact
+static int read_fd(MappedFile *this, int fd) {
+    FILE *file = fdopen(fd, "rb");
+    if (!file) {
+        int err = errno;
+        close(fd);
+        return err;
+    }
+
+    return read_whole_file(this, file);
+}
+#endif
+
+int gramina_map_file(MappedFile *this, const char *filename) {
+    *this = (MappedFile) {};
+
+#ifdef GRAMINA_UNIX_BUILD
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return errno;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int err = errno;
+        close(fd);
+        return err;
+    }
+
+    // Zero length mappings are invalid, pipes and the like cannot be mapped
+    if (!S_ISREG(st.st_mode) || st.st_size == 0) {
+        return read_fd(this, fd);
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        return read_fd(this, fd);
+    }
+
+    close(fd);
+
+#  ifdef MADV_SEQUENTIAL
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+#  endif
+
+    *this = (MappedFile) {
+        .contents = {
+            .data = data,
+            .length = st.st_size,
+        },
+        .is_mapped = true,
+    };
+
+    return 0;
+#else
+    return open_and_read(this, filename);
+#endif
+}
+
+void gramina_mapped_file_free(MappedFile *this) {
+    if (!this->contents.data) {
+        return;
+    }
+
+#ifdef GRAMINA_UNIX_BUILD
+    if (this->is_mapped) {
+        munmap((void *)this->contents.data, this->contents.length);
+        *this = (MappedFile) {};
+        return;
+    }
+#endif
+
+    gramina_free((void *)this->contents.data);
+    *this = (MappedFile) {};
+}
@@ -0,0 +1,99 @@
+#define GRAMINA_NO_NAMESPACE
+
+#include <string.h>
+
+#include "common/mem.h"
+
+typedef struct gramina_arena_block {
+    struct gramina_arena_block *next;
+    size_t used;
+    size_t capacity;
+} ArenaBlock;
+
+static size_t align_up(size_t n) {
+    return (n + GRAMINA_ARENA_ALIGNMENT - 1) & ~(size_t)(GRAMINA_ARENA_ALIGNMENT - 1);
+}
+
+#define BLOCK_HEADER_SIZE align_up(sizeof(ArenaBlock))
+#define BLOCK_DATA(block) ((unsigned char *)(block) + BLOCK_HEADER_SIZE)
+
+static ArenaBlock *mk_block(size_t capacity) {
+    ArenaBlock *block = gramina_malloc(BLOCK_HEADER_SIZE + capacity);
+    if (block == NULL) {
+        return NULL;
+    }
+
+    block->next = NULL;
+    block->used = 0;
+    block->capacity = capacity;
+
+    return block;
+}
+
+Arena gramina_mk_arena(size_t block_size) {
+    return (Arena) {
+        .head = NULL,
+        .block_size = block_size,
+    };
+}
+
+void gramina_arena_free(Arena *this) {
+    ArenaBlock *cur = this->head;
+    while (cur) {
+        ArenaBlock *next = cur->next;
+        gramina_free(cur);
+        cur = next;
+    }
+
+    this->head = NULL;
+}
+
+void *gramina_arena_alloc(Arena *this, size_t size) {
+    size = align_up(size == 0 ? 1 : size);
+
+    size_t block_size = this->block_size == 0
+                      ? GRAMINA_ARENA_DEFAULT_BLOCK_SIZE
+                      : this->block_size;
+
+    ArenaBlock *head = this->head;
+    if (head && head->capacity - head->used >= size) {
+        void *ptr = BLOCK_DATA(head) + head->used;
+        head->used += size;
+
+        memset(ptr, 0, size);
+        return ptr;
+    }
+
+    // Oversized requests get a dedicated block which is linked behind the
+    // current one, so the remaining space in the head is not wasted
+    if (size > block_size / 4) {
+        ArenaBlock *block = mk_block(size);
+        if (block == NULL) {
+            return NULL;
+        }
+
+        block->used = size;
+
+        if (head) {
+            block->next = head->next;
+            head->next = block;
+        } else {
+            this->head = block;
+        }
+
+        memset(BLOCK_DATA(block), 0, size);
+        return BLOCK_DATA(block);
+    }
+
+    ArenaBlock *block = mk_block(block_size);
+    if (block == NULL) {
+        return NULL;
+    }
+
+    block->next = head;
+    block->used = size;
+    this->head = block;
+
+    memset(BLOCK_DATA(block), 0, size);
+    return BLOCK_DATA(block);
+}
@@ -26,11 +26,49 @@ Stream gramina_mk_stream() {
         .cleaner = NULL,
         .validator = NULL,
         .userdata = NULL,
-        // .max_buffered_bytes = 1024,
-        // .out_buffer = mk_str(),
+        .max_buffered_bytes = GRAMINA_STREAM_DEFAULT_BUFFER_SIZE,
+        .line_buffered = false,
+        .out_buffer = mk_str(),
+        .in_buffer = mk_str(),
+        .in_buffer_idx = 0,
+        .in_status = 0,
     };
 }
 
+static int drain_out_buffer(Stream *this, size_t n_bytes) {
+    if (n_bytes == 0) {
+        return 0;
+    }
+
+    int status = this->writer(this, (const uint8_t *)this->out_buffer.data, n_bytes);
+
+    size_t n_left = this->out_buffer.length - n_bytes;
+    memmove(this->out_buffer.data, this->out_buffer.data + n_bytes, n_left);
+    this->out_buffer.length = n_left;
+
+    return status;
+}
+
+static int drain_complete_lines(Stream *this) {
+    size_t end = this->out_buffer.length;
+    while (end > 0 && this->out_buffer.data[end - 1] != '\n') {
+        --end;
+    }
+
+    return drain_out_buffer(this, end);
+}
+
+static size_t fill_in_buffer(Stream *this) {
+    str_reserve(&this->in_buffer, this->max_buffered_bytes);
+
+    size_t n_read = 0;
+    this->in_status = this->reader(this, (uint8_t *)this->in_buffer.data, this->max_buffered_bytes, &n_read);
+    this->in_buffer.length = n_read;
+    this->in_buffer_idx = 0;
+
+    return n_read;
+}
+
 static int __gramina_fs_reader(Stream *this, uint8_t *buf, size_t bufsize, size_t *read) {
     struct __gramina_fs_data *data = this->userdata;
     FILE *file = data->file;
@@ -237,9 +275,27 @@ Stream gramina_mk_stream_str_own(String str, bool readable, bool writable) {
     return this;
 }
 
+int gramina_stream_set_buffering(Stream *this, size_t max_buffered_bytes, bool line_buffered) {
+    int status = 0;
+    if (stream_is_writable(this)) {
+        status = drain_out_buffer(this, this->out_buffer.length);
+    }
+
+    this->max_buffered_bytes = max_buffered_bytes;
+    this->line_buffered = line_buffered;
+
+    return status;
+}
+
 void gramina_stream_shrink(Stream *this) {
-    // str_shrink(&this->in_buffer);
-    // str_shrink(&this->out_buffer);
+    if (this->out_buffer.length == 0) {
+        str_free(&this->out_buffer);
+    }
+
+    if (this->in_buffer_idx >= this->in_buffer.length) {
+        str_free(&this->in_buffer);
+        this->in_buffer_idx = 0;
+    }
 }
 
 void gramina_stream_free(Stream *this) {
@@ -249,8 +305,8 @@ void gramina_stream_free(Stream *this) {
         this->cleaner(this);
     }
 
-    // str_free(&this->in_buffer);
-    // str_free(&this->out_buffer);
+    str_free(&this->in_buffer);
+    str_free(&this->out_buffer);
 }
 
 bool gramina_stream_is_readable(const Stream *this) {
@@ -270,21 +326,19 @@ bool gramina_stream_is_valid(const Stream *this) {
 }
 
 int gramina_stream_flush(Stream *this) {
-    /*
+    int status = 0;
     if (stream_is_writable(this)) {
-        this->writer(
-            this,
-            (const unsigned char *)this->out_buffer.data,
-            this->out_buffer.length
-        );
+        status = drain_out_buffer(this, this->out_buffer.length);
     }
-    */
 
     if (this->flusher != NULL) {
-        return this->flusher(this);
+        int flush_status = this->flusher(this);
+        if (!status) {
+            status = flush_status;
+        }
     }
 
-    return 0;
+    return status;
 }
 
 int gramina_stream_write_sv(Stream *this, const StringView *sv) {
@@ -317,36 +371,30 @@ int gramina_stream_write_buf(Stream *this, const uint8_t *buf, size_t bufsize) {
         return EINVAL;
     }
 
-    /*
-    if (this->out_buffer.length >= this->max_buffered_bytes) {
-        int status = stream_flush(this);
+    if (this->max_buffered_bytes == 0) {
+        return this->writer(this, buf, bufsize);
+    }
+
+    if (this->out_buffer.length + bufsize > this->max_buffered_bytes) {
+        int status = drain_out_buffer(this, this->out_buffer.length);
         if (status) {
             return status;
         }
-
-        str_clear(&this->out_buffer);
     }
 
-    size_t available = this->max_buffered_bytes - this->out_buffer.length;
-    if (available >= bufsize) {
-        int status = 0;
-        StringView data = mk_sv_buf(buf, bufsize);
-        str_cat_sv(&this->out_buffer, &data);
-
-        if (available == bufsize) {
-            status = stream_flush(this);
-        }
-
-        return status;
+    // Writes that would fill the buffer on their own skip the copy
+    if (bufsize >= this->max_buffered_bytes) {
+        return this->writer(this, buf, bufsize);
     }
 
-    int status = stream_flush(this);
-    if (status) {
-        return status;
+    StringView data = mk_sv_buf(buf, bufsize);
+    str_cat_sv(&this->out_buffer, &data);
+
+    if (this->line_buffered && memchr(buf, '\n', bufsize)) {
+        return drain_complete_lines(this);
     }
-    */
 
-    return this->writer(this, buf, bufsize);
+    return 0;
 }
 
 int gramina_stream_write_byte(struct gramina_stream *this, uint8_t byte) {
@@ -367,25 +415,17 @@ int gramina_stream_read_str(Stream *this, String *str, size_t max_bytes, size_t
 
     int64_t read_left = max_bytes;
     while (read_left > 0) {
-        size_t bufsize = 128;
-        if (read_left < 128) {
+        size_t bufsize = GRAMINA_STREAM_DEFAULT_BUFFER_SIZE;
+        if (read_left < GRAMINA_STREAM_DEFAULT_BUFFER_SIZE) {
             bufsize = read_left;
         }
 
         str_reserve(str, str->length + bufsize);
-        size_t buf_idx = str->length;
-
-        for (size_t i = 0; i < bufsize; ++i) {
-            str_append(str, '\0');
-        }
 
-        size_t r;
-        int status = this->reader(this, (uint8_t *)str->data + buf_idx, bufsize, &r);
-
-        for (size_t i = 0; i < (bufsize - r); ++i) {
-            str_pop(str);
-        }
+        size_t r = 0;
+        int status = stream_read_buf(this, (uint8_t *)str->data + str->length, bufsize, &r);
 
+        str->length += r;
         *read += r;
         read_left -= bufsize;
 
@@ -402,7 +442,64 @@ int gramina_stream_read_buf(Stream *this, uint8_t *buf, size_t max_bytes, size_t
         return EINVAL;
     }
 
-    return this->reader(this, buf, max_bytes, read);
+    // Whatever was written so far must be visible to the reader
+    if (stream_is_writable(this)) {
+        int status = drain_out_buffer(this, this->out_buffer.length);
+        if (status) {
+            return status;
+        }
+    }
+
+    if (this->max_buffered_bytes == 0) {
+        return this->reader(this, buf, max_bytes, read);
+    }
+
+    size_t n_read = 0;
+    int status = 0;
+
+    while (n_read < max_bytes) {
+        size_t available = this->in_buffer.length - this->in_buffer_idx;
+        size_t wanted = max_bytes - n_read;
+
+        if (available > 0) {
+            size_t n = wanted < available
+                     ? wanted
+                     : available;
+
+            memcpy(buf + n_read, this->in_buffer.data + this->in_buffer_idx, n);
+            this->in_buffer_idx += n;
+            n_read += n;
+
+            continue;
+        }
+
+        if (this->in_status) {
+            break;
+        }
+
+        if (wanted >= this->max_buffered_bytes) {
+            size_t r = 0;
+            status = this->reader(this, buf + n_read, wanted, &r);
+            n_read += r;
+            break;
+        }
+
+        if (fill_in_buffer(this) == 0) {
+            break;
+        }
+    }
+
+    // Report EOF and errors together with the last bytes, like the readers do
+    if (!status && this->in_buffer_idx >= this->in_buffer.length) {
+        status = this->in_status;
+        this->in_status = 0;
+    }
+
+    if (read) {
+        *read = n_read;
+    }
+
+    return status;
 }
 
 int gramina_stream_read_byte(struct gramina_stream *this, uint8_t *byte) {
@@ -6,9 +6,22 @@
 #include "compiler/access.h"
 #include "compiler/errors.h"
 #include "compiler/mem.h"
+#include "compiler/type.h"
 #include "compiler/typedecl.h"
 #include "compiler/value.h"
 
+// GEP sign extends narrower indices, which would turn large unsigned ones negative
+static LLVMValueRef index_operand(CompilerState *S, const Value *index) {
+    LLVMTypeRef intptr = LLVMIntPtrTypeInContext(S->llvm_context, S->llvm_target_data);
+
+    if (!primitive_is_unsigned(index->type.primitive)
+     || LLVMGetIntTypeWidth(index->type.llvm) >= LLVMGetIntTypeWidth(intptr)) {
+        return index->llvm;
+    }
+
+    return LLVMBuildZExt(S->llvm_builder, index->llvm, intptr, "");
+}
+
 Value subscript(CompilerState *S, const Value *_scriptee, const Value *_scripter) {
     Value scriptee = try_load(S, _scriptee);
     Value scripter = try_load(S, _scripter);
@@ -31,8 +44,8 @@ Value subscript(CompilerState *S, const Value *_scriptee, const Value *_scripter
             scriptee.type.llvm,
             scriptee.llvm,
             (LLVMValueRef[2]) {
-                LLVMConstInt(LLVMInt32Type(), 0, false),
-                scripter.llvm,
+                LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), 0, false),
+                index_operand(S, &scripter),
             }, 2, ""
         );
 
@@ -63,11 +76,12 @@ Value subscript(CompilerState *S, const Value *_scriptee, const Value *_scripter
             break;
         }
 
+        LLVMValueRef index = index_operand(S, &scripter);
         LLVMValueRef result = LLVMBuildGEP2(
             S->llvm_builder,
             scriptee.type.pointer_type->llvm,
             scriptee.llvm,
-            &scripter.llvm,
+            &index,
             1, ""
         );
 
@@ -106,6 +120,42 @@ Value subscript(CompilerState *S, const Value *_scriptee, const Value *_scripter
 
         return ret;
     }
+    case GRAMINA_TYPE_VECTOR: {
+        if (scripter.type.kind != GRAMINA_TYPE_PRIMITIVE
+         || !primitive_is_integral(scripter.type.primitive)) {
+            StringView op = mk_sv_c("subscript");
+            err_illegal_op(S, &scriptee.type, &scripter.type, &op);
+            break;
+        }
+
+        LLVMValueRef index = index_operand(S, &scripter);
+
+        Value ret = {
+            .type = type_dup(scriptee.type.element_type),
+            .llvm = LLVMBuildExtractElement(S->llvm_builder, scriptee.llvm, index, ""),
+            .class = GRAMINA_CLASS_RVALUE,
+        };
+
+        ret.type.is_const = scriptee.type.is_const;
+
+        // `bool` lanes are packed into bits, so they can't be addressed
+        if (scriptee.class == GRAMINA_CLASS_LVALUE
+         && scriptee.type.element_type->primitive != GRAMINA_PRIMITIVE_BOOL) {
+            ret.class = GRAMINA_CLASS_LVALUE;
+            ret.lvalue_ptr = LLVMBuildGEP2(
+                S->llvm_builder,
+                scriptee.type.element_type->llvm,
+                scriptee.lvalue_ptr,
+                &index,
+                1, ""
+            );
+        }
+
+        value_free(&scriptee);
+        value_free(&scripter);
+
+        return ret;
+    }
     default: {
         StringView op = mk_sv_c("subscript");
         err_illegal_op(S, &scriptee.type, &scripter.type, &op);
@@ -121,7 +171,7 @@ Value subscript(CompilerState *S, const Value *_scriptee, const Value *_scripter
     return invalid_value();
 }
 
-Value member(CompilerState *S, const Value *operand, const StringView *field_name) {
+Value member(CompilerState *S, const Value *operand, Symbol field_name) {
     Value lhs = try_load(S, operand);
 
     bool ptr_to_struct = lhs.type.kind == GRAMINA_TYPE_POINTER
@@ -142,9 +192,10 @@ Value member(CompilerState *S, const Value *operand, const StringView *field_nam
                       ? lhs.type.pointer_type
                       : &lhs.type;
 
-    StructField *field = hashmap_get(&struct_type->fields, *field_name);
+    StructField *field = hashmap_get_sym(&struct_type->fields, field_name);
     if (!field) {
-        err_no_field(S, &lhs.type, field_name);
+        StringView name = symbol_view(field_name);
+        err_no_field(S, &lhs.type, &name);
         value_free(&lhs);
 
         return invalid_value();
@@ -157,8 +208,8 @@ Value member(CompilerState *S, const Value *operand, const StringView *field_nam
         struct_type->llvm,
         lhs.llvm,
         (LLVMValueRef[2]){
-            LLVMConstInt(LLVMInt32Type(), 0, 0), // Pick the struct the pointer is pointing to directly
-            LLVMConstInt(LLVMInt32Type(), offset, 0),
+            LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), 0, 0), // Pick the struct the pointer is pointing to directly
+            LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), offset, 0),
         }, 2, ""
     );
 
@@ -189,11 +240,11 @@ Value gramina_get_property(CompilerState *S, const Value *object, const StringVi
                     lhs.type.llvm,
                     lhs.llvm,
                     (LLVMValueRef [2]) {
-                        LLVMConstInt(LLVMInt32Type(), 0, false),
-                        LLVMConstInt(LLVMInt32Type(), 1, false),
+                        LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), 0, false),
+                        LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), 1, false),
                     }, 2, ""
                 ),
-                .type = type_from_primitive(GRAMINA_PRIMITIVE_UINT),
+                .type = type_from_primitive(S, GRAMINA_PRIMITIVE_USIZE),
                 .class = GRAMINA_CLASS_RVALUE,
             };
 
@@ -207,11 +258,11 @@ Value gramina_get_property(CompilerState *S, const Value *object, const StringVi
                     lhs.type.llvm,
                     lhs.llvm,
                     (LLVMValueRef [2]) {
-                        LLVMConstInt(LLVMInt32Type(), 0, false),
-                        LLVMConstInt(LLVMInt32Type(), 0, false),
+                        LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), 0, false),
+                        LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), 0, false),
                     }, 2, ""
                 ),
-                .type = mk_pointer_type(lhs.type.slice_type),
+                .type = mk_pointer_type(S, lhs.type.slice_type),
                 .class = GRAMINA_CLASS_RVALUE,
             };
 
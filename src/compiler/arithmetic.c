@@ -5,19 +5,12 @@
 #include "compiler/errors.h"
 #include "compiler/mem.h"
 
-Value primitive_arithmetic(CompilerState *S, const Value *left, const Value *right, ArithmeticBinOp operation) {
-    Value lhs;
-    Value rhs;
-
-    CoercionResult coerced = coerce_primitives(S, left, right, &lhs, &rhs);
-    if (S->has_error) {
-        return invalid_value();
-    }
-
+// Vectors use the same instructions as their lanes
+static bool bin_opcode(Primitive lane, ArithmeticBinOp operation, LLVMOpcode *result) {
     LLVMOpcode op;
 
-    bool is_integer = primitive_is_integral(coerced.greater_type.primitive);
-    bool signedness = !primitive_is_unsigned(coerced.greater_type.primitive);
+    bool is_integer = primitive_is_integral(lane);
+    bool signedness = !primitive_is_unsigned(lane);
 
     switch (operation) {
     case GRAMINA_OP_ADD:
@@ -54,6 +47,24 @@ Value primitive_arithmetic(CompilerState *S, const Value *left, const Value *rig
         }
         break;
     default:
+        return false;
+    }
+
+    *result = op;
+    return true;
+}
+
+Value primitive_arithmetic(CompilerState *S, const Value *left, const Value *right, ArithmeticBinOp operation) {
+    Value lhs;
+    Value rhs;
+
+    CoercionResult coerced = coerce_primitives(S, left, right, &lhs, &rhs);
+    if (S->has_error) {
+        return invalid_value();
+    }
+
+    LLVMOpcode op;
+    if (!bin_opcode(coerced.greater_type.primitive, operation, &op)) {
         return invalid_value();
     }
 
@@ -72,6 +83,41 @@ Value primitive_arithmetic(CompilerState *S, const Value *left, const Value *rig
     return ret;
 }
 
+Value vector_arithmetic(CompilerState *S, const Value *left, const Value *right, ArithmeticBinOp operation) {
+    Value lhs;
+    Value rhs;
+
+    Type vector = coerce_vectors(S, left, right, &lhs, &rhs);
+    if (vector.kind == GRAMINA_TYPE_INVALID) {
+        return invalid_value();
+    }
+
+    LLVMOpcode op;
+    if (!bin_opcode(vector.element_type->primitive, operation, &op)) {
+        StringView op_str = get_arithmetic_bin_op(operation);
+        err_illegal_op(S, &left->type, &right->type, &op_str);
+
+        value_free(&lhs);
+        value_free(&rhs);
+        type_free(&vector);
+
+        return invalid_value();
+    }
+
+    Value ret = {
+        .llvm = LLVMBuildBinOp(S->llvm_builder, op, lhs.llvm, rhs.llvm, ""),
+        .type = vector,
+        .class = lhs.class == GRAMINA_CLASS_CONSTEXPR && rhs.class == GRAMINA_CLASS_CONSTEXPR
+               ? GRAMINA_CLASS_CONSTEXPR
+               : GRAMINA_CLASS_RVALUE,
+    };
+
+    value_free(&lhs);
+    value_free(&rhs);
+
+    return ret;
+}
+
 Value pointer_arithmetic(CompilerState *S, const Value *left, const Value *right, ArithmeticBinOp op) {
     if (op != GRAMINA_OP_ADD
      && op != GRAMINA_OP_SUB) {
@@ -100,7 +146,7 @@ Value pointer_arithmetic(CompilerState *S, const Value *left, const Value *right
 
         Value ret = {
             .llvm = n_elems,
-            .type = type_from_primitive(GRAMINA_PRIMITIVE_LONG),
+            .type = type_from_primitive(S, GRAMINA_PRIMITIVE_LONG),
             .class = GRAMINA_CLASS_RVALUE,
         };
 
@@ -149,6 +195,10 @@ Value arithmetic(CompilerState *S, const Value *lhs, const Value *rhs, Arithmeti
         return primitive_arithmetic(S, lhs, rhs, op);
     }
 
+    if (lhs->type.kind == GRAMINA_TYPE_VECTOR || rhs->type.kind == GRAMINA_TYPE_VECTOR) {
+        return vector_arithmetic(S, lhs, rhs, op);
+    }
+
     bool lhs_is_pointer_compatible = lhs->type.kind == GRAMINA_TYPE_POINTER;
     lhs_is_pointer_compatible |= lhs->type.kind == GRAMINA_TYPE_PRIMITIVE && primitive_is_integral(lhs->type.primitive);
 
@@ -159,7 +209,7 @@ Value arithmetic(CompilerState *S, const Value *lhs, const Value *rhs, Arithmeti
         Value loaded_left = try_load(S, lhs);
         Value loaded_right = try_load(S, rhs);
 
-        Value ret = pointer_arithmetic(S, lhs, rhs, op);
+        Value ret = pointer_arithmetic(S, &loaded_left, &loaded_right, op);
 
         value_free(&loaded_left);
         value_free(&loaded_right);
@@ -173,7 +223,11 @@ Value arithmetic(CompilerState *S, const Value *lhs, const Value *rhs, Arithmeti
 Value unary_arithmetic(CompilerState *S, const Value *_operand, ArithmeticUnOp op) {
     Value operand = try_load(S, _operand);
 
-    if (operand.type.kind == GRAMINA_TYPE_PRIMITIVE) {
+    if (operand.type.kind == GRAMINA_TYPE_PRIMITIVE || operand.type.kind == GRAMINA_TYPE_VECTOR) {
+        Primitive lane = operand.type.kind == GRAMINA_TYPE_VECTOR
+                       ? operand.type.element_type->primitive
+                       : operand.type.primitive;
+
         switch (op) {
         case GRAMINA_OP_IDENTITY: {
             Value ret = {
@@ -187,14 +241,14 @@ Value unary_arithmetic(CompilerState *S, const Value *_operand, ArithmeticUnOp o
             return ret;
         }
         case GRAMINA_OP_NEGATION: {
-            if (primitive_is_unsigned(operand.type.primitive)) {
+            if (primitive_is_unsigned(lane)) {
                 puts_err(S, str_cfmt("use of unary minus '-' on unsigned type"));
                 S->status = GRAMINA_COMPILE_ERR_INCOMPATIBLE_TYPE;
                 return invalid_value();
             }
 
             LLVMValueRef result;
-            if (primitive_is_integral(operand.type.primitive)) {
+            if (primitive_is_integral(lane)) {
                 result = LLVMBuildNeg(S->llvm_builder, operand.llvm, "");
             } else {
                 result = LLVMBuildFNeg(S->llvm_builder, operand.llvm, "");
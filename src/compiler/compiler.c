@@ -4,11 +4,11 @@
 #include <llvm-c/Error.h>
 #include <llvm-c/TargetMachine.h>
 #include <llvm-c/Types.h>
-#include <llvm-c/Transforms/PassBuilder.h>
 
 #include "common/log.h"
 
 #include "compiler/cstate.h"
+#include "compiler/session.h"
 #include "compiler/struct.h"
 #include "compiler/function.h"
 
@@ -25,8 +25,9 @@ int gramina_compiler_init() {
 
 static int init_state(CompilerState *S) {
     const char *module_name = "base"; // WIP
-    S->llvm_module = LLVMModuleCreateWithName(module_name);
-    S->llvm_builder = LLVMCreateBuilder();
+    S->llvm_module = LLVMModuleCreateWithNameInContext(module_name, S->llvm_context);
+    S->llvm_builder = LLVMCreateBuilderInContext(S->llvm_context);
+    S->llvm_alloca_builder = LLVMCreateBuilderInContext(S->llvm_context);
     S->llvm_target_data = LLVMCreateTargetDataLayout(S->llvm_target_machine);
 
     char *triple = LLVMGetDefaultTargetTriple(); // WIP
@@ -38,17 +39,21 @@ static int init_state(CompilerState *S) {
 
 static int deinit_state(CompilerState *S) {
     LLVMDisposeBuilder(S->llvm_builder);
+    LLVMDisposeBuilder(S->llvm_alloca_builder);
     LLVMDisposeTargetData(S->llvm_target_data);
 
     return 0;
 }
 
-CompileResult gramina_compile_for_machine(AstNode *root, LLVMTargetMachineRef tm) {
+static CompileResult compile_root(AstNode *root, LLVMTargetMachineRef tm, LLVMContextRef context, const CompileSession *session) {
     CompilerState S = {
         .has_error = false,
-        .scopes = mk_array(GraminaScope),
+        .symbols = mk_symbol_table(),
+        .types = mk_type_table(),
         .reflection = mk_array(_GraminaReflection),
+        .llvm_context = context,
         .llvm_target_machine = tm,
+        .session = session,
     };
 
     S.status = init_state(&S);
@@ -62,7 +67,7 @@ CompileResult gramina_compile_for_machine(AstNode *root, LLVMTargetMachineRef tm
         };
     }
 
-    array_append(GraminaScope, &S.scopes, mk_scope());
+    symbol_table_push(&S.symbols);
 
     S.status = 0;
     AstNode *cur = root;
@@ -81,11 +86,8 @@ CompileResult gramina_compile_for_machine(AstNode *root, LLVMTargetMachineRef tm
     } while ((cur = cur->right) && !S.status);
 
     if (S.status) {
-        array_foreach_ref(GraminaScope, _, s, S.scopes) {
-            scope_free(s);
-        }
-
-        array_free(GraminaScope, &S.scopes);
+        symbol_table_free(&S.symbols);
+        type_table_free(&S.types);
         array_free(_GraminaReflection, &S.reflection);
 
         deinit_state(&S);
@@ -97,9 +99,9 @@ CompileResult gramina_compile_for_machine(AstNode *root, LLVMTargetMachineRef tm
         };
     }
 
-    gramina_assert(S.scopes.length == 1, "got: %zu", S.scopes.length);
-    scope_free(array_last(GraminaScope, &S.scopes));
-    array_free(GraminaScope, &S.scopes);
+    gramina_assert(S.symbols.scopes.length == 1, "got: %zu", S.symbols.scopes.length);
+    symbol_table_free(&S.symbols);
+    type_table_free(&S.types);
     array_free(_GraminaReflection, &S.reflection);
 
     S.status = deinit_state(&S);
@@ -114,36 +116,52 @@ CompileResult gramina_compile_for_machine(AstNode *root, LLVMTargetMachineRef tm
         };
     }
 
-    /** This feature will be enabled after array related bugs are resolved 
-     *
-    LLVMPassBuilderOptionsRef opt = LLVMCreatePassBuilderOptions();
-    LLVMPassBuilderOptionsSetVerifyEach(opt, true);
-
-    LLVMErrorRef err;
-    if ((err = LLVMRunPasses(S.llvm_module, "default<O3>", S.llvm_target_machine, opt))) {
-        char *msg = LLVMGetErrorMessage(err);
+    return (CompileResult) {
+        .module = S.llvm_module,
+        .status = GRAMINA_COMPILE_ERR_NONE,
+    };
+}
 
-        String desc = str_cfmt("LLVMRunPasses: {cstr}\n", msg);
+/**
+ * The returned module belongs to `context`. Distinct contexts share no LLVM
+ * state, so separate translation units may be compiled on separate threads
+ * as long as each one brings its own context.
+ */
+CompileResult gramina_compile_in_context(AstNode *root, LLVMTargetMachineRef tm, LLVMContextRef context) {
+    return compile_root(root, tm, context, NULL);
+}
 
-        LLVMDisposeErrorMessage(msg);
-        LLVMDisposePassBuilderOptions(opt);
+/**
+ * Like `gramina_compile_in_context`, but unchanged functions are taken from
+ * the module `session` last produced. The session may move between contexts.
+ */
+CompileResult gramina_compile_in_session(CompileSession *session, AstNode *root, LLVMTargetMachineRef tm, LLVMContextRef context) {
+    session_prepare(session, root, tm);
+
+    CompileResult result = compile_root(root, tm, context, session);
+    if (result.status) {
+        session_abort(session);
+        return result;
+    }
 
+    if (session_commit(session, result.module, tm)) {
+        LLVMDisposeModule(result.module);
         return (CompileResult) {
             .status = GRAMINA_COMPILE_ERR_LLVM,
             .error = {
-                .description = desc,
+                .description = mk_str_c("LLVM encountered an error while reusing functions of the session"),
                 .pos = { 0, 0, 0 },
             },
         };
     }
 
-    LLVMDisposePassBuilderOptions(opt);
-    */
+    vlog_fmt("Compiled {sz} function(s), reused {sz}\n", session->n_compiled, session->n_reused);
 
-    return (CompileResult) {
-        .module = S.llvm_module,
-        .status = GRAMINA_COMPILE_ERR_NONE,
-    };
+    return result;
+}
+
+CompileResult gramina_compile_for_machine(AstNode *root, LLVMTargetMachineRef tm) {
+    return compile_in_context(root, tm, LLVMGetGlobalContext());
 }
 
 CompileResult gramina_compile(AstNode *root) {
@@ -3,26 +3,35 @@
 
 #define GRAMINA_NO_NAMESPACE
 
+#include "common/log.h"
+
 #include "compiler/conversions.h"
 #include "compiler/errors.h"
 #include "compiler/mem.h"
+#include "compiler/type.h"
 #include "compiler/typedecl.h"
 #include "compiler/value.h"
 
-Value primitive_convert(CompilerState *S, const Value *_from, const Type *to) {
-    Primitive p_from = _from->type.primitive;
+/**
+ * Converts every lane of `value` from `from` to `to`, scalars being a single
+ * lane. `into` is the LLVM type of the whole result.
+ */
+static LLVMValueRef convert_lanes(CompilerState *S, LLVMValueRef value, const Type *from, const Type *to, LLVMTypeRef into) {
+    Primitive p_from = from->primitive;
     Primitive p_to = to->primitive;
 
-    Value from = try_load(S, _from);
-
-    if (p_from == p_to) {
-        return from;
-    }
-
     LLVMOpcode cast;
 
     if (primitive_is_integral(p_from) && primitive_is_integral(p_to)) {
-        if (p_from > p_to) {
+        // Pointer sized integers may match any other width, so the order of primitives is not enough
+        unsigned from_width = LLVMGetIntTypeWidth(from->llvm);
+        unsigned to_width = LLVMGetIntTypeWidth(to->llvm);
+
+        if (from_width == to_width) {
+            return value;
+        }
+
+        if (from_width > to_width) {
             cast = LLVMTrunc;
         } else {
             cast = primitive_is_unsigned(p_from)
@@ -43,10 +52,18 @@ Value primitive_convert(CompilerState *S, const Value *_from, const Type *to) {
              : LLVMFPToSI;
     }
 
-    LLVMValueRef ref = LLVMBuildCast(S->llvm_builder, cast, from.llvm, to->llvm, "");
+    return LLVMBuildCast(S->llvm_builder, cast, value, into, "");
+}
+
+Value primitive_convert(CompilerState *S, const Value *_from, const Type *to) {
+    Value from = try_load(S, _from);
+
+    if (from.type.primitive == to->primitive) {
+        return from;
+    }
 
     Value ret = {
-        .llvm = ref,
+        .llvm = convert_lanes(S, from.llvm, &from.type, to, to->llvm),
         .type = type_dup(to),
         .class = from.class == GRAMINA_CLASS_CONSTEXPR
                ? GRAMINA_CLASS_CONSTEXPR
@@ -58,6 +75,60 @@ Value primitive_convert(CompilerState *S, const Value *_from, const Type *to) {
     return ret;
 }
 
+Value vector_convert(CompilerState *S, const Value *_from, const Type *to) {
+    if (_from->type.kind != GRAMINA_TYPE_VECTOR
+     || _from->type.length != to->length) {
+        err_explicit_conv(S, &_from->type, to);
+        return invalid_value();
+    }
+
+    Value from = try_load(S, _from);
+
+    LLVMValueRef result = from.type.element_type->primitive == to->element_type->primitive
+                        ? from.llvm
+                        : convert_lanes(S, from.llvm, from.type.element_type, to->element_type, to->llvm);
+
+    Value ret = {
+        .llvm = result,
+        .type = type_dup(to),
+        .class = from.class == GRAMINA_CLASS_CONSTEXPR
+               ? GRAMINA_CLASS_CONSTEXPR
+               : GRAMINA_CLASS_RVALUE
+    };
+
+    value_free(&from);
+
+    return ret;
+}
+
+Value splat(CompilerState *S, const Value *scalar, const Type *to) {
+    Value lane = primitive_convert(S, scalar, to->element_type);
+
+    LLVMTypeRef i32 = LLVMInt32TypeInContext(S->llvm_context);
+    LLVMValueRef poison = LLVMGetPoison(to->llvm);
+
+    LLVMValueRef first = LLVMBuildInsertElement(S->llvm_builder, poison, lane.llvm, LLVMConstInt(i32, 0, false), "");
+    LLVMValueRef result = LLVMBuildShuffleVector(
+        S->llvm_builder,
+        first,
+        poison,
+        LLVMConstNull(LLVMVectorType(i32, to->length)),
+        ""
+    );
+
+    Value ret = {
+        .llvm = result,
+        .type = type_dup(to),
+        .class = lane.class == GRAMINA_CLASS_CONSTEXPR
+               ? GRAMINA_CLASS_CONSTEXPR
+               : GRAMINA_CLASS_RVALUE
+    };
+
+    value_free(&lane);
+
+    return ret;
+}
+
 Value array_to_slice(CompilerState *S, const Value *from, const Type *slice_elem_type) {
     if (from->type.kind != GRAMINA_TYPE_ARRAY
      || !type_is_same(from->type.element_type, slice_elem_type)) {
@@ -65,7 +136,7 @@ Value array_to_slice(CompilerState *S, const Value *from, const Type *slice_elem
         return invalid_value();
     }
 
-    Type slice_type = mk_slice_type(slice_elem_type);
+    Type slice_type = mk_slice_type(S, slice_elem_type);
 
     LLVMValueRef slice_val = build_alloca(S, &slice_type, "tsl");
     LLVMValueRef ptr_val = LLVMBuildInBoundsGEP2(
@@ -73,8 +144,8 @@ Value array_to_slice(CompilerState *S, const Value *from, const Type *slice_elem
         slice_type.llvm,
         slice_val,
         (LLVMValueRef [2]) {
-            LLVMConstInt(LLVMInt32Type(), 0, false),
-            LLVMConstInt(LLVMInt32Type(), 0, false),
+            LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), 0, false),
+            LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), 0, false),
         }, 2, ""
     );
 
@@ -83,14 +154,14 @@ Value array_to_slice(CompilerState *S, const Value *from, const Type *slice_elem
         slice_type.llvm,
         slice_val,
         (LLVMValueRef [2]) {
-            LLVMConstInt(LLVMInt32Type(), 0, false),
-            LLVMConstInt(LLVMInt32Type(), 1, false),
+            LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), 0, false),
+            LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), 1, false),
         }, 2, ""
     );
 
-    Value length = mk_primitive_value(
-        GRAMINA_PRIMITIVE_UINT,
-        (PrimitiveInitialiser) { .u32 = from->type.length }
+    Value length = mk_primitive_value(S, 
+        GRAMINA_PRIMITIVE_USIZE,
+        (PrimitiveInitialiser) { .u64 = from->type.length }
     );
 
     store(S, &length, len_val);
@@ -101,8 +172,8 @@ Value array_to_slice(CompilerState *S, const Value *from, const Type *slice_elem
         from->type.llvm,
         from->llvm,
         (LLVMValueRef [2]) {
-            LLVMConstInt(LLVMInt32Type(), 0, false),
-            LLVMConstInt(LLVMInt32Type(), 0, false),
+            LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), 0, false),
+            LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), 0, false),
         }, 2, ""
     );
 
@@ -115,11 +186,31 @@ Value array_to_slice(CompilerState *S, const Value *from, const Type *slice_elem
     };
 }
 
+// Scalars are also checked against the lanes they are splatted across
+static void warn_narrowing(const Type *from, const Type *to) {
+    if (from->kind != GRAMINA_TYPE_PRIMITIVE) {
+        return;
+    }
+
+    const Type *target = to->kind == GRAMINA_TYPE_VECTOR
+                       ? to->element_type
+                       : to;
+
+    if (target->kind == GRAMINA_TYPE_PRIMITIVE && primitive_is_narrowing(from->primitive, target->primitive)) {
+        wlog_fmt(
+            "Compilation: implicitly narrowing '{so}' into '{so}'\n",
+            type_to_str(from), type_to_str(target)
+        );
+    }
+}
+
 bool convert_inplace(CompilerState *S, Value *value, const Type *to) {
     if (type_is_same(&value->type, to)) {
         return true;
     }
 
+    warn_narrowing(&value->type, to);
+
     if (value->type.kind == GRAMINA_TYPE_PRIMITIVE && to->kind == GRAMINA_TYPE_PRIMITIVE) {
         Value new_value = primitive_convert(S, value, to);
         value_free(value);
@@ -136,6 +227,14 @@ bool convert_inplace(CompilerState *S, Value *value, const Type *to) {
         return value_is_valid(value); 
     }
 
+    if (value->type.kind == GRAMINA_TYPE_PRIMITIVE && to->kind == GRAMINA_TYPE_VECTOR) {
+        Value new_value = splat(S, value, to);
+        value_free(value);
+
+        *value = new_value;
+        return true;
+    }
+
     value_free(value);
     *value = invalid_value();
     return false;
@@ -148,6 +247,8 @@ Value convert(CompilerState *S, const Value *from, const Type *to) {
         return v;
     }
 
+    warn_narrowing(&from->type, to);
+
     if (from->type.kind == GRAMINA_TYPE_PRIMITIVE && to->kind == GRAMINA_TYPE_PRIMITIVE) {
         return primitive_convert(S, from, to);
     }
@@ -156,6 +257,10 @@ Value convert(CompilerState *S, const Value *from, const Type *to) {
         return array_to_slice(S, from, to->slice_type);
     }
 
+    if (from->type.kind == GRAMINA_TYPE_PRIMITIVE && to->kind == GRAMINA_TYPE_VECTOR) {
+        return splat(S, from, to);
+    }
+
     return invalid_value();
 }
 
@@ -184,10 +289,42 @@ CoercionResult coerce_primitives(CompilerState *S, const Value *left, const Valu
     return coerced;
 }
 
+/**
+ * Brings a vector and a vector or scalar to the type of the vector, splatting
+ * the scalar. Returns an invalid type on error.
+ */
+Type coerce_vectors(CompilerState *S, const Value *left, const Value *right, Value *result_lhs, Value *result_rhs) {
+    const Type *vector = left->type.kind == GRAMINA_TYPE_VECTOR
+                       ? &left->type
+                       : &right->type;
+
+    if (!type_can_convert(S, &left->type, vector)
+     || !type_can_convert(S, &right->type, vector)) {
+        err_implicit_conv(S, &left->type, &right->type);
+
+        *result_lhs = invalid_value();
+        *result_rhs = invalid_value();
+
+        return (Type) {
+            .kind = GRAMINA_TYPE_INVALID,
+        };
+    }
+
+    Type ret = type_dup(vector);
+
+    *result_lhs = try_load(S, left);
+    *result_rhs = try_load(S, right);
+
+    convert_inplace(S, result_lhs, &ret);
+    convert_inplace(S, result_rhs, &ret);
+
+    return ret;
+}
+
 Value pointer_to_int(CompilerState *S, const Value *ptr) {
     Value from = try_load(S, ptr);
 
-    Type int_type = type_from_primitive(GRAMINA_PRIMITIVE_ULONG);
+    Type int_type = type_from_primitive(S, GRAMINA_PRIMITIVE_ULONG);
     LLVMValueRef result = LLVMBuildPtrToInt(S->llvm_builder, from.llvm, int_type.llvm, "");
 
     Value ret = {
@@ -217,6 +354,20 @@ Value cast(CompilerState *S, const Value *_from, const Type *to) {
         return ret;
     }
 
+    if (from.type.kind == GRAMINA_TYPE_PRIMITIVE && to->kind == GRAMINA_TYPE_VECTOR) {
+        Value ret = splat(S, &from, to);
+        value_free(&from);
+
+        return ret;
+    }
+
+    if (from.type.kind == GRAMINA_TYPE_VECTOR && to->kind == GRAMINA_TYPE_VECTOR) {
+        Value ret = vector_convert(S, &from, to);
+        value_free(&from);
+
+        return ret;
+    }
+
     if (from.type.kind == GRAMINA_TYPE_PRIMITIVE
      && to->kind == GRAMINA_TYPE_POINTER) {
         if (!primitive_is_integral(from.type.primitive)) {
@@ -124,7 +124,7 @@ void err_excess_args(CompilerState *S, size_t wants) {
 }
 
 void err_no_attrib_arg(CompilerState *S, const StringView *attrib_name) {
-    puts_err(S, str_cfmt("attribute '{sv}' needs an argument"));
+    puts_err(S, str_cfmt("attribute '{sv}' needs an argument", attrib_name));
     S->status = GRAMINA_COMPILE_ERR_MISSING_ATTRIB_ARG;
 }
 
@@ -142,3 +142,28 @@ void err_bad_type(CompilerState *S, const Type *type) {
     puts_err(S, str_cfmt("bad type '{so}'", type_to_str(type)));
     S->status = GRAMINA_COMPILE_ERR_INCOMPATIBLE_TYPE;
 }
+
+void err_cannot_iterate(CompilerState *S, const Type *type) {
+    puts_err(S, str_cfmt("cannot iterate over value of type '{so}'", type_to_str(type)));
+    S->status = GRAMINA_COMPILE_ERR_INCOMPATIBLE_TYPE;
+}
+
+void err_vector_lane(CompilerState *S, const Type *type) {
+    puts_err(S, str_cfmt("vector lanes must be of a primitive type, got '{so}'", type_to_str(type)));
+    S->status = GRAMINA_COMPILE_ERR_INCOMPATIBLE_TYPE;
+}
+
+void err_infer_vector(CompilerState *S, const StringView *builtin) {
+    puts_err(S, str_cfmt("cannot infer the vector type of '{sv}', it must be assigned or passed where one is expected", builtin));
+    S->status = GRAMINA_COMPILE_ERR_INCOMPATIBLE_TYPE;
+}
+
+void err_shuffle_index(CompilerState *S, size_t n_lanes) {
+    puts_err(S, str_cfmt("shuffle indices must be integer literals below {sz}", n_lanes));
+    S->status = GRAMINA_COMPILE_ERR_INCOMPATIBLE_TYPE;
+}
+
+void err_not_vector(CompilerState *S, const Type *type, const StringView *builtin) {
+    puts_err(S, str_cfmt("'{sv}' expects a vector, got '{so}'", builtin, type_to_str(type)));
+    S->status = GRAMINA_COMPILE_ERR_INCOMPATIBLE_TYPE;
+}
@@ -15,25 +15,26 @@
 #include "compiler/stackops.h"
 #include "compiler/struct.h"
 #include "compiler/type.h"
+#include "compiler/vector.h"
 
 static LLVMValueRef mk_llvm_string_literal(CompilerState *S, AstNode *this) {
     if (this->type != GRAMINA_AST_VAL_STRING) {
         return NULL;
     }
 
-    StringView contents = str_as_view(&this->value.string);
+    StringView contents = this->value.string;
 
-    LLVMTypeRef str_type = LLVMArrayType2(LLVMInt8Type(), contents.length + 1);
+    LLVMTypeRef str_type = LLVMArrayType2(LLVMInt8TypeInContext(S->llvm_context), contents.length + 1);
     LLVMValueRef string_val = LLVMAddGlobal(S->llvm_module, str_type, "");
-    LLVMSetInitializer(string_val, LLVMConstString(contents.data, contents.length, false));
+    LLVMSetInitializer(string_val, LLVMConstStringInContext(S->llvm_context, contents.data, contents.length, false));
     LLVMSetGlobalConstant(string_val, true);
     LLVMSetLinkage(string_val, LLVMLinkerPrivateLinkage);
     LLVMSetUnnamedAddress(string_val, LLVMGlobalUnnamedAddr);
     LLVMSetAlignment(string_val, 1);
 
     LLVMValueRef idx[] = {
-        LLVMConstInt(LLVMInt64Type(), 0, false),
-        LLVMConstInt(LLVMInt64Type(), 0, false),
+        LLVMConstInt(LLVMInt64TypeInContext(S->llvm_context), 0, false),
+        LLVMConstInt(LLVMInt64TypeInContext(S->llvm_context), 0, false),
     };
 
     return LLVMBuildInBoundsGEP2(S->llvm_builder, str_type, string_val, idx, 2, "");
@@ -42,10 +43,10 @@ static LLVMValueRef mk_llvm_string_literal(CompilerState *S, AstNode *this) {
 Value expression(CompilerState *S, LLVMValueRef function, AstNode *this) {
     switch (this->type) {
     case GRAMINA_AST_IDENTIFIER: {
-        StringView name = str_as_view(&this->value.identifier);
-        Identifier *ident = resolve(S, &name);
+        Identifier *ident = resolve(S, this->value.identifier);
 
         if (!ident) {
+            StringView name = symbol_view(this->value.identifier);
             err_undeclared_ident(S, &name);
             S->error.pos = this->pos;
             return invalid_value();
@@ -61,49 +62,49 @@ Value expression(CompilerState *S, LLVMValueRef function, AstNode *this) {
         return (Value) {
             .type = type_from_ast_node(S, this),
             .class = GRAMINA_CLASS_CONSTEXPR,
-            .llvm = LLVMConstInt(LLVMInt1Type(), this->value.logical, false),
+            .llvm = LLVMConstInt(LLVMInt1TypeInContext(S->llvm_context), this->value.logical, false),
         };
     case GRAMINA_AST_VAL_CHAR:
         return (Value) {
             .type = type_from_ast_node(S, this),
             .class = GRAMINA_CLASS_CONSTEXPR,
-            .llvm = LLVMConstInt(LLVMInt8Type(), this->value._char, false),
+            .llvm = LLVMConstInt(LLVMInt8TypeInContext(S->llvm_context), this->value._char, false),
         };
     case GRAMINA_AST_VAL_I32:
         return (Value) {
             .type = type_from_ast_node(S, this),
             .class = GRAMINA_CLASS_CONSTEXPR,
-            .llvm = LLVMConstInt(LLVMInt32Type(), this->value.i32, true),
+            .llvm = LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), this->value.i32, true),
         };
     case GRAMINA_AST_VAL_U32:
         return (Value) {
             .type = type_from_ast_node(S, this),
             .class = GRAMINA_CLASS_CONSTEXPR,
-            .llvm = LLVMConstInt(LLVMInt32Type(), this->value.u32, false),
+            .llvm = LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), this->value.u32, false),
         };
     case GRAMINA_AST_VAL_I64:
         return (Value) {
             .type = type_from_ast_node(S, this),
             .class = GRAMINA_CLASS_CONSTEXPR,
-            .llvm = LLVMConstInt(LLVMInt64Type(), this->value.i64, true),
+            .llvm = LLVMConstInt(LLVMInt64TypeInContext(S->llvm_context), this->value.i64, true),
         };
     case GRAMINA_AST_VAL_U64:
         return (Value) {
             .type = type_from_ast_node(S, this),
             .class = GRAMINA_CLASS_CONSTEXPR,
-            .llvm = LLVMConstInt(LLVMInt64Type(), this->value.u64, false),
+            .llvm = LLVMConstInt(LLVMInt64TypeInContext(S->llvm_context), this->value.u64, false),
         };
     case GRAMINA_AST_VAL_F32:
         return (Value) {
             .type = type_from_ast_node(S, this),
             .class = GRAMINA_CLASS_CONSTEXPR,
-            .llvm = LLVMConstReal(LLVMFloatType(), this->value.f32),
+            .llvm = LLVMConstReal(LLVMFloatTypeInContext(S->llvm_context), this->value.f32),
         };
     case GRAMINA_AST_VAL_F64:
         return (Value) {
             .type = type_from_ast_node(S, this),
             .class = GRAMINA_CLASS_CONSTEXPR,
-            .llvm = LLVMConstReal(LLVMDoubleType(), this->value.f64),
+            .llvm = LLVMConstReal(LLVMDoubleTypeInContext(S->llvm_context), this->value.f64),
         };
     case GRAMINA_AST_VAL_STRING:
         return (Value) {
@@ -300,7 +301,7 @@ Value binary_skipped_logic_expr(CompilerState *S, LLVMValueRef function, AstNode
         return ret;
     }
 
-    Type bool_type = type_from_primitive(GRAMINA_PRIMITIVE_BOOL);
+    Type bool_type = type_from_primitive(S, GRAMINA_PRIMITIVE_BOOL);
 
     Value lhs = expression(S, function, this->left);
 
@@ -313,8 +314,8 @@ Value binary_skipped_logic_expr(CompilerState *S, LLVMValueRef function, AstNode
         return invalid_value();
     }
 
-    LLVMBasicBlockRef split = LLVMAppendBasicBlock(function, "split");
-    LLVMBasicBlockRef merge = LLVMAppendBasicBlock(function, "lmerge");
+    LLVMBasicBlockRef split = LLVMAppendBasicBlockInContext(S->llvm_context, function, "split");
+    LLVMBasicBlockRef merge = LLVMAppendBasicBlockInContext(S->llvm_context, function, "lmerge");
     LLVMBasicBlockRef prev = LLVMGetPreviousBasicBlock(split);
 
     switch (get_op_from_ast_node(this)) {
@@ -345,16 +346,16 @@ Value binary_skipped_logic_expr(CompilerState *S, LLVMValueRef function, AstNode
     LLVMBuildBr(S->llvm_builder, merge);
     LLVMPositionBuilderAtEnd(S->llvm_builder, merge);
 
-    LLVMValueRef phi = LLVMBuildPhi(S->llvm_builder, LLVMInt1Type(), "");
+    LLVMValueRef phi = LLVMBuildPhi(S->llvm_builder, LLVMInt1TypeInContext(S->llvm_context), "");
 
     switch (get_op_from_ast_node(this)) {
     case GRAMINA_OP_L_OR: {
-        LLVMValueRef _true = LLVMConstInt(LLVMInt1Type(), 1, false);
+        LLVMValueRef _true = LLVMConstInt(LLVMInt1TypeInContext(S->llvm_context), 1, false);
         LLVMAddIncoming(phi, (LLVMValueRef [2]) { _true, rhs.llvm }, (LLVMBasicBlockRef [2]) { prev, split }, 2);
         break;
     }
     case GRAMINA_OP_L_AND: {
-        LLVMValueRef _false = LLVMConstInt(LLVMInt1Type(), 0, false);
+        LLVMValueRef _false = LLVMConstInt(LLVMInt1TypeInContext(S->llvm_context), 0, false);
         LLVMAddIncoming(phi, (LLVMValueRef [2]) { _false, rhs.llvm }, (LLVMBasicBlockRef [2]) { prev, split }, 2);
         break;
     }
@@ -373,6 +374,7 @@ Value binary_skipped_logic_expr(CompilerState *S, LLVMValueRef function, AstNode
 }
 
 bool collect_params(CompilerState *S, AstNode *this, AstNode **params, size_t n_params) {
+    AstNode *parent = this;
     AstNode *current = this->right;
     for (size_t i = 0; i < n_params; ++i) {
         if (!current) {
@@ -387,10 +389,11 @@ bool collect_params(CompilerState *S, AstNode *this, AstNode **params, size_t n_
             params[i] = current;
         }
 
+        parent = current;
         current = current->right;
     }
 
-    if (current && current->parent->type == GRAMINA_AST_EXPRESSION_LIST
+    if (current && parent->type == GRAMINA_AST_EXPRESSION_LIST
      || n_params == 0 && this->right != NULL) {
         err_excess_args(S, n_params);
         S->error.pos = this->pos;
@@ -449,11 +452,18 @@ bool convert_nodes_to_params(CompilerState *S, Identifier *func, Value *argument
 Value fn_call_expr(CompilerState *S, LLVMValueRef function, AstNode *this) {
     // TODO: operator overloading
 
-    StringView func_name = str_as_view(&this->left->value.identifier);
+    // Calls among the arguments must not take the destination meant for this one
+    LLVMValueRef destination = S->sret_destination;
+    S->sret_destination = NULL;
 
-    Identifier *func = resolve(S, &func_name);
+    Identifier *func = resolve(S, this->left->value.identifier);
+
+    if (!func && is_vector_builtin(this->left->value.identifier)) {
+        return vector_builtin_expr(S, function, this);
+    }
 
     if (!func) {
+        StringView func_name = symbol_view(this->left->value.identifier);
         err_undeclared_ident(S, &func_name);
         S->error.pos = this->left->pos;
         return invalid_value();
@@ -478,6 +488,7 @@ Value fn_call_expr(CompilerState *S, LLVMValueRef function, AstNode *this) {
         return invalid_value();
     }
 
+    S->sret_destination = destination;
     Value ret = call(S, func, arguments, n_params);
 
     for (size_t i = 0; i < n_params; ++i) {
@@ -489,8 +500,7 @@ Value fn_call_expr(CompilerState *S, LLVMValueRef function, AstNode *this) {
 
 Value member_expr(CompilerState *S, LLVMValueRef function, AstNode *this) {
     Value lhs = expression(S, function, this->left);
-    StringView rhs = str_as_view(&this->right->value.identifier);
-    Value ret = member(S, &lhs, &rhs);
+    Value ret = member(S, &lhs, this->right->value.identifier);
 
     value_free(&lhs);
 
@@ -518,7 +528,7 @@ Value subscript_expr(CompilerState *S, LLVMValueRef function, AstNode *this) {
 
 Value get_property_expr(CompilerState *S, LLVMValueRef function, AstNode *this) {
     Value lhs = expression(S, function, this->left);
-    StringView rhs = str_as_view(&this->right->value.identifier);
+    StringView rhs = symbol_view(this->right->value.identifier);
 
     Value ret = get_property(S, &lhs, &rhs);
 
@@ -540,7 +550,7 @@ Value size_of_expr(CompilerState *S, LLVMValueRef function, AstNode *this) {
     }
 
     size_t sz = size_of(S, &typ);
-    Value ret = mk_primitive_value(GRAMINA_PRIMITIVE_ULONG, (PrimitiveInitialiser) { .u64 = sz });
+    Value ret = mk_primitive_value(S, GRAMINA_PRIMITIVE_USIZE, (PrimitiveInitialiser) { .u64 = sz });
 
     type_free(&typ);
     return ret;
@@ -555,7 +565,7 @@ Value align_of_expr(CompilerState *S, LLVMValueRef function, AstNode *this) {
     }
 
     size_t sz = align_of(S, &typ);
-    Value ret = mk_primitive_value(GRAMINA_PRIMITIVE_ULONG, (PrimitiveInitialiser) { .u64 = sz });
+    Value ret = mk_primitive_value(S, GRAMINA_PRIMITIVE_USIZE, (PrimitiveInitialiser) { .u64 = sz });
 
     type_free(&typ);
     return ret;
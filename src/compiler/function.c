@@ -2,18 +2,24 @@
 #include <llvm-c/Types.h>
 #define GRAMINA_NO_NAMESPACE
 
+#include <string.h>
+
 #include "common/log.h"
 
 #include "compiler/errors.h"
 #include "compiler/function.h"
 #include "compiler/mem.h"
+#include "compiler/session.h"
 #include "compiler/stackops.h"
 #include "compiler/statement.h"
 
 #include "parser/attributes.h"
 
-GRAMINA_DECLARE_ARRAY(String, static);
-GRAMINA_IMPLEMENT_ARRAY(String, static);
+// Kept on `#extern` functions, so code outside gramina can still find their definitions after LTO
+#define EXTERN_MARKER "gramina-extern"
+
+GRAMINA_DECLARE_ARRAY(Symbol, static);
+GRAMINA_IMPLEMENT_ARRAY(Symbol, static);
 
 Value call(CompilerState *S, const Identifier *func, const Value *args, size_t n_params) {
     bool is_sret = kind_is_aggregate(func->type.return_type->kind);
@@ -21,9 +27,15 @@ Value call(CompilerState *S, const Identifier *func, const Value *args, size_t n
     // In all cases, `llvm_args[0]` is reserved for sret
     LLVMValueRef llvm_args[n_params + 1];
 
-    llvm_args[0] = is_sret
-                 ? build_alloca(S, func->type.return_type, "")
-                 : NULL;
+    llvm_args[0] = NULL;
+    if (is_sret) {
+        // Set by the statement this call initialises, only ever for a fresh slot of the exact type
+        llvm_args[0] = S->sret_destination
+                     ? S->sret_destination
+                     : build_alloca(S, func->type.return_type, "");
+    }
+
+    S->sret_destination = NULL;
 
     for (size_t i = 1; i < n_params + 1; ++i) {
         if (args[i - 1].class == GRAMINA_CLASS_ALLOCA) {
@@ -55,8 +67,8 @@ Value call(CompilerState *S, const Identifier *func, const Value *args, size_t n
     return ret;
 }
 
-static Array(String) collect_param_names(AstNode *this) {
-    Array(String) names = mk_array(String);
+static Array(Symbol) collect_param_names(AstNode *this) {
+    Array(Symbol) names = mk_array(Symbol);
 
     if (!this) {
         return names;
@@ -64,11 +76,11 @@ static Array(String) collect_param_names(AstNode *this) {
 
     AstNode *cur = this;
     do {
-        if (cur->type == GRAMINA_AST_PARAM_LIST) {
-            array_append(String, &names, str_dup(&cur->left->value.identifier));
-        } else {
-            array_append(String, &names, str_dup(&cur->value.identifier));
-        }
+        Symbol name = cur->type == GRAMINA_AST_PARAM_LIST
+                    ? cur->left->value.identifier
+                    : cur->value.identifier;
+
+        array_append(Symbol, &names, name);
     } while ((cur = cur->right));
 
     return names;
@@ -85,28 +97,196 @@ static bool check_tail_return(AstNode *this) {
     return false;
 }
 
-static void register_params(CompilerState *S, LLVMValueRef func, const Type *fn_type, bool sret, AstNode *this) {
-    Array(String) param_names = collect_param_names(this->left->left);
+// Whether memory other than the value itself can be reached through it
+static bool type_is_plain(const Type *type) {
+    switch (type->kind) {
+    case GRAMINA_TYPE_PRIMITIVE:
+        return true;
+    case GRAMINA_TYPE_STRUCT:
+        hashmap_foreach(StructField, _, field, type->fields) {
+            if (!type_is_plain(&field->type)) {
+                return false;
+            }
+        }
+
+        return true;
+    default:
+        // Arrays are included since they silently turn into slices
+        return false;
+    }
+}
+
+static const AstNode *access_root(const AstNode *this) {
+    while (this->type == GRAMINA_AST_OP_MEMBER
+        || this->type == GRAMINA_AST_OP_SUBSCRIPT
+        || this->type == GRAMINA_AST_OP_PROPERTY) {
+        this = this->left;
+    }
+
+    return this;
+}
+
+// Shadowing is ignored, a local with the same name only makes this more conservative
+static bool is_mutated(const AstNode *this, Symbol name) {
+    for (; this; this = this->right) {
+        switch (this->type) {
+        case GRAMINA_AST_OP_ASSIGN:
+        case GRAMINA_AST_OP_ASSIGN_ADD:
+        case GRAMINA_AST_OP_ASSIGN_SUB:
+        case GRAMINA_AST_OP_ASSIGN_MUL:
+        case GRAMINA_AST_OP_ASSIGN_DIV:
+        case GRAMINA_AST_OP_ASSIGN_REM:
+        case GRAMINA_AST_OP_ASSIGN_CAT:
+        case GRAMINA_AST_OP_ADDRESS_OF: {
+            const AstNode *root = access_root(this->left);
+            if (root->type == GRAMINA_AST_IDENTIFIER && root->value.identifier == name) {
+                return true;
+            }
+
+            break;
+        }
+        default:
+            break;
+        }
+
+        if (is_mutated(this->left, name)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static const AstNode *first_return(const AstNode *this) {
+    for (; this; this = this->right) {
+        if (this->type == GRAMINA_AST_RETURN_STATEMENT) {
+            return this;
+        }
+
+        const AstNode *found = first_return(this->left);
+        if (found) {
+            return found;
+        }
+    }
+
+    return NULL;
+}
+
+static bool only_returns(const AstNode *this, Symbol name) {
+    for (; this; this = this->right) {
+        if (this->type == GRAMINA_AST_RETURN_STATEMENT
+         && (!this->left
+          || this->left->type != GRAMINA_AST_IDENTIFIER
+          || this->left->value.identifier != name)) {
+            return false;
+        }
+
+        if (!only_returns(this->left, name)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static size_t count_declarations(const AstNode *this, Symbol name) {
+    size_t count = 0;
+    for (; this; this = this->right) {
+        if (this->type == GRAMINA_AST_DECLARATION_STATEMENT
+         && this->left->value.identifier == name) {
+            ++count;
+        }
+
+        count += count_declarations(this->left, name);
+    }
+
+    return count;
+}
+
+/**
+ * The local every return statement of `body` names, so it can be built in
+ * the sret slot and returned without a copy. It has to be declared exactly
+ * once, otherwise the returns could refer to different variables.
+ */
+static Symbol find_named_return(const Array(Symbol) *param_names, const AstNode *body) {
+    const AstNode *ret = first_return(body);
+    if (!ret || !ret->left || ret->left->type != GRAMINA_AST_IDENTIFIER) {
+        return GRAMINA_SYMBOL_EMPTY;
+    }
+
+    Symbol name = ret->left->value.identifier;
+
+    array_foreach(Symbol, _, param_name, *param_names) {
+        if (param_name == name) {
+            return GRAMINA_SYMBOL_EMPTY;
+        }
+    }
+
+    if (!only_returns(body, name) || count_declarations(body, name) != 1) {
+        return GRAMINA_SYMBOL_EMPTY;
+    }
+
+    return name;
+}
+
+/**
+ * Aggregate parameters the body never assigns to or takes the address of are
+ * read straight from the caller's memory instead of a `byval` copy. That is
+ * only sound while nothing else can write that memory during the call, so
+ * every parameter has to be plain data: there are no globals, hence without
+ * pointers the callee has no way of reaching the caller's memory.
+ *
+ * The parameter is not marked `noalias` though, `#extern` functions are free
+ * to keep pointers lawn code handed them and write through them later.
+ */
+static bool is_readonly_param(const Type *fn_type, const Type *type, Symbol name, const AstNode *body) {
+    if (type->kind != GRAMINA_TYPE_STRUCT) {
+        return false;
+    }
+
+    array_foreach_ref(_GraminaType, _, param_type, fn_type->param_types) {
+        if (!type_is_plain(param_type)) {
+            return false;
+        }
+    }
 
-    Scope *self_scope = CURRENT_SCOPE(S);
+    return !is_mutated(body, name);
+}
+
+static void add_param_attribute(CompilerState *S, LLVMValueRef func, size_t index, const char *name) {
+    LLVMAttributeRef attr = LLVMCreateEnumAttribute(
+        S->llvm_context,
+        LLVMGetEnumAttributeKindForName(name, strlen(name)),
+        0
+    );
+
+    LLVMAddAttributeAtIndex(func, index, attr);
+}
+
+static void register_params(CompilerState *S, LLVMValueRef func, const Type *fn_type, bool sret, AstNode *this) {
+    Array(Symbol) param_names = collect_param_names(this->left->left);
 
     array_foreach_ref(_GraminaType, i, type, fn_type->param_types) {
         LLVMValueRef temp = LLVMGetParam(func, i + sret);
 
-        String *param_name = &param_names.items[i];
+        Symbol param_name = param_names.items[i];
 
         LLVMValueRef llvm_param;
         if (!kind_is_aggregate(type->kind)) {
-            char *cparam_name = str_to_cstr(param_name);
-
-            LLVMValueRef allocated = build_alloca(S, type, cparam_name);
-            gramina_free(cparam_name);
+            LLVMValueRef allocated = build_alloca(S, type, symbol_cstr(param_name));
 
             LLVMBuildStore(S->llvm_builder, temp, allocated);
             llvm_param = allocated;
+        } else if (is_readonly_param(fn_type, type, param_name, this->right)) {
+            size_t index = i + sret + 1; // 1 indexed
+
+            add_param_attribute(S, func, index, "readonly");
+            add_param_attribute(S, func, index, "nocapture");
+
+            llvm_param = temp;
         } else {
             LLVMAttributeRef byval_attr = LLVMCreateTypeAttribute(
-                LLVMGetGlobalContext(),
+                S->llvm_context,
                 LLVMGetEnumAttributeKindForName("byval", 5),
                 type->llvm
             );
@@ -123,12 +303,10 @@ static void register_params(CompilerState *S, LLVMValueRef func, const Type *fn_
             .kind = GRAMINA_IDENT_KIND_VAR,
         };
 
-        hashmap_set(&self_scope->identifiers, str_as_view(param_name), param);
-
-        str_free(param_name);
+        symbol_table_bind(&S->symbols, param_name, param);
     }
 
-    array_free(String, &param_names);
+    array_free(Symbol, &param_names);
 }
 
 static bool validate_attributes(CompilerState *S, const Array(_GraminaSymAttr) *attribs, TokenPosition pos) {
@@ -155,9 +333,9 @@ void function_def(CompilerState *S, AstNode *this) {
     Type fn_type = type_from_ast_node(S, this->left);
     bool sret = kind_is_aggregate(fn_type.return_type->kind);
 
-    StringView name = str_as_view(&this->value.identifier);
+    StringView name = symbol_view(this->value.identifier);
 
-    if (hashmap_get(&CURRENT_SCOPE(S)->identifiers, name)) {
+    if (resolve_local(S, this->value.identifier)) {
         err_redeclaration(S, &name);
         S->error.pos = this->left->pos;
         type_free(&fn_type);
@@ -175,9 +353,19 @@ void function_def(CompilerState *S, AstNode *this) {
     LLVMValueRef func = LLVMAddFunction(S->llvm_module, cname, fn_type.llvm);
     gramina_free(cname);
 
+    if (extern_attrib) {
+        LLVMAttributeRef extern_marker = LLVMCreateStringAttribute(
+            S->llvm_context,
+            EXTERN_MARKER, strlen(EXTERN_MARKER),
+            "", 0
+        );
+
+        LLVMAddAttributeAtIndex(func, LLVMAttributeFunctionIndex, extern_marker);
+    }
+
     if (sret) {
         LLVMAttributeRef sret_attr = LLVMCreateTypeAttribute(
-            LLVMGetGlobalContext(),
+            S->llvm_context,
             LLVMGetEnumAttributeKindForName("sret", 4),
             fn_type.return_type->llvm
         );
@@ -186,7 +374,7 @@ void function_def(CompilerState *S, AstNode *this) {
     }
 
     LLVMAttributeRef align_attr = LLVMCreateEnumAttribute(
-        LLVMGetGlobalContext(),
+        S->llvm_context,
         LLVMGetEnumAttributeKindForName("alignstack", 10),
         16
     );
@@ -198,15 +386,21 @@ void function_def(CompilerState *S, AstNode *this) {
         .kind = GRAMINA_IDENT_KIND_FUNC,
         .type = fn_type,
         .llvm = func,
-        .attributes = this->value.attributes,
+        .attributes = mk_array(_GraminaSymAttr),
     };
 
-    this->value.attributes = mk_array(_GraminaSymAttr); // We are essentially moving the array
+    // The AST is arena-owned, so the identifier gets its own copy
+    if (this->value.attributes) {
+        array_foreach_ref(_GraminaSymAttr, _, attrib, *this->value.attributes) {
+            array_append(_GraminaSymAttr, &fn_ident->attributes, symattr_dup(attrib));
+        }
+    }
 
-    validate_attributes(S, &this->value.attributes, this->pos);
+    this->value.attributes = NULL;
 
-    Scope *parent_scope = CURRENT_SCOPE(S);
-    hashmap_set(&parent_scope->identifiers, name, fn_ident);
+    validate_attributes(S, &fn_ident->attributes, this->pos);
+
+    symbol_table_bind(&S->symbols, this->value.identifier, fn_ident);
 
     vlog_fmt("Registering function '{sv}'\n", &name);
 
@@ -214,21 +408,39 @@ void function_def(CompilerState *S, AstNode *this) {
         return;
     }
 
+    if (S->session && session_reuses(S->session, this->value.identifier)) {
+        vlog_fmt("Reusing the previous body of '{sv}'\n", &name);
+        return;
+    }
+
     bool has_tail_return = check_tail_return(this);
 
     push_reflection(S, fn_type.return_type);
 
-    LLVMBasicBlockRef alloc = LLVMAppendBasicBlock(func, "alloc");
-    LLVMBasicBlockRef body = LLVMAppendBasicBlock(func, "entry");
+    LLVMBasicBlockRef alloc = LLVMAppendBasicBlockInContext(S->llvm_context, func, "alloc");
+    LLVMBasicBlockRef body = LLVMAppendBasicBlockInContext(S->llvm_context, func, "entry");
     LLVMPositionBuilderAtEnd(S->llvm_builder, body);
+    LLVMPositionBuilderAtEnd(S->llvm_alloca_builder, alloc);
 
     push_scope(S);
 
     register_params(S, func, &fn_type, sret, this);
 
+    if (sret) {
+        Array(Symbol) param_names = collect_param_names(this->left->left);
+
+        S->nrvo_local = find_named_return(&param_names, this->right);
+        S->nrvo_type = fn_type.return_type;
+
+        array_free(Symbol, &param_names);
+    }
+
     block(S, func, this->right);
     pop_scope(S);
 
+    S->nrvo_local = GRAMINA_SYMBOL_EMPTY;
+    S->nrvo_type = NULL;
+
     if (!has_tail_return) {
         if (fn_type.return_type->kind == GRAMINA_TYPE_VOID) {
             LLVMBuildRetVoid(S->llvm_builder);
@@ -238,8 +450,42 @@ void function_def(CompilerState *S, AstNode *this) {
         }
     }
 
-    LLVMPositionBuilderAtEnd(S->llvm_builder, alloc);
-    LLVMBuildBr(S->llvm_builder, body);
+    LLVMBuildBr(S->llvm_alloca_builder, body);
+    LLVMClearInsertionPosition(S->llvm_alloca_builder);
 
     pop_reflection(S);
 }
+
+// Turns `func` into a declaration, every use the body made is dropped before its blocks go
+void function_strip_body(LLVMValueRef func) {
+    for (LLVMBasicBlockRef bb = LLVMGetFirstBasicBlock(func); bb; bb = LLVMGetNextBasicBlock(bb)) {
+        for (LLVMValueRef inst = LLVMGetFirstInstruction(bb); inst; inst = LLVMGetNextInstruction(inst)) {
+            LLVMTypeRef type = LLVMTypeOf(inst);
+            if (LLVMGetTypeKind(type) != LLVMVoidTypeKind) {
+                LLVMReplaceAllUsesWith(inst, LLVMGetPoison(type));
+            }
+        }
+    }
+
+    for (LLVMBasicBlockRef bb = LLVMGetFirstBasicBlock(func); bb; bb = LLVMGetNextBasicBlock(bb)) {
+        LLVMValueRef terminator = LLVMGetBasicBlockTerminator(bb);
+        if (terminator) {
+            LLVMInstructionEraseFromParent(terminator);
+        }
+    }
+
+    LLVMBasicBlockRef bb;
+    while ((bb = LLVMGetFirstBasicBlock(func))) {
+        LLVMDeleteBasicBlock(bb);
+    }
+
+    LLVMSetLinkage(func, LLVMExternalLinkage);
+}
+
+bool function_is_extern(LLVMValueRef func) {
+    return LLVMGetStringAttributeAtIndex(
+        func,
+        LLVMAttributeFunctionIndex,
+        EXTERN_MARKER, strlen(EXTERN_MARKER)
+    ) != NULL;
+}
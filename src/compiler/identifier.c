@@ -10,27 +10,15 @@
 
 GRAMINA_IMPLEMENT_ARRAY(GraminaIdentifier)
 
-Identifier *gramina_scope_resolve(const Scope *this, const StringView *ident_name) {
-    return hashmap_get(&this->identifiers, *ident_name);
+Identifier *gramina_resolve(const CompilerState *S, Symbol ident_name) {
+    return symbol_table_get(&S->symbols, ident_name);
 }
 
-Identifier *gramina_resolve(const CompilerState *S, const StringView *ident_name) {
-    if (S->scopes.length == 0) {
-        return NULL;
-    }
-
-    for (int32_t i = S->scopes.length - 1; i >= 0; --i) {
-        Identifier *candidate = scope_resolve(&S->scopes.items[i], ident_name);
-
-        if (candidate) {
-            return candidate;
-        }
-    }
-
-    return NULL;
+// Only looks at the innermost scope
+Identifier *gramina_resolve_local(const CompilerState *S, Symbol ident_name) {
+    return symbol_table_get_local(&S->symbols, ident_name);
 }
 
-
 void gramina_identifier_free(Identifier *this) {
     type_free(&this->type);
     this->type = (Type) {
@@ -6,17 +6,10 @@
 #include "compiler/mem.h"
 #include "compiler/op.h"
 
-Value primitive_comparison(CompilerState *S, const Value *left, const Value *right, ComparisonOp operation) {
-    Value lhs;
-    Value rhs;
-
-    CoercionResult coerced = coerce_primitives(S, left, right, &lhs, &rhs);
-    if (!value_is_valid(&lhs) || !value_is_valid(&rhs) || coerced.greater_type.kind == GRAMINA_TYPE_INVALID) {
-        return invalid_value();
-    }
-
-    bool signedness = !primitive_is_unsigned(coerced.greater_type.primitive);
-    bool integral = primitive_is_integral(coerced.greater_type.primitive);
+// Vectors are compared lane by lane with the predicates of their lanes
+static LLVMValueRef build_comparison(CompilerState *S, Primitive lane, ComparisonOp operation, LLVMValueRef lhs, LLVMValueRef rhs) {
+    bool signedness = !primitive_is_unsigned(lane);
+    bool integral = primitive_is_integral(lane);
 
     LLVMValueRef result;
 
@@ -53,7 +46,7 @@ Value primitive_comparison(CompilerState *S, const Value *left, const Value *rig
             break;
         }
 
-        result = LLVMBuildICmp(S->llvm_builder, op, lhs.llvm, rhs.llvm, "");
+        result = LLVMBuildICmp(S->llvm_builder, op, lhs, rhs, "");
     } else {
         LLVMRealPredicate op;
         switch (operation) {
@@ -79,12 +72,24 @@ Value primitive_comparison(CompilerState *S, const Value *left, const Value *rig
             break;
         }
 
-        result = LLVMBuildFCmp(S->llvm_builder, op, lhs.llvm, rhs.llvm, "");
+        result = LLVMBuildFCmp(S->llvm_builder, op, lhs, rhs, "");
+    }
+
+    return result;
+}
+
+Value primitive_comparison(CompilerState *S, const Value *left, const Value *right, ComparisonOp operation) {
+    Value lhs;
+    Value rhs;
+
+    CoercionResult coerced = coerce_primitives(S, left, right, &lhs, &rhs);
+    if (!value_is_valid(&lhs) || !value_is_valid(&rhs) || coerced.greater_type.kind == GRAMINA_TYPE_INVALID) {
+        return invalid_value();
     }
 
     Value ret = {
-        .type = type_from_primitive(GRAMINA_PRIMITIVE_BOOL),
-        .llvm = result,
+        .type = type_from_primitive(S, GRAMINA_PRIMITIVE_BOOL),
+        .llvm = build_comparison(S, coerced.greater_type.primitive, operation, lhs.llvm, rhs.llvm),
         .class = GRAMINA_CLASS_RVALUE,
     };
 
@@ -96,6 +101,33 @@ Value primitive_comparison(CompilerState *S, const Value *left, const Value *rig
     return ret;
 }
 
+// Yields a mask of `bool` lanes
+Value vector_comparison(CompilerState *S, const Value *left, const Value *right, ComparisonOp operation) {
+    Value lhs;
+    Value rhs;
+
+    Type vector = coerce_vectors(S, left, right, &lhs, &rhs);
+    if (vector.kind == GRAMINA_TYPE_INVALID) {
+        return invalid_value();
+    }
+
+    Type bool_type = type_from_primitive(S, GRAMINA_PRIMITIVE_BOOL);
+
+    Value ret = {
+        .type = mk_vector_type(S, &bool_type, vector.length),
+        .llvm = build_comparison(S, vector.element_type->primitive, operation, lhs.llvm, rhs.llvm),
+        .class = GRAMINA_CLASS_RVALUE,
+    };
+
+    value_free(&lhs);
+    value_free(&rhs);
+
+    type_free(&bool_type);
+    type_free(&vector);
+
+    return ret;
+}
+
 Value comparison(CompilerState *S, const Value *lhs, const Value *rhs, ComparisonOp operation) {
     if (lhs->type.kind == GRAMINA_TYPE_PRIMITIVE && rhs->type.kind == GRAMINA_TYPE_PRIMITIVE) {
         Value left = try_load(S, lhs);
@@ -109,6 +141,10 @@ Value comparison(CompilerState *S, const Value *lhs, const Value *rhs, Compariso
         return ret;
     }
 
+    if (lhs->type.kind == GRAMINA_TYPE_VECTOR || rhs->type.kind == GRAMINA_TYPE_VECTOR) {
+        return vector_comparison(S, lhs, rhs, operation);
+    }
+
     if (lhs->type.kind == GRAMINA_TYPE_POINTER && rhs->type.kind == GRAMINA_TYPE_POINTER) {
         if (!type_is_same(lhs->type.pointer_type, rhs->type.pointer_type)) {
             StringView op_str = get_comparison_op(operation);
@@ -147,7 +183,7 @@ Value comparison(CompilerState *S, const Value *lhs, const Value *rhs, Compariso
         LLVMValueRef result = LLVMBuildICmp(S->llvm_builder, op, left.llvm, right.llvm, "");
         Value ret = {
             .llvm = result,
-            .type = type_from_primitive(GRAMINA_PRIMITIVE_BOOL),
+            .type = type_from_primitive(S, GRAMINA_PRIMITIVE_BOOL),
             .class = GRAMINA_CLASS_RVALUE,
         };
 
@@ -164,7 +200,7 @@ Value binary_logic(CompilerState *S, const Value *_lhs, const Value *_rhs, Logic
     Value lhs = try_load(S, _lhs);
     Value rhs = try_load(S, _rhs);
 
-    Type bool_type = type_from_primitive(GRAMINA_PRIMITIVE_BOOL);
+    Type bool_type = type_from_primitive(S, GRAMINA_PRIMITIVE_BOOL);
 
     if (!type_can_convert(S, &lhs.type, &bool_type)) {
         err_implicit_conv(S, &lhs.type, &bool_type);
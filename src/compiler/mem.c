@@ -83,7 +83,7 @@ Value address_of(CompilerState *S, const Value *operand) {
     case GRAMINA_CLASS_ALLOCA: {
         Value ret = {
             .class = GRAMINA_CLASS_RVALUE,
-            .type = mk_pointer_type(&operand->type),
+            .type = mk_pointer_type(S, &operand->type),
             .llvm = operand->llvm,
         };
 
@@ -92,7 +92,7 @@ Value address_of(CompilerState *S, const Value *operand) {
     case GRAMINA_CLASS_LVALUE: {
         Value ret = {
             .class = GRAMINA_CLASS_RVALUE,
-            .type = mk_pointer_type(&operand->type),
+            .type = mk_pointer_type(S, &operand->type),
             .llvm = operand->lvalue_ptr,
         };
 
@@ -214,28 +214,15 @@ Value assign(CompilerState *S, Value *target, const Value *from, AssignOp op) {
     return ret;
 }
 
+// All allocas of a function are grouped in its "alloc" block, which only
+// branches to the body once the whole function has been emitted
 LLVMValueRef build_alloca(CompilerState *S, const Type *type, const char *name) {
-    LLVMBasicBlockRef current_block = LLVMGetInsertBlock(S->llvm_builder);
-    LLVMBasicBlockRef first_block = current_block;
-    while (true) {
-        LLVMBasicBlockRef above = LLVMGetPreviousBasicBlock(first_block);
-        if (!above) {
-            break;
-        }
-
-        first_block = above;
-    }
-
-    LLVMPositionBuilderAtEnd(S->llvm_builder, first_block);
-
-    LLVMValueRef ret = LLVMBuildAlloca(S->llvm_builder, type->llvm, name);
+    LLVMValueRef ret = LLVMBuildAlloca(S->llvm_alloca_builder, type->llvm, name);
 
     if (type->kind == GRAMINA_TYPE_ARRAY) {
         LLVMSetAlignment(ret, 16);
     }
 
-    LLVMPositionBuilderAtEnd(S->llvm_builder, current_block);
-
     return ret;
 }
 
@@ -1,30 +1,121 @@
 #define GRAMINA_NO_NAMESPACE
 
+#include <string.h>
+
 #include "compiler/identifier.h"
 #include "compiler/scope.h"
 #include "compiler/type.h"
 
-#define GRAMINA_SCOPE_BUCKETS 128
-
 GRAMINA_IMPLEMENT_ARRAY(GraminaScope)
+GRAMINA_IMPLEMENT_ARRAY(GraminaBinding)
 
-static void free_identifier(void *ident_ptr) {
-    Identifier *ident = ident_ptr;
-
+static void free_identifier(Identifier *ident) {
     identifier_free(ident);
     gramina_free(ident);
 }
 
-Scope gramina_mk_scope() {
-    Scope this = {};
+static void reserve_symbol(SymbolTable *this, Symbol name) {
+    if (name < this->n_innermost) {
+        return;
+    }
+
+    size_t n = this->n_innermost == 0
+             ? 64
+             : this->n_innermost * 2;
 
-    this.identifiers = mk_hashmap(128);
-    this.identifiers.object_freer = free_identifier;
+    while (n <= name) {
+        n *= 2;
+    }
 
-    return this;
+    this->innermost = gramina_realloc(this->innermost, n * sizeof *this->innermost);
+    memset(this->innermost + this->n_innermost, 0, (n - this->n_innermost) * sizeof *this->innermost);
+    this->n_innermost = n;
 }
 
-void gramina_scope_free(Scope *this) {
-    hashmap_free(&this->identifiers);
+SymbolTable gramina_mk_symbol_table() {
+    return (SymbolTable) {
+        .scopes = mk_array(GraminaScope),
+        .bindings = mk_array(GraminaBinding),
+        .innermost = NULL,
+        .n_innermost = 0,
+    };
 }
 
+void gramina_symbol_table_push(SymbolTable *this) {
+    array_append(GraminaScope, &this->scopes, ((Scope) {
+        .first_binding = this->bindings.length,
+    }));
+}
+
+void gramina_symbol_table_pop(SymbolTable *this) {
+    Scope *scope = array_last(GraminaScope, &this->scopes);
+
+    while (this->bindings.length > scope->first_binding) {
+        Binding *binding = array_last(GraminaBinding, &this->bindings);
+
+        this->innermost[binding->name] = binding->shadowed;
+        free_identifier(binding->identifier);
+
+        array_pop(GraminaBinding, &this->bindings);
+    }
+
+    array_pop(GraminaScope, &this->scopes);
+}
+
+// Binding a name twice in the same scope replaces the previous identifier
+void gramina_symbol_table_bind(SymbolTable *this, Symbol name, Identifier *ident) {
+    gramina_assert(this->scopes.length != 0, "binding outside of any scope\n");
+
+    reserve_symbol(this, name);
+
+    uint32_t visible = this->innermost[name];
+    if (visible > array_last(GraminaScope, &this->scopes)->first_binding) {
+        Binding *binding = &this->bindings.items[visible - 1];
+
+        free_identifier(binding->identifier);
+        binding->identifier = ident;
+        return;
+    }
+
+    array_append(GraminaBinding, &this->bindings, ((Binding) {
+        .name = name,
+        .shadowed = visible,
+        .identifier = ident,
+    }));
+
+    this->innermost[name] = this->bindings.length;
+}
+
+Identifier *gramina_symbol_table_get(const SymbolTable *this, Symbol name) {
+    if (name >= this->n_innermost || this->innermost[name] == 0) {
+        return NULL;
+    }
+
+    return this->bindings.items[this->innermost[name] - 1].identifier;
+}
+
+Identifier *gramina_symbol_table_get_local(const SymbolTable *this, Symbol name) {
+    if (name >= this->n_innermost || this->scopes.length == 0) {
+        return NULL;
+    }
+
+    uint32_t visible = this->innermost[name];
+    if (visible <= array_last(GraminaScope, &this->scopes)->first_binding) {
+        return NULL;
+    }
+
+    return this->bindings.items[visible - 1].identifier;
+}
+
+void gramina_symbol_table_free(SymbolTable *this) {
+    while (this->scopes.length != 0) {
+        symbol_table_pop(this);
+    }
+
+    array_free(GraminaScope, &this->scopes);
+    array_free(GraminaBinding, &this->bindings);
+    gramina_free(this->innermost);
+
+    this->innermost = NULL;
+    this->n_innermost = 0;
+}
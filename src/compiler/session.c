@@ -0,0 +1,363 @@
+#define GRAMINA_NO_NAMESPACE
+
+#include <string.h>
+
+#include <llvm-c/BitReader.h>
+#include <llvm-c/BitWriter.h>
+#include <llvm-c/Core.h>
+#include <llvm-c/Linker.h>
+#include <llvm-c/Transforms/PassBuilder.h>
+
+#include "common/log.h"
+
+#include "compiler/function.h"
+#include "compiler/session.h"
+
+typedef struct {
+    Symbol name;
+    const AstNode *node;
+    uint64_t interface; // What users of the definition depend on, see `interface_of`
+} Definition;
+
+GRAMINA_DECLARE_ARRAY(Definition, static);
+GRAMINA_IMPLEMENT_ARRAY(Definition, static);
+
+typedef struct {
+    Array(Definition) defs;
+    Hashmap by_name; // Symbol -> index + 1 into `defs`
+    bool *visited;
+} Definitions;
+
+static uint64_t mix(uint64_t hash, uint64_t value) {
+    hash ^= value;
+    hash *= 0x100000001b3;
+    return hash ^ (hash >> 29);
+}
+
+static uint64_t mix_bytes(uint64_t hash, const void *data, size_t length) {
+    const uint8_t *bytes = data;
+
+    hash = mix(hash, length);
+    for (size_t i = 0; i < length; ++i) {
+        hash = mix(hash, bytes[i]);
+    }
+
+    return hash;
+}
+
+static uint64_t hash_value(uint64_t hash, const AstNode *this) {
+    switch (this->type) {
+    case GRAMINA_AST_VAL_CHAR:
+        return mix(hash, this->value._char);
+    case GRAMINA_AST_VAL_STRING:
+        return mix_bytes(hash, this->value.string.data, this->value.string.length);
+    case GRAMINA_AST_VAL_F32:
+        return mix_bytes(hash, &this->value.f32, sizeof this->value.f32);
+    case GRAMINA_AST_VAL_F64:
+        return mix_bytes(hash, &this->value.f64, sizeof this->value.f64);
+    case GRAMINA_AST_VAL_I32:
+    case GRAMINA_AST_VAL_U32:
+        return mix(hash, this->value.u32);
+    case GRAMINA_AST_VAL_I64:
+    case GRAMINA_AST_VAL_U64:
+        return mix(hash, this->value.u64);
+    case GRAMINA_AST_VAL_BOOL:
+        return mix(hash, this->value.logical);
+    case GRAMINA_AST_TYPE_ARRAY:
+    case GRAMINA_AST_TYPE_VECTOR:
+        return mix(hash, this->value.array_length);
+    case GRAMINA_AST_IDENTIFIER:
+    case GRAMINA_AST_FUNCTION_DEF:
+    case GRAMINA_AST_FUNCTION_DECLARATION:
+    case GRAMINA_AST_STRUCT_DEF:
+        hash = mix(hash, this->value.identifier);
+        if (!this->value.attributes) {
+            return hash;
+        }
+
+        array_foreach_ref(_GraminaSymAttr, _, attrib, *this->value.attributes) {
+            hash = mix(hash, attrib->kind);
+            hash = mix_bytes(hash, attrib->string.data, attrib->string.length);
+        }
+
+        return hash;
+    default:
+        return hash;
+    }
+}
+
+// Positions are left out so that moving a definition around doesn't change it
+static uint64_t hash_node(uint64_t hash, const AstNode *this) {
+    // Statements are chained through `right`, which would make recursion as deep as the function is long
+    for (; this; this = this->right) {
+        hash = mix(hash, this->type);
+        hash = mix(hash, this->flags);
+        hash = hash_value(hash, this);
+        hash = hash_node(hash, this->left);
+    }
+
+    return mix(hash, GRAMINA_AST_INVALID);
+}
+
+// The part of a definition other definitions can see
+static const AstNode *interface_node(const Definition *def) {
+    return def->node->type == GRAMINA_AST_STRUCT_DEF
+         ? def->node
+         : def->node->left;
+}
+
+static uint64_t interface_of(const Definition *def) {
+    const AstNode *node = def->node;
+    if (node->type == GRAMINA_AST_STRUCT_DEF) {
+        return hash_node(0, node);
+    }
+
+    uint64_t hash = mix(0, node->type);
+    hash = hash_value(hash, node);
+
+    return hash_node(hash, node->left);
+}
+
+/**
+ * Mixes in the interface of every definition `this` reaches through the
+ * identifiers in it, transitively through the interfaces themselves. Each
+ * definition is visited once, which also keeps self-referencing structs from
+ * looping.
+ */
+static uint64_t hash_references(uint64_t hash, Definitions *D, const AstNode *this) {
+    for (; this; this = this->right) {
+        if (this->type == GRAMINA_AST_IDENTIFIER) {
+            size_t index = (size_t)hashmap_get_sym(&D->by_name, this->value.identifier);
+            if (index != 0 && !D->visited[index - 1]) {
+                const Definition *def = D->defs.items + index - 1;
+                D->visited[index - 1] = true;
+
+                hash = mix(hash, def->interface);
+                hash = hash_references(hash, D, interface_node(def));
+            }
+        }
+
+        hash = hash_references(hash, D, this->left);
+    }
+
+    return hash;
+}
+
+static Definitions collect_definitions(const AstNode *root) {
+    Definitions D = {
+        .defs = mk_array(Definition),
+        .by_name = mk_hashmap(16),
+    };
+
+    for (const AstNode *cur = root; cur; cur = cur->right) {
+        const AstNode *node = cur->left;
+
+        Definition def = { .node = node };
+        switch (node->type) {
+        case GRAMINA_AST_FUNCTION_DEF:
+        case GRAMINA_AST_FUNCTION_DECLARATION:
+            def.name = node->value.identifier;
+            break;
+        case GRAMINA_AST_STRUCT_DEF:
+            def.name = node->left->value.identifier;
+            break;
+        default:
+            continue;
+        }
+
+        def.interface = interface_of(&def);
+
+        array_append(Definition, &D.defs, def);
+        hashmap_set_sym(&D.by_name, def.name, (void *)D.defs.length);
+    }
+
+    D.visited = gramina_malloc(D.defs.length * sizeof *D.visited + 1);
+
+    return D;
+}
+
+static void definitions_free(Definitions *this) {
+    array_free(Definition, &this->defs);
+    hashmap_free(&this->by_name);
+    gramina_free(this->visited);
+}
+
+static Symbol cname_of(const AstNode *this) {
+    SymbolAttribute *extern_attrib = ast_node_get_symattr(this, GRAMINA_ATTRIBUTE_EXTERN);
+    if (!extern_attrib) {
+        return this->value.identifier;
+    }
+
+    StringView cname = str_as_view(&extern_attrib->string);
+    return intern(&cname);
+}
+
+// Mixed into every fingerprint, the data layout decides sizes and alignments
+static uint64_t target_seed(LLVMTargetMachineRef tm) {
+    char *triple = LLVMGetTargetMachineTriple(tm);
+    LLVMTargetDataRef data = LLVMCreateTargetDataLayout(tm);
+    char *layout = LLVMCopyStringRepOfTargetData(data);
+
+    uint64_t seed = mix_bytes(0xcbf29ce484222325, triple, strlen(triple));
+    seed = mix_bytes(seed, layout, strlen(layout));
+
+    LLVMDisposeMessage(layout);
+    LLVMDisposeTargetData(data);
+    LLVMDisposeMessage(triple);
+
+    return seed;
+}
+
+CompileSession mk_compile_session() {
+    CompileSession this = {
+        .previous = NULL,
+        .fingerprints = mk_hashmap(0),
+        .pending = mk_hashmap(0),
+    };
+
+    this.fingerprints.object_freer = gramina_free;
+    this.pending.object_freer = gramina_free;
+
+    return this;
+}
+
+void compile_session_free(CompileSession *this) {
+    if (this->previous) {
+        LLVMDisposeMemoryBuffer(this->previous);
+    }
+
+    hashmap_free(&this->fingerprints);
+    hashmap_free(&this->pending);
+}
+
+void session_prepare(CompileSession *this, const AstNode *root, LLVMTargetMachineRef tm) {
+    uint64_t seed = target_seed(tm);
+
+    this->n_reused = 0;
+    this->n_compiled = 0;
+
+    hashmap_free(&this->pending);
+    this->pending = mk_hashmap(0);
+    this->pending.object_freer = gramina_free;
+
+    Definitions D = collect_definitions(root);
+
+    array_foreach_ref(Definition, _, def, D.defs) {
+        if (def->node->type != GRAMINA_AST_FUNCTION_DEF) {
+            continue;
+        }
+
+        memset(D.visited, 0, D.defs.length * sizeof *D.visited);
+
+        uint64_t hash = hash_node(seed, def->node);
+        hash = hash_references(hash, &D, def->node);
+
+        Fingerprint *old = hashmap_get_sym(&this->fingerprints, def->name);
+
+        Fingerprint *fp = gramina_malloc(sizeof *fp);
+        *fp = (Fingerprint) {
+            .hash = hash,
+            .cname = cname_of(def->node),
+            .reuse = this->previous && old && old->hash == hash,
+        };
+
+        if (fp->reuse) {
+            ++this->n_reused;
+        } else {
+            ++this->n_compiled;
+        }
+
+        hashmap_set_sym(&this->pending, def->name, fp);
+    }
+
+    definitions_free(&D);
+}
+
+bool session_reuses(const CompileSession *this, Symbol name) {
+    Fingerprint *fp = hashmap_get_sym(&this->pending, name);
+    return fp && fp->reuse;
+}
+
+static LLVMModuleRef load_reused(CompileSession *this, LLVMContextRef context, LLVMTargetMachineRef tm) {
+    LLVMModuleRef mod;
+    if (LLVMParseBitcodeInContext2(context, this->previous, &mod)) {
+        elog_fmt("Failed to load the previous module of the session\n");
+        return NULL;
+    }
+
+    Hashmap reused = mk_hashmap(this->n_reused);
+    hashmap_foreach(Fingerprint, _, fp, this->pending) {
+        if (fp->reuse) {
+            hashmap_set_sym(&reused, fp->cname, fp);
+        }
+    }
+
+    for (LLVMValueRef fn = LLVMGetFirstFunction(mod); fn; fn = LLVMGetNextFunction(fn)) {
+        if (LLVMIsDeclaration(fn)) {
+            continue;
+        }
+
+        size_t length;
+        const char *name = LLVMGetValueName2(fn, &length);
+        StringView name_view = mk_sv_buf((const uint8_t *)name, length);
+
+        if (!hashmap_get_sym(&reused, intern(&name_view))) {
+            function_strip_body(fn);
+        }
+    }
+
+    hashmap_free(&reused);
+
+    // Drops the constants and declarations only the stripped bodies used
+    LLVMPassBuilderOptionsRef opt = LLVMCreatePassBuilderOptions();
+    LLVMErrorRef pass_err = LLVMRunPasses(mod, "globaldce", tm, opt);
+    LLVMDisposePassBuilderOptions(opt);
+
+    if (pass_err) {
+        char *msg = LLVMGetErrorMessage(pass_err);
+        elog_fmt("LLVMRunPasses: {cstr}\n", msg);
+        LLVMDisposeErrorMessage(msg);
+
+        LLVMDisposeModule(mod);
+        return NULL;
+    }
+
+    return mod;
+}
+
+bool session_commit(CompileSession *this, LLVMModuleRef module, LLVMTargetMachineRef tm) {
+    if (this->n_reused != 0) {
+        LLVMModuleRef reused = load_reused(this, LLVMGetModuleContext(module), tm);
+        if (!reused) {
+            session_abort(this);
+            return true;
+        }
+
+        // Always consumes `reused`
+        if (LLVMLinkModules2(module, reused)) {
+            elog_fmt("Failed to link the reused functions\n");
+            session_abort(this);
+            return true;
+        }
+    }
+
+    if (this->previous) {
+        LLVMDisposeMemoryBuffer(this->previous);
+    }
+
+    this->previous = LLVMWriteBitcodeToMemoryBuffer(module);
+
+    hashmap_free(&this->fingerprints);
+    this->fingerprints = this->pending;
+
+    this->pending = mk_hashmap(0);
+    this->pending.object_freer = gramina_free;
+
+    return false;
+}
+
+void session_abort(CompileSession *this) {
+    hashmap_free(&this->pending);
+    this->pending = mk_hashmap(0);
+    this->pending.object_freer = gramina_free;
+}
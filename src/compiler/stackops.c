@@ -3,14 +3,12 @@
 #include "compiler/stackops.h"
 #include "compiler/type.h"
 
-Scope *push_scope(CompilerState *S) {
-    array_append(GraminaScope, &S->scopes, mk_scope());
-    return array_last(GraminaScope, &S->scopes);
+void push_scope(CompilerState *S) {
+    symbol_table_push(&S->symbols);
 }
 
 void pop_scope(CompilerState *S) {
-    scope_free(array_last(GraminaScope, &S->scopes));
-    array_pop(GraminaScope, &S->scopes);
+    symbol_table_pop(&S->symbols);
 }
 
 void push_reflection(CompilerState *S, const Type *type) {
@@ -1,8 +1,10 @@
 #define GRAMINA_NO_NAMESPACE
 
 #include <llvm-c/Core.h>
+#include <llvm-c/DebugInfo.h>
 #include <llvm-c/Types.h>
 
+#include "compiler/access.h"
 #include "compiler/conversions.h"
 #include "compiler/errors.h"
 #include "compiler/expressions.h"
@@ -10,11 +12,40 @@
 #include "compiler/mem.h"
 #include "compiler/stackops.h"
 #include "compiler/statement.h"
+#include "compiler/type.h"
 
-Identifier *declaration(CompilerState *S, const StringView *name, const Type *type, const Value *init) {
-    Scope *scope = CURRENT_SCOPE(S);
-    if (hashmap_get(&scope->identifiers, *name)) {
-        err_redeclaration(S, name);
+// A local that is the function's named return value lives in the sret slot itself
+static LLVMValueRef local_storage(CompilerState *S, Symbol name, const Type *type) {
+    if (name == S->nrvo_local && type_is_same(type, S->nrvo_type)) {
+        LLVMValueRef function = LLVMGetBasicBlockParent(LLVMGetInsertBlock(S->llvm_builder));
+        return LLVMGetParam(function, 0);
+    }
+
+    return build_alloca(S, type, symbol_cstr(name));
+}
+
+// Whether `this` is a call whose result can be written straight to storage of type `type`
+static bool returns_into(CompilerState *S, const AstNode *this, const Type *type) {
+    if (this->type != GRAMINA_AST_OP_CALL || this->left->type != GRAMINA_AST_IDENTIFIER) {
+        return false;
+    }
+
+    Identifier *func = resolve(S, this->left->value.identifier);
+
+    return func
+        && func->kind == GRAMINA_IDENT_KIND_FUNC
+        && kind_is_aggregate(func->type.return_type->kind)
+        && type_is_same(func->type.return_type, type);
+}
+
+/**
+ * `storage` is where `init` already lives, in which case nothing is stored.
+ * Pass `NULL` to have the local allocated.
+ */
+Identifier *declaration(CompilerState *S, Symbol name, const Type *type, const Value *init, LLVMValueRef storage) {
+    if (resolve_local(S, name)) {
+        StringView name_view = symbol_view(name);
+        err_redeclaration(S, &name_view);
         return NULL;
     }
 
@@ -29,21 +60,21 @@ Identifier *declaration(CompilerState *S, const StringView *name, const Type *ty
         .type = type_dup(type),
     };
 
-    char *cname = sv_to_cstr(name);
-    ident->llvm = build_alloca(S, &ident->type, cname);
-    gramina_free(cname);
+    ident->llvm = storage
+                ? storage
+                : local_storage(S, name, &ident->type);
 
-    if (init) {
+    if (init && init->llvm != ident->llvm) {
         store(S, init, ident->llvm);
     }
 
-    hashmap_set(&scope->identifiers, *name, ident);
+    symbol_table_bind(&S->symbols, name, ident);
 
     return ident;
 }
 
 void declaration_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
-    StringView name = str_as_view(&this->left->value.identifier);
+    Symbol name = this->left->value.identifier;
 
     Type ident_type = type_from_ast_node(S, this->left->left);
     if (S->has_error) {
@@ -52,12 +83,24 @@ void declaration_statement(CompilerState *S, LLVMValueRef function, AstNode *thi
 
     bool initialised = this->left->right != NULL;
     Value value = {};
+    LLVMValueRef storage = NULL;
 
     if (initialised) {
+        /**
+         * The callee writes the local in place. In a loop the slot may be
+         * reachable from the arguments through the previous iteration, and
+         * the callee could then read what it already overwrote.
+         */
+        if (S->loop_depth == 0 && returns_into(S, this->left->right, &ident_type)) {
+            storage = local_storage(S, name, &ident_type);
+            S->sret_destination = storage;
+        }
+
         push_reflection(S, &ident_type);
         ++S->reflection_depth;
 
         value = expression(S, function, this->left->right);
+        S->sret_destination = NULL;
         try_load_inplace(S, &value);
 
         --S->reflection_depth;
@@ -79,7 +122,7 @@ void declaration_statement(CompilerState *S, LLVMValueRef function, AstNode *thi
         convert_inplace(S, &value, &ident_type);
     }
 
-    declaration(S, &name, &ident_type, initialised ? &value : NULL);
+    declaration(S, name, &ident_type, initialised ? &value : NULL, storage);
     if (S->has_error) {
         S->error.pos = this->pos;
     }
@@ -107,7 +150,18 @@ void return_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
         return;
     }
 
+    // Nothing else can point into the sret slot while a call still fills it
+    LLVMValueRef sret = NULL;
+    if (kind_is_aggregate(REFLECT(S, reflection_index)->type.kind)) {
+        sret = LLVMGetParam(function, 0);
+
+        if (returns_into(S, this->left, &REFLECT(S, reflection_index)->type)) {
+            S->sret_destination = sret;
+        }
+    }
+
     Value exp = expression(S, function, this->left);
+    S->sret_destination = NULL;
     if (S->has_error) {
         return;
     }
@@ -129,6 +183,15 @@ void return_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
     try_load_inplace(S, &exp);
     convert_inplace(S, &exp, ret_type);
 
+    // Already in place, either as the named return value or through the call it came from
+    if (exp.llvm == sret) {
+        LLVMBuildRetVoid(S->llvm_builder);
+
+        --S->reflection_depth;
+        value_free(&exp);
+        return;
+    }
+
     switch (ret_type->kind) {
     case GRAMINA_TYPE_STRUCT:
         LLVMBuildMemCpy(
@@ -169,7 +232,7 @@ void if_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
         return;
     }
 
-    Type bool_type = type_from_primitive(GRAMINA_PRIMITIVE_BOOL);
+    Type bool_type = type_from_primitive(S, GRAMINA_PRIMITIVE_BOOL);
     if (!type_can_convert(S, &condition.type, &bool_type)) {
         err_implicit_conv(S, &condition.type, &bool_type);
         S->error.pos = this->left->pos;
@@ -185,10 +248,10 @@ void if_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
     AstNode *else_clause = this->right->right;
     LLVMBasicBlockRef else_block = !else_clause
                                  ? NULL
-                                 : LLVMAppendBasicBlock(function, "else");
+                                 : LLVMAppendBasicBlockInContext(S->llvm_context, function, "else");
 
-    LLVMBasicBlockRef then_block = LLVMAppendBasicBlock(function, "then");
-    LLVMBasicBlockRef merge_block = LLVMAppendBasicBlock(function, "merge");
+    LLVMBasicBlockRef then_block = LLVMAppendBasicBlockInContext(S->llvm_context, function, "then");
+    LLVMBasicBlockRef merge_block = LLVMAppendBasicBlockInContext(S->llvm_context, function, "merge");
 
     if (else_clause) {
         LLVMBuildCondBr(S->llvm_builder, condition.llvm, then_block, else_block);
@@ -222,9 +285,9 @@ void if_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
 }
 
 void while_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
-    LLVMBasicBlockRef condition_block = LLVMAppendBasicBlock(function, "while_condition");
-    LLVMBasicBlockRef exit_block = LLVMAppendBasicBlock(function, "while_exit");
-    LLVMBasicBlockRef body_block = LLVMAppendBasicBlock(function, "while_body");
+    LLVMBasicBlockRef condition_block = LLVMAppendBasicBlockInContext(S->llvm_context, function, "while_condition");
+    LLVMBasicBlockRef exit_block = LLVMAppendBasicBlockInContext(S->llvm_context, function, "while_exit");
+    LLVMBasicBlockRef body_block = LLVMAppendBasicBlockInContext(S->llvm_context, function, "while_body");
 
     LLVMBuildBr(S->llvm_builder, condition_block);
     LLVMPositionBuilderAtEnd(S->llvm_builder, condition_block);
@@ -234,7 +297,7 @@ void while_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
         return;
     }
 
-    Type bool_type = type_from_primitive(GRAMINA_PRIMITIVE_BOOL);
+    Type bool_type = type_from_primitive(S, GRAMINA_PRIMITIVE_BOOL);
     if (!type_can_convert(S, &condition.type, &bool_type)) {
         err_implicit_conv(S, &condition.type, &bool_type);
         S->error.pos = this->left->pos;
@@ -251,12 +314,14 @@ void while_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
 
     LLVMPositionBuilderAtEnd(S->llvm_builder, body_block);
     push_scope(S);
+    ++S->loop_depth;
 
     bool body_terminated = block(S, function, this->right);
     if (!body_terminated) {
         LLVMBuildBr(S->llvm_builder, condition_block);
     }
 
+    --S->loop_depth;
     pop_scope(S);
 
     LLVMPositionBuilderAtEnd(S->llvm_builder, exit_block);
@@ -265,10 +330,10 @@ void while_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
 void for_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
     push_scope(S);
 
-    LLVMBasicBlockRef condition_block = LLVMAppendBasicBlock(function, "for_condition");
-    LLVMBasicBlockRef expression_block = LLVMAppendBasicBlock(function, "for_expression");
-    LLVMBasicBlockRef body_block = LLVMAppendBasicBlock(function, "for_body");
-    LLVMBasicBlockRef exit_block = LLVMAppendBasicBlock(function, "for_exit");
+    LLVMBasicBlockRef condition_block = LLVMAppendBasicBlockInContext(S->llvm_context, function, "for_condition");
+    LLVMBasicBlockRef expression_block = LLVMAppendBasicBlockInContext(S->llvm_context, function, "for_expression");
+    LLVMBasicBlockRef body_block = LLVMAppendBasicBlockInContext(S->llvm_context, function, "for_body");
+    LLVMBasicBlockRef exit_block = LLVMAppendBasicBlockInContext(S->llvm_context, function, "for_exit");
 
     declaration_statement(S, function, this->left->left);
 
@@ -277,7 +342,7 @@ void for_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
     LLVMPositionBuilderAtEnd(S->llvm_builder, condition_block);
     Value predicate = expression(S, function, this->left->right->left);
 
-    Type bool_type = type_from_primitive(GRAMINA_PRIMITIVE_BOOL);
+    Type bool_type = type_from_primitive(S, GRAMINA_PRIMITIVE_BOOL);
     if (!type_can_convert(S, &predicate.type, &bool_type)) {
         err_implicit_conv(S, &predicate.type, &bool_type);
         S->error.pos = this->left->right->left->pos;
@@ -293,11 +358,15 @@ void for_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
     LLVMBuildCondBr(S->llvm_builder, predicate.llvm, body_block, exit_block);
 
     LLVMPositionBuilderAtEnd(S->llvm_builder, body_block);
+    ++S->loop_depth;
+
     bool body_terminated = block(S, function, this->right);
     if (!body_terminated) {
         LLVMBuildBr(S->llvm_builder, expression_block);
     }
 
+    --S->loop_depth;
+
     LLVMPositionBuilderAtEnd(S->llvm_builder, expression_block);
     Value result = expression(S, function, this->left->right->right);
     LLVMBuildBr(S->llvm_builder, condition_block);
@@ -310,6 +379,152 @@ void for_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
     pop_scope(S);
 }
 
+/**
+ * Walks the elements with a pointer from the first one up to one past the
+ * last. The bounds are read once before the loop, so the body can neither
+ * cut the walk short nor make it check anything per element.
+ */
+void foreach_statement(CompilerState *S, LLVMValueRef function, AstNode *this) {
+    AstNode *ident_node = this->left->left;
+    Symbol name = ident_node->value.identifier;
+
+    Type ident_type = type_from_ast_node(S, ident_node->left);
+    if (S->has_error) {
+        return;
+    }
+
+    Value iterated = expression(S, function, ident_node->right);
+    if (S->has_error) {
+        type_free(&ident_type);
+        return;
+    }
+
+    try_load_inplace(S, &iterated);
+
+    Type *element_type;
+    LLVMValueRef begin, length;
+    switch (iterated.type.kind) {
+    case GRAMINA_TYPE_ARRAY:
+        element_type = iterated.type.element_type;
+        begin = iterated.llvm;
+        length = LLVMConstInt(LLVMIntPtrTypeInContext(S->llvm_context, S->llvm_target_data), iterated.type.length, false);
+        break;
+    case GRAMINA_TYPE_SLICE: {
+        element_type = iterated.type.slice_type;
+        if (element_type->kind == GRAMINA_TYPE_VOID) {
+            goto cannot_iterate;
+        }
+
+        StringView ptr_prop = mk_sv_c("ptr");
+        StringView length_prop = mk_sv_c("length");
+
+        Value ptr = get_property(S, &iterated, &ptr_prop);
+        Value len = get_property(S, &iterated, &length_prop);
+
+        begin = ptr.llvm;
+        length = len.llvm;
+
+        value_free(&ptr);
+        value_free(&len);
+        break;
+    }
+    default:
+    cannot_iterate:
+        err_cannot_iterate(S, &iterated.type);
+        S->error.pos = ident_node->right->pos;
+
+        value_free(&iterated);
+        type_free(&ident_type);
+        return;
+    }
+
+    // `T& x` refers to each element in place, anything else gets a copy
+    bool by_reference = ident_type.kind == GRAMINA_TYPE_POINTER
+                     && !type_can_convert(S, element_type, &ident_type);
+
+    Type cursor_type = mk_pointer_type(S, element_type);
+    const Type *bound_type = by_reference
+                           ? &cursor_type
+                           : element_type;
+
+    if (!type_can_convert(S, bound_type, &ident_type)) {
+        err_implicit_conv(S, bound_type, &ident_type);
+        S->error.pos = this->left->pos;
+
+        type_free(&cursor_type);
+        value_free(&iterated);
+        type_free(&ident_type);
+        return;
+    }
+
+    LLVMValueRef end = LLVMBuildInBoundsGEP2(S->llvm_builder, element_type->llvm, begin, &length, 1, "");
+    LLVMValueRef cursor = build_alloca(S, &cursor_type, "");
+    LLVMBuildStore(S->llvm_builder, begin, cursor);
+
+    LLVMBasicBlockRef condition_block = LLVMAppendBasicBlockInContext(S->llvm_context, function, "foreach_condition");
+    LLVMBasicBlockRef body_block = LLVMAppendBasicBlockInContext(S->llvm_context, function, "foreach_body");
+    LLVMBasicBlockRef step_block = LLVMAppendBasicBlockInContext(S->llvm_context, function, "foreach_step");
+    LLVMBasicBlockRef exit_block = LLVMAppendBasicBlockInContext(S->llvm_context, function, "foreach_exit");
+
+    LLVMBuildBr(S->llvm_builder, condition_block);
+    LLVMPositionBuilderAtEnd(S->llvm_builder, condition_block);
+
+    LLVMValueRef current = LLVMBuildLoad2(S->llvm_builder, cursor_type.llvm, cursor, "");
+    LLVMValueRef done = LLVMBuildICmp(S->llvm_builder, LLVMIntEQ, current, end, "");
+    LLVMBuildCondBr(S->llvm_builder, done, exit_block, body_block);
+
+    LLVMPositionBuilderAtEnd(S->llvm_builder, body_block);
+    push_scope(S);
+    ++S->loop_depth;
+
+    Value element = {
+        .llvm = current,
+        .class = by_reference
+               ? GRAMINA_CLASS_RVALUE
+               : GRAMINA_CLASS_ALLOCA,
+        .type = type_dup(bound_type),
+    };
+
+    try_load_inplace(S, &element);
+    convert_inplace(S, &element, &ident_type);
+
+    declaration(S, name, &ident_type, &element, NULL);
+    if (S->has_error) {
+        S->error.pos = this->left->pos;
+    }
+
+    value_free(&element);
+
+    bool body_terminated = block(S, function, this->right);
+    if (!body_terminated) {
+        LLVMBuildBr(S->llvm_builder, step_block);
+    }
+
+    --S->loop_depth;
+    pop_scope(S);
+
+    LLVMPositionBuilderAtEnd(S->llvm_builder, step_block);
+
+    LLVMValueRef next = LLVMBuildInBoundsGEP2(
+        S->llvm_builder,
+        element_type->llvm,
+        current,
+        (LLVMValueRef[1]) {
+            LLVMConstInt(LLVMIntPtrTypeInContext(S->llvm_context, S->llvm_target_data), 1, false),
+        }, 1, ""
+    );
+
+    LLVMBuildStore(S->llvm_builder, next, cursor);
+
+    LLVMBuildBr(S->llvm_builder, condition_block);
+
+    LLVMPositionBuilderAtEnd(S->llvm_builder, exit_block);
+
+    type_free(&cursor_type);
+    value_free(&iterated);
+    type_free(&ident_type);
+}
+
 bool block(CompilerState *S, LLVMValueRef function, AstNode *this) {
     if (!this) {
         return false;
@@ -345,6 +560,9 @@ bool block(CompilerState *S, LLVMValueRef function, AstNode *this) {
             case GRAMINA_AST_FOR_STATEMENT:
                 for_statement(S, function, cur->left);
                 break;
+            case GRAMINA_AST_FOREACH_STATEMENT:
+                foreach_statement(S, function, cur->left);
+                break;
             default:
                 break;
             }
@@ -5,7 +5,6 @@
 #include "compiler/errors.h"
 #include "compiler/identifier.h"
 #include "compiler/mem.h"
-#include "compiler/scope.h"
 #include "compiler/struct.h"
 
 void struct_def(CompilerState *S, AstNode *this) {
@@ -18,10 +17,9 @@ void struct_def(CompilerState *S, AstNode *this) {
         .kind = GRAMINA_IDENT_KIND_TYPE,
     };
 
-    StringView name = str_as_view(&ident->type.struct_name);
+    StringView name = symbol_view(ident->type.struct_name);
 
-    Scope *scope = CURRENT_SCOPE(S);
-    hashmap_set(&scope->identifiers, name, ident);
+    symbol_table_bind(&S->symbols, ident->type.struct_name, ident);
 
     vlog_fmt("Registering struct '{sv}'\n", &name);
 }
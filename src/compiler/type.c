@@ -6,6 +6,7 @@
 #include "common/str.h"
 #include "common/hashmap.h"
 
+#include "compiler/errors.h"
 #include "compiler/identifier.h"
 #include "compiler/type.h"
 #include "compiler/typedecl.h"
@@ -14,7 +15,8 @@
 
 GRAMINA_IMPLEMENT_ARRAY(_GraminaType);
 
-#define BUILTIN_PRIMITIVE(pr, _llvm) (Type) { .kind = GRAMINA_TYPE_PRIMITIVE, .primitive = GRAMINA_PRIMITIVE_ ## pr, .llvm = LLVM ## _llvm ## Type(), }
+#define BUILTIN_PRIMITIVE(pr, _llvm) (Type) { .kind = GRAMINA_TYPE_PRIMITIVE, .primitive = GRAMINA_PRIMITIVE_ ## pr, .llvm = LLVM ## _llvm ## TypeInContext(S->llvm_context), }
+#define POINTER_SIZED_PRIMITIVE(pr) (Type) { .kind = GRAMINA_TYPE_PRIMITIVE, .primitive = GRAMINA_PRIMITIVE_ ## pr, .llvm = LLVMIntPtrTypeInContext(S->llvm_context, S->llvm_target_data), }
 
 static void struct_field_free(void *_field) {
     StructField *field = _field;
@@ -22,11 +24,11 @@ static void struct_field_free(void *_field) {
     gramina_free(field);
 }
 
-static Type builtin_type(const StringView *i) {
+static Type builtin_type(const CompilerState *S, const StringView *i) {
     if (sv_cmp_c(i, "void") == 0) {
         return (Type) {
             .kind = GRAMINA_TYPE_VOID,
-            .llvm = LLVMVoidType(),
+            .llvm = LLVMVoidTypeInContext(S->llvm_context),
         };
     } else if (sv_cmp_c(i, "bool") == 0) {
         return BUILTIN_PRIMITIVE(BOOL, Int1);
@@ -42,6 +44,10 @@ static Type builtin_type(const StringView *i) {
         return BUILTIN_PRIMITIVE(INT, Int32);
     } else if (sv_cmp_c(i, "uint") == 0) {
         return BUILTIN_PRIMITIVE(UINT, Int32);
+    } else if (sv_cmp_c(i, "isize") == 0) {
+        return POINTER_SIZED_PRIMITIVE(ISIZE);
+    } else if (sv_cmp_c(i, "usize") == 0) {
+        return POINTER_SIZED_PRIMITIVE(USIZE);
     } else if (sv_cmp_c(i, "long") == 0) {
         return BUILTIN_PRIMITIVE(LONG, Int64);
     } else if (sv_cmp_c(i, "ulong") == 0) {
@@ -68,45 +74,123 @@ bool gramina_kind_is_aggregate(TypeKind k) {
     }
 }
 
-Type gramina_mk_pointer_type(const Type *pointed) {
+// Every field of a const struct is const as well
+static Type *const_struct(CompilerState *S, const Type *plain) {
+    Type shape = {
+        .kind = GRAMINA_TYPE_STRUCT,
+        .is_const = true,
+        .struct_name = plain->struct_name,
+        .llvm = plain->llvm,
+    };
+
+    Type *existing = type_table_find(&S->types, &shape);
+    if (existing) {
+        return existing;
+    }
+
+    shape.fields = mk_hashmap(hashmap_count(&plain->fields));
+    shape.fields.object_freer = plain->fields.object_freer;
+
+    hashmap_foreach(StructField, key, value, plain->fields) {
+        StructField *field = gramina_malloc(sizeof *field);
+        field->type = value->type;
+        field->type.is_const = true;
+        field->index = value->index;
+
+        hashmap_set_sym(&shape.fields, key, field);
+    }
+
+    return type_table_intern(&S->types, &shape);
+}
+
+/**
+ * Copies of canonical types share their fields and parameters with the
+ * table, so they can't be handed to it again. Only a variant with other
+ * constness can be missing, that one gets storage of its own.
+ */
+static Type *canonical(CompilerState *S, const Type *this) {
+    switch (this->kind) {
+    case GRAMINA_TYPE_STRUCT: {
+        Type *existing = type_table_find(&S->types, this);
+        if (existing) {
+            return existing;
+        }
+
+        Type plain = *this;
+        plain.is_const = false;
+
+        return const_struct(S, type_table_find(&S->types, &plain));
+    }
+    case GRAMINA_TYPE_FUNCTION: {
+        Type *existing = type_table_find(&S->types, this);
+        if (existing) {
+            return existing;
+        }
+
+        Type shape = *this;
+        shape.param_types = array_dup(_GraminaType, &this->param_types);
+
+        return type_table_intern(&S->types, &shape);
+    }
+    default: {
+        Type copy = *this;
+        return type_table_intern(&S->types, &copy);
+    }
+    }
+}
+
+Type gramina_mk_pointer_type(CompilerState *S, const Type *pointed) {
     Type typ = {
         .kind = GRAMINA_TYPE_POINTER,
     };
 
-    typ.pointer_type = gramina_malloc(sizeof *typ.pointer_type);
-    *typ.pointer_type = type_dup(pointed);
+    typ.pointer_type = canonical(S, pointed);
 
     typ.llvm = LLVMPointerType(typ.pointer_type->llvm, 0);
 
     return typ;
 }
 
-Type gramina_mk_array_type(const Type *element, size_t length) {
+Type gramina_mk_array_type(CompilerState *S, const Type *element, size_t length) {
     Type typ = {
         .kind = GRAMINA_TYPE_ARRAY,
         .length = length,
     };
 
-    typ.element_type = gramina_malloc(sizeof *typ.element_type);
-    *typ.element_type = type_dup(element);
+    typ.element_type = canonical(S, element);
 
     typ.llvm = LLVMArrayType2(element->llvm, length);
 
     return typ;
 }
 
-Type gramina_mk_slice_type(const Type *element) {
+// Lanes carry no constness of their own, only the vector as a whole does
+Type gramina_mk_vector_type(CompilerState *S, const Type *element, size_t length) {
+    Type typ = {
+        .kind = GRAMINA_TYPE_VECTOR,
+        .length = length,
+    };
+
+    Type lane = *element;
+    lane.is_const = false;
+    typ.element_type = canonical(S, &lane);
+
+    typ.llvm = LLVMVectorType(element->llvm, length);
+
+    return typ;
+}
+
+Type gramina_mk_slice_type(CompilerState *S, const Type *element) {
     Type typ = {
         .kind = GRAMINA_TYPE_SLICE,
     };
 
-    typ.slice_type = gramina_malloc(sizeof *typ.slice_type);
-    *typ.slice_type = type_dup(element);
+    typ.slice_type = canonical(S, element);
 
     LLVMTypeRef ptr = LLVMPointerType(typ.slice_type->llvm, 0);
-    LLVMTypeRef idx = type_from_primitive(GRAMINA_PRIMITIVE_UINT).llvm;
+    LLVMTypeRef idx = LLVMIntPtrTypeInContext(S->llvm_context, S->llvm_target_data);
 
-    typ.llvm = LLVMStructType((LLVMTypeRef [2]) { ptr, idx }, 2, false);
+    typ.llvm = LLVMStructTypeInContext(S->llvm_context, (LLVMTypeRef [2]) { ptr, idx }, 2, false);
 
     return typ;
 }
@@ -115,7 +199,7 @@ static Type _type_from_ast_node(CompilerState *S, const AstNode *this) {
     if (this == NULL) {
         return (Type) {
             .kind = GRAMINA_TYPE_VOID,
-            .llvm = LLVMVoidType(),
+            .llvm = LLVMVoidTypeInContext(S->llvm_context),
         };
     }
 
@@ -149,13 +233,13 @@ static Type _type_from_ast_node(CompilerState *S, const AstNode *this) {
         break;
     }
     case GRAMINA_AST_IDENTIFIER: {
-        StringView name = str_as_view(&this->value.identifier);
-        Type builtin = builtin_type(&name);
+        StringView name = symbol_view(this->value.identifier);
+        Type builtin = builtin_type(S, &name);
         if (builtin.kind != GRAMINA_TYPE_INVALID) {
             return builtin;
         }
 
-        Identifier *ident = resolve(S, &name);
+        Identifier *ident = resolve(S, this->value.identifier);
 
         if (!ident || ident->kind != GRAMINA_IDENT_KIND_TYPE) {
             return (Type) {
@@ -163,14 +247,11 @@ static Type _type_from_ast_node(CompilerState *S, const AstNode *this) {
             };
         }
 
-        Type ret = type_dup(&ident->type);
-        if ((this->flags & GRAMINA_AST_CONST_TYPE) && ret.kind == GRAMINA_TYPE_STRUCT) {
-            hashmap_foreach(StructField, _, field, ret.fields) {
-                field->type.is_const = true;
-            }
+        if ((this->flags & GRAMINA_AST_CONST_TYPE) && ident->type.kind == GRAMINA_TYPE_STRUCT) {
+            return *const_struct(S, &ident->type);
         }
 
-        return ret;
+        return ident->type;
     }
     case GRAMINA_AST_FUNCTION_TYPE: {
         Type typ = {
@@ -180,9 +261,7 @@ static Type _type_from_ast_node(CompilerState *S, const AstNode *this) {
         Type return_type = type_from_ast_node(S, this->right);
         bool sret = kind_is_aggregate(return_type.kind);
 
-        typ.return_type = gramina_malloc(sizeof *typ.return_type);
-        *typ.return_type = return_type;
-
+        typ.return_type = canonical(S, &return_type);
         typ.param_types = mk_array(_GraminaType);
 
         if (this->left) {
@@ -199,7 +278,8 @@ static Type _type_from_ast_node(CompilerState *S, const AstNode *this) {
 
         LLVMTypeRef params[typ.param_types.length + sret + 1];
         array_foreach_ref(_GraminaType, i, t, typ.param_types) {
-            LLVMTypeRef llvm_type = t->kind == GRAMINA_TYPE_STRUCT
+            // Aggregates are passed by address, see `register_params`
+            LLVMTypeRef llvm_type = kind_is_aggregate(t->kind)
                                   ? LLVMPointerType(t->llvm, 0)
                                   : t->llvm;
 
@@ -212,44 +292,37 @@ static Type _type_from_ast_node(CompilerState *S, const AstNode *this) {
         }
 
         LLVMTypeRef llvm_ret = sret
-                             ? LLVMVoidType()
+                             ? LLVMVoidTypeInContext(S->llvm_context)
                              : typ.return_type->llvm;
 
         typ.llvm = LLVMFunctionType(llvm_ret, params, typ.param_types.length + sret, false);
 
-        return typ;
+        return *type_table_intern(&S->types, &typ);
     }
     case GRAMINA_AST_TYPE_POINTER: {
-        Type typ = {
-            .kind = GRAMINA_TYPE_POINTER,
-        };
-
-        typ.pointer_type = gramina_malloc(sizeof *typ.pointer_type);
-        *typ.pointer_type = type_from_ast_node(S, this->left);
-
-        typ.llvm = LLVMPointerType(typ.pointer_type->llvm, 0);
-
-        return typ;
+        Type typ = type_from_ast_node(S, this->left);
+        return mk_pointer_type(S, &typ);
     }
     case GRAMINA_AST_TYPE_SLICE: {
         Type typ = type_from_ast_node(S, this->left);
-        Type ret = mk_slice_type(&typ);
-
-        type_free(&typ);
-        return ret;
+        return mk_slice_type(S, &typ);
     }
     case GRAMINA_AST_TYPE_ARRAY: {
-        Type typ = {
-            .kind = GRAMINA_TYPE_ARRAY,
-            .length = this->value.array_length,
-        };
-
-        typ.element_type = gramina_malloc(sizeof *typ.element_type);
-        *typ.element_type = type_from_ast_node(S, this->left);
+        Type typ = type_from_ast_node(S, this->left);
+        return mk_array_type(S, &typ, this->value.array_length);
+    }
+    case GRAMINA_AST_TYPE_VECTOR: {
+        Type typ = type_from_ast_node(S, this->left);
+        if (typ.kind == GRAMINA_TYPE_PRIMITIVE) {
+            return mk_vector_type(S, &typ, this->value.array_length);
+        }
 
-        typ.llvm = LLVMArrayType2(typ.element_type->llvm, typ.length);
+        if (!S->has_error) {
+            err_vector_lane(S, &typ);
+            S->error.pos = this->pos;
+        }
 
-        return typ;
+        break;
     }
     case GRAMINA_AST_STRUCT_DEF: {
         const AstNode *cur = this;
@@ -258,7 +331,7 @@ static Type _type_from_ast_node(CompilerState *S, const AstNode *this) {
             ++field_count;
         }
 
-        Hashmap fields = mk_hashmap(16);
+        Hashmap fields = mk_hashmap(field_count);
         LLVMTypeRef llvm_fields[field_count];
 
         fields.object_freer = struct_field_free;
@@ -266,7 +339,7 @@ static Type _type_from_ast_node(CompilerState *S, const AstNode *this) {
         cur = this;
         size_t index = 0;
         while ((cur = cur->right)) {
-            StringView field_name = str_as_view(&cur->left->value.identifier);
+            Symbol field_name = cur->left->value.identifier;
             StructField *field = gramina_malloc(sizeof *field);
 
             AstNode *type_node = cur->left->left;
@@ -287,50 +360,46 @@ static Type _type_from_ast_node(CompilerState *S, const AstNode *this) {
 
             llvm_fields[index++] = field->type.llvm;
 
-            hashmap_set(&fields, field_name, field);
+            hashmap_set_sym(&fields, field_name, field);
         }
 
-        char *cname = str_to_cstr(&this->left->value.identifier);
-        LLVMTypeRef type = LLVMStructCreateNamed(LLVMGetGlobalContext(), cname);
-        gramina_free(cname);
+        Symbol struct_name = this->left->value.identifier;
+        LLVMTypeRef type = LLVMStructCreateNamed(S->llvm_context, symbol_cstr(struct_name));
 
         LLVMStructSetBody(type, llvm_fields, field_count, false);
 
-        return (Type) {
+        return *type_table_intern(&S->types, &(Type) {
             .kind = GRAMINA_TYPE_STRUCT,
-            .struct_name = str_dup(&this->left->value.identifier),
+            .struct_name = struct_name,
             .fields = fields,
             .llvm = type,
-        };
+        });
     }
 
     case GRAMINA_AST_VAL_BOOL:
-        return type_from_primitive(GRAMINA_PRIMITIVE_BOOL);
+        return type_from_primitive(S, GRAMINA_PRIMITIVE_BOOL);
     case GRAMINA_AST_VAL_CHAR:
-        return type_from_primitive(GRAMINA_PRIMITIVE_BYTE);
+        return type_from_primitive(S, GRAMINA_PRIMITIVE_BYTE);
 
     case GRAMINA_AST_VAL_F32:
-        return type_from_primitive(GRAMINA_PRIMITIVE_FLOAT);
+        return type_from_primitive(S, GRAMINA_PRIMITIVE_FLOAT);
     case GRAMINA_AST_VAL_F64:
-        return type_from_primitive(GRAMINA_PRIMITIVE_DOUBLE);
+        return type_from_primitive(S, GRAMINA_PRIMITIVE_DOUBLE);
 
     case GRAMINA_AST_VAL_I32:
-        return type_from_primitive(GRAMINA_PRIMITIVE_INT);
+        return type_from_primitive(S, GRAMINA_PRIMITIVE_INT);
     case GRAMINA_AST_VAL_U32:
-        return type_from_primitive(GRAMINA_PRIMITIVE_UINT);
+        return type_from_primitive(S, GRAMINA_PRIMITIVE_UINT);
 
     case GRAMINA_AST_VAL_I64:
-        return type_from_primitive(GRAMINA_PRIMITIVE_LONG);
+        return type_from_primitive(S, GRAMINA_PRIMITIVE_LONG);
     case GRAMINA_AST_VAL_U64:
-        return type_from_primitive(GRAMINA_PRIMITIVE_ULONG);
+        return type_from_primitive(S, GRAMINA_PRIMITIVE_ULONG);
     case GRAMINA_AST_VAL_STRING: {
-        Type elem_type = type_from_primitive(GRAMINA_PRIMITIVE_BYTE);
+        Type elem_type = type_from_primitive(S, GRAMINA_PRIMITIVE_BYTE);
         elem_type.is_const = true;
 
-        Type ret = mk_array_type(&elem_type, this->value.string.length);
-
-        type_free(&elem_type);
-        return ret;
+        return mk_array_type(S, &elem_type, this->value.string.length);
     }
     default:
         break;
@@ -386,6 +455,12 @@ String gramina_type_to_str(const Type *this) {
         case GRAMINA_PRIMITIVE_UINT:
             s = mk_sv_c("uint");
             break;
+        case GRAMINA_PRIMITIVE_ISIZE:
+            s = mk_sv_c("isize");
+            break;
+        case GRAMINA_PRIMITIVE_USIZE:
+            s = mk_sv_c("usize");
+            break;
         case GRAMINA_PRIMITIVE_LONG:
             s = mk_sv_c("long");
             break;
@@ -417,8 +492,10 @@ String gramina_type_to_str(const Type *this) {
 
         return pointed;
     }
-    case GRAMINA_TYPE_STRUCT:
-        return str_dup(&this->struct_name);
+    case GRAMINA_TYPE_STRUCT: {
+        StringView name = symbol_view(this->struct_name);
+        return sv_dup(&name);
+    }
     case GRAMINA_TYPE_SLICE: {
         String subtype = type_to_str(this->slice_type);
         if (this->is_const) {
@@ -439,6 +516,16 @@ String gramina_type_to_str(const Type *this) {
 
         return subtype;
     }
+    case GRAMINA_TYPE_VECTOR: {
+        String base = this->is_const
+                    ? mk_str_c("const ")
+                    : mk_str();
+
+        String lane = type_to_str(this->element_type);
+        str_cat_cfmt(&base, "{so}<{sz}>", lane, this->length);
+
+        return base;
+    }
     default:
         break;
     }
@@ -446,7 +533,7 @@ String gramina_type_to_str(const Type *this) {
     return mk_str_c("<err-type>");
 }
 
-Type gramina_type_from_primitive(Primitive p) {
+Type gramina_type_from_primitive(const CompilerState *S, Primitive p) {
     switch (p) {
     case GRAMINA_PRIMITIVE_BOOL:
         return BUILTIN_PRIMITIVE(BOOL, Int1);
@@ -462,6 +549,10 @@ Type gramina_type_from_primitive(Primitive p) {
         return BUILTIN_PRIMITIVE(INT, Int32);
     case GRAMINA_PRIMITIVE_UINT:
         return BUILTIN_PRIMITIVE(UINT, Int32);
+    case GRAMINA_PRIMITIVE_ISIZE:
+        return POINTER_SIZED_PRIMITIVE(ISIZE);
+    case GRAMINA_PRIMITIVE_USIZE:
+        return POINTER_SIZED_PRIMITIVE(USIZE);
     case GRAMINA_PRIMITIVE_LONG:
         return BUILTIN_PRIMITIVE(LONG, Int64);
     case GRAMINA_PRIMITIVE_ULONG:
@@ -479,6 +570,7 @@ bool gramina_primitive_is_unsigned(Primitive this) {
     case GRAMINA_PRIMITIVE_UBYTE:
     case GRAMINA_PRIMITIVE_USHORT:
     case GRAMINA_PRIMITIVE_UINT:
+    case GRAMINA_PRIMITIVE_USIZE:
     case GRAMINA_PRIMITIVE_ULONG:
         return true;
     default:
@@ -490,6 +582,7 @@ bool gramina_primitive_is_integral(Primitive this) {
     return this != GRAMINA_PRIMITIVE_FLOAT && this != GRAMINA_PRIMITIVE_DOUBLE;
 }
 
+// Constness is ignored at every level, it is checked separately
 bool gramina_type_is_same(const Type *a, const Type *b) {
     if (a->kind != b->kind) {
         return false;
@@ -503,43 +596,39 @@ bool gramina_type_is_same(const Type *a, const Type *b) {
     case GRAMINA_TYPE_PRIMITIVE:
         return a->primitive == b->primitive;
     case GRAMINA_TYPE_POINTER:
-        return type_is_same(a->pointer_type, b->pointer_type);
+        return type_unqualified(a->pointer_type) == type_unqualified(b->pointer_type);
     case GRAMINA_TYPE_SLICE:
-        return type_is_same(a->slice_type, b->slice_type);
+        return type_unqualified(a->slice_type) == type_unqualified(b->slice_type);
     case GRAMINA_TYPE_ARRAY:
+    case GRAMINA_TYPE_VECTOR:
         return a->length == b->length
-            && type_is_same(a->element_type, b->element_type);
-
+            && type_unqualified(a->element_type) == type_unqualified(b->element_type);
     case GRAMINA_TYPE_STRUCT:
-        if (str_cmp(&a->struct_name, &b->struct_name) != 0) {
-            return false;
-        }
-
-        hashmap_foreach(StructField, name, field_a, a->fields) {
-            StructField *field_b = hashmap_get(&b->fields, name);
-            if (!field_b) {
-                return false;
-            }
-
-            if (field_a->index != field_b->index
-             || !type_is_same(&field_a->type, &field_b->type)) {
-                return false;
-            }
-        }
-
-        return true;
+        return a->llvm == b->llvm;
     default:
         return false;
     }
 }
 
+/**
+ * Pointer sized integers still narrow implicitly, since code such as
+ * `uint n = xs:length;` was written when slice lengths were `uint`.
+ * Conversions that rely on this produce a warning.
+ */
+bool gramina_primitive_is_narrowing(Primitive a, Primitive b) {
+    return (a == GRAMINA_PRIMITIVE_ISIZE || a == GRAMINA_PRIMITIVE_USIZE)
+        && b != GRAMINA_PRIMITIVE_BOOL
+        && b < a
+        && primitive_is_unsigned(a) == primitive_is_unsigned(b);
+}
+
 bool gramina_primitive_can_convert(Primitive a, Primitive b) {
     if (a == b) {
         return true;
     }
 
     return primitive_is_unsigned(a) == primitive_is_unsigned(b)
-         ? b > a
+         ? b > a || primitive_is_narrowing(a, b)
          : false;
 }
 
@@ -552,6 +641,11 @@ bool gramina_type_can_convert(const CompilerState *S, const Type *from, const Ty
         return primitive_can_convert(from->primitive, to->primitive);
     }
 
+    // Scalars are splatted across every lane
+    if (from->kind == GRAMINA_TYPE_PRIMITIVE && to->kind == GRAMINA_TYPE_VECTOR) {
+        return primitive_can_convert(from->primitive, to->element_type->primitive);
+    }
+
     if (from->kind == GRAMINA_TYPE_ARRAY && to->kind == GRAMINA_TYPE_SLICE
      && !(from->element_type->is_const && !to->slice_type->is_const)
      && type_is_same(from->element_type, to->slice_type)) {
@@ -568,6 +662,15 @@ static bool respects_const(bool is_const, bool wants_const) {
 }
 
 bool gramina_init_respects_constness(const CompilerState *S, const Type *from, const Type *to) {
+    // Arguments are checked before they are converted
+    if (from->kind == GRAMINA_TYPE_ARRAY && to->kind == GRAMINA_TYPE_SLICE) {
+        return respects_const(from->element_type->is_const, to->slice_type->is_const);
+    }
+
+    if (from->kind == GRAMINA_TYPE_PRIMITIVE && to->kind == GRAMINA_TYPE_VECTOR) {
+        return true;
+    }
+
     if (from->kind != to->kind) {
         return false;
     }
@@ -583,20 +686,16 @@ bool gramina_init_respects_constness(const CompilerState *S, const Type *from, c
     return true;
 }
 
-Type gramina_decltype(const CompilerState *S, const AstNode *exp) {
+Type gramina_decltype(CompilerState *S, const AstNode *exp) {
     switch (exp->type) {
     case GRAMINA_AST_IDENTIFIER: {
-        StringView name = str_as_view(&exp->value.identifier);
-        Identifier *ident = resolve(S, &name);
+        Identifier *ident = resolve(S, exp->value.identifier);
         return type_dup(&ident->type);
     }
     case GRAMINA_AST_OP_ADDRESS_OF: {
         Type subtype = decltype(S, exp->left);
 
-        Type ret = mk_pointer_type(&subtype);
-        type_free(&subtype);
-
-        return ret;
+        return mk_pointer_type(S, &subtype);
     }
     case GRAMINA_AST_OP_ADD:
     case GRAMINA_AST_OP_SUB:
@@ -651,152 +750,14 @@ CoercionResult gramina_primitive_coercion(const Type *p, const Type *q) {
     };
 }
 
+/**
+ * Whatever a type refers to is owned by the compilation's type table, so
+ * types are copied by value and never need to be freed. These remain so
+ * that code handling types and values stays symmetric.
+ */
 Type gramina_type_dup(const Type *this) {
-    if (this->kind == GRAMINA_TYPE_INVALID
-     || this->kind == GRAMINA_TYPE_PRIMITIVE
-     || this->kind == GRAMINA_TYPE_VOID) {
-        return *this;
-    }
-
-    switch (this->kind) {
-    case GRAMINA_TYPE_FUNCTION: {
-        Type typ = {
-            .kind = GRAMINA_TYPE_FUNCTION,
-            .return_type = NULL,
-            .param_types = mk_array(_GraminaType),
-            .llvm = this->llvm,
-            .is_const = this->is_const,
-        };
-
-        if (this->return_type) {
-            typ.return_type = gramina_malloc(sizeof *typ.return_type);
-            *typ.return_type = type_dup(this->return_type);
-        }
-
-        if (this->param_types.length > 0) {
-            typ.param_types = mk_array_capacity(_GraminaType, this->param_types.length);
-            array_foreach_ref(_GraminaType, i, param, this->param_types) {
-                typ.param_types.items[i] = type_dup(param);
-            }
-        } else {
-            typ.param_types = mk_array(_GraminaType);
-        }
-
-        return typ;
-    }
-    case GRAMINA_TYPE_POINTER: {
-        Type typ = {
-            .kind = GRAMINA_TYPE_POINTER,
-            .llvm = this->llvm,
-            .is_const = this->is_const,
-        };
-
-        typ.pointer_type = gramina_malloc(sizeof *typ.pointer_type);
-        *typ.pointer_type = type_dup(this->pointer_type);
-
-        return typ;
-    }
-    case GRAMINA_TYPE_SLICE: {
-        Type typ = {
-            .kind = GRAMINA_TYPE_SLICE,
-            .llvm = this->llvm,
-            .is_const = this->is_const,
-        };
-
-        typ.slice_type = gramina_malloc(sizeof *typ.slice_type);
-        *typ.slice_type = type_dup(this->slice_type);
-
-        return typ;
-    }
-    case GRAMINA_TYPE_ARRAY: {
-        Type typ = {
-            .kind = GRAMINA_TYPE_ARRAY,
-            .length = this->length,
-            .llvm = this->llvm,
-            .is_const = this->is_const,
-        };
-
-        typ.element_type = gramina_malloc(sizeof *typ.element_type);
-        *typ.element_type = type_dup(this->element_type);
-
-        return typ;
-    }
-    case GRAMINA_TYPE_STRUCT: {
-        Type typ = {
-            .kind = GRAMINA_TYPE_STRUCT,
-            .struct_name = str_dup(&this->struct_name),
-            .llvm = this->llvm,
-            .is_const = this->is_const,
-        };
-
-        typ.fields = mk_hashmap(this->fields.n_buckets);
-        typ.fields.object_freer = this->fields.object_freer;
-
-        hashmap_foreach(StructField, key, value, this->fields) {
-            StructField *field = gramina_malloc(sizeof *field);
-            field->type = type_dup(&value->type);
-            field->index = value->index;
-
-            hashmap_set(&typ.fields, key, field);
-        }
-
-        return typ;
-    }
-    default:
-        return (Type) {
-            .kind = GRAMINA_TYPE_INVALID,
-        };
-    }
+    return *this;
 }
 
 void gramina_type_free(Type *this) {
-    if (this == NULL) {
-        return;
-    }
-
-    if (this->kind == GRAMINA_TYPE_INVALID
-     || this->kind == GRAMINA_TYPE_PRIMITIVE
-     || this->kind == GRAMINA_TYPE_VOID) {
-        return;
-    }
-
-    switch (this->kind) {
-    case GRAMINA_TYPE_FUNCTION:
-        type_free(this->return_type);
-        gramina_free(this->return_type);
-        this->return_type = NULL;
-
-        array_foreach_ref(_GraminaType, _, param, this->param_types) {
-            type_free(param);
-        }
-
-        array_free(_GraminaType, &this->param_types);
-
-        break;
-    case GRAMINA_TYPE_POINTER:
-        type_free(this->pointer_type);
-        gramina_free(this->pointer_type);
-        this->pointer_type = NULL;
-        break;
-    case GRAMINA_TYPE_SLICE:
-        type_free(this->slice_type);
-        gramina_free(this->slice_type);
-        this->slice_type = NULL;
-        break;
-    case GRAMINA_TYPE_ARRAY:
-        type_free(this->element_type);
-        gramina_free(this->element_type);
-        this->element_type = NULL;
-        break;
-    case GRAMINA_TYPE_STRUCT:
-        str_free(&this->struct_name);
-        this->struct_name = mk_str();
-
-        hashmap_free(&this->fields);
-        this->fields = mk_hashmap(0);
-
-        break;
-    default:
-        break;
-    }
 }
@@ -0,0 +1,266 @@
+#define GRAMINA_NO_NAMESPACE
+
+#include <stdint.h>
+#include <string.h>
+
+#include "common/def.h"
+
+#include "compiler/typetable.h"
+
+#define INITIAL_SLOTS 64
+
+typedef struct gramina_type_node {
+    Type type; // Must stay first, canonical `Type *`s are cast back to nodes
+    const Type *unqualified; // Same type with `is_const` cleared at every level
+    uint32_t hash;
+} TypeNode;
+
+static uint32_t mix(uint32_t h, uint64_t v) {
+    h ^= (uint32_t)(v ^ (v >> 32));
+    h *= 0x01000193;
+
+    return h;
+}
+
+/**
+ * Referenced types are canonical already, so shapes only ever need to be
+ * compared one level deep. Parameters are stored by value and get the
+ * same one level treatment.
+ */
+static uint32_t shape_hash(const Type *this) {
+    uint32_t h = 0x811C9DC5;
+    h = mix(h, this->kind);
+    h = mix(h, this->is_const);
+
+    switch (this->kind) {
+    case GRAMINA_TYPE_PRIMITIVE:
+        h = mix(h, this->primitive);
+        break;
+    case GRAMINA_TYPE_POINTER:
+        h = mix(h, (uintptr_t)this->pointer_type);
+        break;
+    case GRAMINA_TYPE_SLICE:
+        h = mix(h, (uintptr_t)this->slice_type);
+        break;
+    case GRAMINA_TYPE_ARRAY:
+    case GRAMINA_TYPE_VECTOR:
+        h = mix(h, (uintptr_t)this->element_type);
+        h = mix(h, this->length);
+        break;
+    case GRAMINA_TYPE_STRUCT:
+        h = mix(h, (uintptr_t)this->llvm);
+        break;
+    case GRAMINA_TYPE_FUNCTION:
+        h = mix(h, (uintptr_t)this->return_type);
+        array_foreach_ref(_GraminaType, _, param, this->param_types) {
+            h = mix(h, shape_hash(param));
+        }
+
+        break;
+    default:
+        break;
+    }
+
+    return h;
+}
+
+static bool shape_equal(const Type *a, const Type *b) {
+    if (a->kind != b->kind || a->is_const != b->is_const) {
+        return false;
+    }
+
+    switch (a->kind) {
+    case GRAMINA_TYPE_PRIMITIVE:
+        return a->primitive == b->primitive;
+    case GRAMINA_TYPE_POINTER:
+        return a->pointer_type == b->pointer_type;
+    case GRAMINA_TYPE_SLICE:
+        return a->slice_type == b->slice_type;
+    case GRAMINA_TYPE_ARRAY:
+    case GRAMINA_TYPE_VECTOR:
+        return a->element_type == b->element_type
+            && a->length == b->length;
+    case GRAMINA_TYPE_STRUCT:
+        // Each definition has its own named LLVM struct
+        return a->llvm == b->llvm;
+    case GRAMINA_TYPE_FUNCTION:
+        if (a->return_type != b->return_type
+         || a->param_types.length != b->param_types.length) {
+            return false;
+        }
+
+        array_foreach_ref(_GraminaType, i, param, a->param_types) {
+            if (!shape_equal(param, b->param_types.items + i)) {
+                return false;
+            }
+        }
+
+        return true;
+    default:
+        return true;
+    }
+}
+
+// Releases what a shape owns once the table decides not to keep it
+static void shape_release(Type *this) {
+    switch (this->kind) {
+    case GRAMINA_TYPE_STRUCT:
+        hashmap_free(&this->fields);
+        break;
+    case GRAMINA_TYPE_FUNCTION:
+        array_free(_GraminaType, &this->param_types);
+        break;
+    default:
+        break;
+    }
+}
+
+static TypeNode *lookup(const TypeTable *this, const Type *shape, uint32_t hash) {
+    if (this->n_slots == 0) {
+        return NULL;
+    }
+
+    size_t mask = this->n_slots - 1;
+    for (size_t i = hash & mask; this->slots[i]; i = (i + 1) & mask) {
+        TypeNode *node = this->slots[i];
+        if (node->hash == hash && shape_equal(&node->type, shape)) {
+            return node;
+        }
+    }
+
+    return NULL;
+}
+
+static void insert_slot(TypeNode **slots, size_t n_slots, TypeNode *node) {
+    size_t mask = n_slots - 1;
+    size_t i = node->hash & mask;
+
+    while (slots[i]) {
+        i = (i + 1) & mask;
+    }
+
+    slots[i] = node;
+}
+
+static void grow(TypeTable *this) {
+    size_t n_slots = this->n_slots == 0
+                   ? INITIAL_SLOTS
+                   : this->n_slots * 2;
+
+    TypeNode **slots = gramina_malloc(n_slots * sizeof *slots);
+    gramina_assert(slots != NULL, "out of memory while interning types\n");
+
+    memset(slots, 0, n_slots * sizeof *slots);
+
+    for (size_t i = 0; i < this->n_slots; ++i) {
+        if (this->slots[i]) {
+            insert_slot(slots, n_slots, this->slots[i]);
+        }
+    }
+
+    gramina_free(this->slots);
+    this->slots = slots;
+    this->n_slots = n_slots;
+}
+
+static const Type *strip_const(TypeTable *this, const Type *node) {
+    Type shape = *node;
+    shape.is_const = false;
+
+    switch (node->kind) {
+    case GRAMINA_TYPE_POINTER:
+        shape.pointer_type = (Type *)type_unqualified(node->pointer_type);
+        break;
+    case GRAMINA_TYPE_SLICE:
+        shape.slice_type = (Type *)type_unqualified(node->slice_type);
+        break;
+    case GRAMINA_TYPE_ARRAY:
+    case GRAMINA_TYPE_VECTOR:
+        shape.element_type = (Type *)type_unqualified(node->element_type);
+        break;
+    case GRAMINA_TYPE_STRUCT: {
+        // Const variants are derived from the plain definition
+        Type *plain = type_table_find(this, &shape);
+        return plain
+             ? plain
+             : node;
+    }
+    case GRAMINA_TYPE_FUNCTION:
+        return node;
+    default:
+        break;
+    }
+
+    if (shape_equal(&shape, node)) {
+        return node;
+    }
+
+    return type_table_intern(this, &shape);
+}
+
+TypeTable gramina_mk_type_table() {
+    return (TypeTable) {
+        .slots = NULL,
+        .n_slots = 0,
+        .count = 0,
+        .nodes = mk_arena(16 * 1024),
+    };
+}
+
+/**
+ * Always takes ownership of the fields or parameters of `shape`, which are
+ * released right away if an equal type is already in the table. Copies of
+ * canonical types share those with the table, so they must be looked up
+ * with `type_table_find` instead.
+ */
+Type *gramina_type_table_intern(TypeTable *this, Type *shape) {
+    uint32_t hash = shape_hash(shape);
+
+    TypeNode *node = lookup(this, shape, hash);
+    if (node) {
+        shape_release(shape);
+        return &node->type;
+    }
+
+    // Keep the load factor at or below 1/2
+    if ((this->count + 1) * 2 > this->n_slots) {
+        grow(this);
+    }
+
+    node = arena_alloc(&this->nodes, sizeof *node);
+    gramina_assert(node != NULL, "out of memory while interning types\n");
+
+    node->type = *shape;
+    node->hash = hash;
+
+    insert_slot(this->slots, this->n_slots, node);
+    ++this->count;
+
+    node->unqualified = strip_const(this, &node->type);
+
+    return &node->type;
+}
+
+Type *gramina_type_table_find(const TypeTable *this, const Type *shape) {
+    TypeNode *node = lookup(this, shape, shape_hash(shape));
+    return node
+         ? &node->type
+         : NULL;
+}
+
+const Type *gramina_type_unqualified(const Type *canonical) {
+    return ((const TypeNode *)canonical)->unqualified;
+}
+
+void gramina_type_table_free(TypeTable *this) {
+    for (size_t i = 0; i < this->n_slots; ++i) {
+        if (this->slots[i]) {
+            shape_release(&this->slots[i]->type);
+        }
+    }
+
+    gramina_free(this->slots);
+    arena_free(&this->nodes);
+
+    *this = (TypeTable) {};
+}
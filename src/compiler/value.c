@@ -32,47 +32,53 @@ Value invalid_value() {
     };
 }
 
-Value mk_primitive_value(Primitive primitive, PrimitiveInitialiser val) {
+Value mk_primitive_value(const CompilerState *S, Primitive primitive, PrimitiveInitialiser val) {
     LLVMValueRef const_val;
     switch (primitive) {
     case GRAMINA_PRIMITIVE_BOOL:
-        const_val = LLVMConstInt(LLVMInt1Type(), val.boolean, false);
+        const_val = LLVMConstInt(LLVMInt1TypeInContext(S->llvm_context), val.boolean, false);
         break;
     case GRAMINA_PRIMITIVE_BYTE:
-        const_val = LLVMConstInt(LLVMInt8Type(), val.i8, true);
+        const_val = LLVMConstInt(LLVMInt8TypeInContext(S->llvm_context), val.i8, true);
         break;
     case GRAMINA_PRIMITIVE_UBYTE:
-        const_val = LLVMConstInt(LLVMInt8Type(), val.u8, false);
+        const_val = LLVMConstInt(LLVMInt8TypeInContext(S->llvm_context), val.u8, false);
         break;
     case GRAMINA_PRIMITIVE_SHORT:
-        const_val = LLVMConstInt(LLVMInt16Type(), val.i16, true);
+        const_val = LLVMConstInt(LLVMInt16TypeInContext(S->llvm_context), val.i16, true);
         break;
     case GRAMINA_PRIMITIVE_USHORT:
-        const_val = LLVMConstInt(LLVMInt16Type(), val.u16, false);
+        const_val = LLVMConstInt(LLVMInt16TypeInContext(S->llvm_context), val.u16, false);
         break;
     case GRAMINA_PRIMITIVE_INT:
-        const_val = LLVMConstInt(LLVMInt32Type(), val.i32, true);
+        const_val = LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), val.i32, true);
         break;
     case GRAMINA_PRIMITIVE_UINT:
-        const_val = LLVMConstInt(LLVMInt32Type(), val.u32, false);
+        const_val = LLVMConstInt(LLVMInt32TypeInContext(S->llvm_context), val.u32, false);
+        break;
+    case GRAMINA_PRIMITIVE_ISIZE:
+        const_val = LLVMConstInt(LLVMIntPtrTypeInContext(S->llvm_context, S->llvm_target_data), val.i64, true);
+        break;
+    case GRAMINA_PRIMITIVE_USIZE:
+        const_val = LLVMConstInt(LLVMIntPtrTypeInContext(S->llvm_context, S->llvm_target_data), val.u64, false);
         break;
     case GRAMINA_PRIMITIVE_LONG:
-        const_val = LLVMConstInt(LLVMInt64Type(), val.i64, true);
+        const_val = LLVMConstInt(LLVMInt64TypeInContext(S->llvm_context), val.i64, true);
         break;
     case GRAMINA_PRIMITIVE_ULONG:
-        const_val = LLVMConstInt(LLVMInt64Type(), val.u64, false);
+        const_val = LLVMConstInt(LLVMInt64TypeInContext(S->llvm_context), val.u64, false);
         break;
     case GRAMINA_PRIMITIVE_FLOAT:
-        const_val = LLVMConstReal(LLVMFloatType(), val.f32);
+        const_val = LLVMConstReal(LLVMFloatTypeInContext(S->llvm_context), val.f32);
         break;
     case GRAMINA_PRIMITIVE_DOUBLE:
-        const_val = LLVMConstReal(LLVMDoubleType(), val.f64);
+        const_val = LLVMConstReal(LLVMDoubleTypeInContext(S->llvm_context), val.f64);
         break;
     }
 
     return (Value) {
         .llvm = const_val,
-        .type = type_from_primitive(primitive),
+        .type = type_from_primitive(S, primitive),
         .class = GRAMINA_CLASS_CONSTEXPR,
     };
 }
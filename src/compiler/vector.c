@@ -0,0 +1,455 @@
+#define GRAMINA_NO_NAMESPACE
+
+#include <llvm-c/Core.h>
+#include <llvm-c/Target.h>
+
+#include "compiler/access.h"
+#include "compiler/conversions.h"
+#include "compiler/errors.h"
+#include "compiler/expressions.h"
+#include "compiler/mem.h"
+#include "compiler/type.h"
+#include "compiler/vector.h"
+
+typedef enum {
+    BUILTIN_NONE,
+    BUILTIN_LOAD,
+    BUILTIN_STORE,
+    BUILTIN_SHUFFLE,
+    BUILTIN_SELECT,
+} Builtin;
+
+static Builtin builtin_of(Symbol name) {
+    StringView view = symbol_view(name);
+
+    if (sv_cmp_c(&view, "load") == 0) {
+        return BUILTIN_LOAD;
+    } else if (sv_cmp_c(&view, "store") == 0) {
+        return BUILTIN_STORE;
+    } else if (sv_cmp_c(&view, "shuffle") == 0) {
+        return BUILTIN_SHUFFLE;
+    } else if (sv_cmp_c(&view, "select") == 0) {
+        return BUILTIN_SELECT;
+    }
+
+    return BUILTIN_NONE;
+}
+
+bool is_vector_builtin(Symbol name) {
+    return builtin_of(name) != BUILTIN_NONE;
+}
+
+// Arguments are chained through expression lists, except for the last one
+static size_t count_args(const AstNode *this) {
+    size_t n = 0;
+
+    const AstNode *cur = this->right;
+    for (; cur && cur->type == GRAMINA_AST_EXPRESSION_LIST; cur = cur->right) {
+        ++n;
+    }
+
+    return cur
+         ? n + 1
+         : n;
+}
+
+static void collect_args(AstNode *this, AstNode **args) {
+    size_t i = 0;
+
+    AstNode *cur = this->right;
+    for (; cur && cur->type == GRAMINA_AST_EXPRESSION_LIST; cur = cur->right) {
+        args[i++] = cur->left;
+    }
+
+    if (cur) {
+        args[i] = cur;
+    }
+}
+
+static bool check_arity(CompilerState *S, const AstNode *this, size_t n_args, size_t wants) {
+    if (n_args < wants) {
+        err_insufficient_args(S, wants, n_args);
+        S->error.pos = this->pos;
+        return false;
+    }
+
+    if (n_args > wants) {
+        err_excess_args(S, wants);
+        S->error.pos = this->pos;
+        return false;
+    }
+
+    return true;
+}
+
+// The vector type the enclosing declaration, assignment or parameter expects, if any
+static Type expected_vector(const CompilerState *S) {
+    Type none = {
+        .kind = GRAMINA_TYPE_INVALID,
+    };
+
+    if (S->reflection.length == 0) {
+        return none;
+    }
+
+    const Reflection *reflection = S->reflection.items + S->reflection.length - 1;
+    if (S->reflection_depth <= reflection->depth
+     || reflection->type.kind != GRAMINA_TYPE_VECTOR) {
+        return none;
+    }
+
+    Type ret = type_dup(&reflection->type);
+    ret.is_const = false;
+
+    return ret;
+}
+
+static bool literal_index(const AstNode *this, uint64_t *index) {
+    switch (this->type) {
+    case GRAMINA_AST_VAL_I32:
+        *index = this->value.i32;
+        return this->value.i32 >= 0;
+    case GRAMINA_AST_VAL_U32:
+        *index = this->value.u32;
+        return true;
+    case GRAMINA_AST_VAL_I64:
+        *index = this->value.i64;
+        return this->value.i64 >= 0;
+    case GRAMINA_AST_VAL_U64:
+        *index = this->value.u64;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * The element at `index`, the lanes of a load or store start at its address.
+ * The element itself is loaded as well, which is left for LLVM to drop.
+ */
+static Value lane_at(CompilerState *S, const Value *array, const Value *index) {
+    switch (array->type.kind) {
+    case GRAMINA_TYPE_ARRAY:
+    case GRAMINA_TYPE_SLICE:
+    case GRAMINA_TYPE_POINTER:
+        return subscript(S, array, index);
+    default: {
+        StringView op = mk_sv_c("subscript");
+        err_illegal_op(S, &array->type, &index->type, &op);
+        return invalid_value();
+    }
+    }
+}
+
+static LLVMValueRef set_lane_alignment(CompilerState *S, LLVMValueRef inst, const Type *lane) {
+    // Nothing but the lanes themselves has to be aligned
+    LLVMSetAlignment(inst, LLVMABIAlignmentOfType(S->llvm_target_data, lane->llvm));
+    return inst;
+}
+
+static Value load_builtin(CompilerState *S, LLVMValueRef function, AstNode *this, AstNode **args, size_t n_args) {
+    if (!check_arity(S, this, n_args, 2)) {
+        return invalid_value();
+    }
+
+    Type vector = expected_vector(S);
+    if (vector.kind == GRAMINA_TYPE_INVALID) {
+        StringView name = mk_sv_c("load");
+        err_infer_vector(S, &name);
+        S->error.pos = this->pos;
+        return invalid_value();
+    }
+
+    Value array = expression(S, function, args[0]);
+    Value index = expression(S, function, args[1]);
+
+    Value lane = value_is_valid(&array) && value_is_valid(&index)
+               ? lane_at(S, &array, &index)
+               : invalid_value();
+
+    value_free(&array);
+    value_free(&index);
+
+    if (!value_is_valid(&lane)) {
+        type_free(&vector);
+        return invalid_value();
+    }
+
+    if (!type_is_same(&lane.type, vector.element_type)) {
+        err_implicit_conv(S, &lane.type, vector.element_type);
+
+        value_free(&lane);
+        type_free(&vector);
+
+        return invalid_value();
+    }
+
+    LLVMValueRef loaded = LLVMBuildLoad2(S->llvm_builder, vector.llvm, lane.lvalue_ptr, "");
+
+    Value ret = {
+        .llvm = set_lane_alignment(S, loaded, &lane.type),
+        .type = vector,
+        .class = GRAMINA_CLASS_RVALUE,
+    };
+
+    value_free(&lane);
+
+    return ret;
+}
+
+static Value store_builtin(CompilerState *S, LLVMValueRef function, AstNode *this, AstNode **args, size_t n_args) {
+    if (!check_arity(S, this, n_args, 3)) {
+        return invalid_value();
+    }
+
+    Value array = expression(S, function, args[0]);
+    Value index = expression(S, function, args[1]);
+    Value value = expression(S, function, args[2]);
+
+    Value lane = value_is_valid(&array) && value_is_valid(&index) && value_is_valid(&value)
+               ? lane_at(S, &array, &index)
+               : invalid_value();
+
+    value_free(&index);
+
+    Value ret = invalid_value();
+
+    if (!value_is_valid(&lane)) {
+        goto end;
+    }
+
+    if (lane.type.is_const) {
+        err_const_assign(S, &lane.type);
+        goto end;
+    }
+
+    try_load_inplace(S, &value);
+
+    if (value.type.kind != GRAMINA_TYPE_VECTOR) {
+        StringView name = mk_sv_c("store");
+        err_not_vector(S, &value.type, &name);
+        goto end;
+    }
+
+    if (!type_is_same(value.type.element_type, &lane.type)) {
+        Type expected = mk_vector_type(S, &lane.type, value.type.length);
+        err_implicit_conv(S, &value.type, &expected);
+        type_free(&expected);
+        goto end;
+    }
+
+    LLVMValueRef stored = LLVMBuildStore(S->llvm_builder, value.llvm, lane.lvalue_ptr);
+
+    ret = (Value) {
+        .llvm = set_lane_alignment(S, stored, &lane.type),
+        .type = {
+            .kind = GRAMINA_TYPE_VOID,
+            .llvm = LLVMVoidTypeInContext(S->llvm_context),
+        },
+        .class = GRAMINA_CLASS_RVALUE,
+    };
+
+end:
+    value_free(&lane);
+    value_free(&array);
+    value_free(&value);
+
+    return ret;
+}
+
+static Value shuffle_builtin(CompilerState *S, LLVMValueRef function, AstNode *this, AstNode **args, size_t n_args) {
+    StringView name = mk_sv_c("shuffle");
+
+    if (n_args < 2) {
+        err_insufficient_args(S, 2, n_args);
+        S->error.pos = this->pos;
+        return invalid_value();
+    }
+
+    Value a = expression(S, function, args[0]);
+    try_load_inplace(S, &a);
+
+    if (!value_is_valid(&a)) {
+        return invalid_value();
+    }
+
+    if (a.type.kind != GRAMINA_TYPE_VECTOR) {
+        err_not_vector(S, &a.type, &name);
+        S->error.pos = args[0]->pos;
+        value_free(&a);
+        return invalid_value();
+    }
+
+    // A second vector is told apart from the indices by not being a literal
+    uint64_t index;
+    size_t first_index = literal_index(args[1], &index) || args[1]->type == GRAMINA_AST_OP_UNARY_MINUS
+                       ? 1
+                       : 2;
+
+    Value b = invalid_value();
+    if (first_index == 2) {
+        b = expression(S, function, args[1]);
+        try_load_inplace(S, &b);
+
+        if (!value_is_valid(&b) || !type_is_same(&a.type, &b.type)) {
+            if (value_is_valid(&b)) {
+                err_illegal_op(S, &a.type, &b.type, &name);
+                S->error.pos = args[1]->pos;
+            }
+
+            value_free(&a);
+            value_free(&b);
+            return invalid_value();
+        }
+    }
+
+    size_t n_sources = first_index == 2
+                     ? 2 * a.type.length
+                     : a.type.length;
+
+    size_t n_lanes = n_args - first_index;
+    if (n_lanes == 0) {
+        err_insufficient_args(S, n_args + 1, n_args);
+        S->error.pos = this->pos;
+
+        value_free(&a);
+        value_free(&b);
+        return invalid_value();
+    }
+
+    LLVMTypeRef i32 = LLVMInt32TypeInContext(S->llvm_context);
+    LLVMValueRef mask[n_lanes];
+
+    for (size_t i = 0; i < n_lanes; ++i) {
+        AstNode *node = args[first_index + i];
+        if (!literal_index(node, &index) || index >= n_sources) {
+            err_shuffle_index(S, n_sources);
+            S->error.pos = node->pos;
+
+            value_free(&a);
+            value_free(&b);
+            return invalid_value();
+        }
+
+        mask[i] = LLVMConstInt(i32, index, false);
+    }
+
+    LLVMValueRef second = first_index == 2
+                        ? b.llvm
+                        : LLVMGetPoison(a.type.llvm);
+
+    Value ret = {
+        .llvm = LLVMBuildShuffleVector(S->llvm_builder, a.llvm, second, LLVMConstVector(mask, n_lanes), ""),
+        .type = mk_vector_type(S, a.type.element_type, n_lanes),
+        .class = GRAMINA_CLASS_RVALUE,
+    };
+
+    value_free(&a);
+    value_free(&b);
+
+    return ret;
+}
+
+static Value select_builtin(CompilerState *S, LLVMValueRef function, AstNode *this, AstNode **args, size_t n_args) {
+    StringView name = mk_sv_c("select");
+
+    if (!check_arity(S, this, n_args, 3)) {
+        return invalid_value();
+    }
+
+    Value mask = expression(S, function, args[0]);
+    Value a = expression(S, function, args[1]);
+    Value b = expression(S, function, args[2]);
+
+    Value lhs = invalid_value();
+    Value rhs = invalid_value();
+    Value ret = invalid_value();
+
+    if (!value_is_valid(&mask) || !value_is_valid(&a) || !value_is_valid(&b)) {
+        goto end;
+    }
+
+    try_load_inplace(S, &mask);
+
+    if (mask.type.kind != GRAMINA_TYPE_VECTOR) {
+        err_not_vector(S, &mask.type, &name);
+        S->error.pos = args[0]->pos;
+        goto end;
+    }
+
+    if (mask.type.element_type->primitive != GRAMINA_PRIMITIVE_BOOL) {
+        Type bool_type = type_from_primitive(S, GRAMINA_PRIMITIVE_BOOL);
+        Type expected = mk_vector_type(S, &bool_type, mask.type.length);
+
+        err_implicit_conv(S, &mask.type, &expected);
+        S->error.pos = args[0]->pos;
+
+        type_free(&expected);
+        type_free(&bool_type);
+        goto end;
+    }
+
+    if (a.type.kind != GRAMINA_TYPE_VECTOR && b.type.kind != GRAMINA_TYPE_VECTOR) {
+        err_not_vector(S, &a.type, &name);
+        S->error.pos = args[1]->pos;
+        goto end;
+    }
+
+    Type vector = coerce_vectors(S, &a, &b, &lhs, &rhs);
+    if (vector.kind == GRAMINA_TYPE_INVALID) {
+        goto end;
+    }
+
+    if (vector.length != mask.type.length) {
+        err_illegal_op(S, &mask.type, &vector, &name);
+        type_free(&vector);
+        goto end;
+    }
+
+    ret = (Value) {
+        .llvm = LLVMBuildSelect(S->llvm_builder, mask.llvm, lhs.llvm, rhs.llvm, ""),
+        .type = vector,
+        .class = GRAMINA_CLASS_RVALUE,
+    };
+
+end:
+    value_free(&lhs);
+    value_free(&rhs);
+    value_free(&mask);
+    value_free(&a);
+    value_free(&b);
+
+    return ret;
+}
+
+Value vector_builtin_expr(CompilerState *S, LLVMValueRef function, AstNode *this) {
+    size_t n_args = count_args(this);
+    AstNode *args[n_args + 1]; // The array should not have a size of 0
+
+    collect_args(this, args);
+
+    Value ret;
+    switch (builtin_of(this->left->value.identifier)) {
+    case BUILTIN_LOAD:
+        ret = load_builtin(S, function, this, args, n_args);
+        break;
+    case BUILTIN_STORE:
+        ret = store_builtin(S, function, this, args, n_args);
+        break;
+    case BUILTIN_SHUFFLE:
+        ret = shuffle_builtin(S, function, this, args, n_args);
+        break;
+    case BUILTIN_SELECT:
+        ret = select_builtin(S, function, this, args, n_args);
+        break;
+    default:
+        ret = invalid_value();
+        break;
+    }
+
+    if (!value_is_valid(&ret) && S->error.pos.depth == 0) {
+        S->error.pos = this->pos;
+    }
+
+    return ret;
+}
@@ -16,8 +16,8 @@ typedef _Bool bool;
 GRAMINA_DECLARE_ARRAY(bool, static);
 GRAMINA_IMPLEMENT_ARRAY(bool, static);
 
-AstNode *gramina_mk_ast_node(AstNode *parent) {
-    AstNode *this = gramina_malloc(sizeof *this);
+AstNode *gramina_mk_ast_node(Arena *arena, AstNode *parent) {
+    AstNode *this = arena_alloc(arena, sizeof *this);
     if (this == NULL) {
         return this;
     }
@@ -31,89 +31,27 @@ AstNode *gramina_mk_ast_node(AstNode *parent) {
         }
     }
 
-    *this = (AstNode) {
-        .parent = parent,
-    };
-
     return this;
 }
 
-AstNode *gramina_mk_ast_node_lr(AstNode *parent, AstNode *l, AstNode *r) {
-    AstNode *this = mk_ast_node(parent);
+AstNode *gramina_mk_ast_node_lr(Arena *arena, AstNode *parent, AstNode *l, AstNode *r) {
+    AstNode *this = mk_ast_node(arena, parent);
     if (this == NULL) {
         return this;
     }
 
     this->left = l;
     this->right = r;
-    memset(&this->value, 0, (sizeof this->value));
-
-    if (l) {
-        l->parent = this;
-    }
-
-    if (r) {
-        r->parent = this;
-    }
 
     return this;
 }
 
-void gramina_ast_node_free(AstNode *this) {
-    if (this == NULL) {
-        return;
-    }
-
-    switch (this->type) {
-    case GRAMINA_AST_IDENTIFIER:
-    case GRAMINA_AST_FUNCTION_DEF:
-    case GRAMINA_AST_FUNCTION_DECLARATION:
-        str_free(&this->value.identifier);
-
-        array_foreach_ref(_GraminaSymAttr, _, attrib, this->value.attributes) {
-            symattr_free(attrib);
-        }
-
-        array_free(_GraminaSymAttr, &this->value.attributes);
-        break;
-    case GRAMINA_AST_STRUCT_DEF:
-        array_foreach_ref(_GraminaSymAttr, _, attrib, this->value.attributes) {
-            symattr_free(attrib);
-        }
-
-        array_free(_GraminaSymAttr, &this->value.attributes);
-        break;
-    case GRAMINA_AST_VAL_STRING:
-        str_free(&this->value.string);
-        break;
-    default:
-        break;
-    }
-
-    ast_node_free(this->left);
-    ast_node_free(this->right);
-
-    this->left = NULL;
-    this->right = NULL;
-    this->parent = NULL;
-
-    gramina_free(this);
-}
-
 void gramina_ast_node_child_l(AstNode *this, AstNode *new_child) {
     this->left = new_child;
-
-    if (new_child) {
-        new_child->parent = this;
-    }
 }
 
 void gramina_ast_node_child_r(AstNode *this, AstNode *new_child) {
     this->right = new_child;
-
-    if (new_child) {
-        new_child->parent = this;
-    }
 }
 
 SymbolAttribute *gramina_ast_node_get_symattr(const AstNode *this, SymbolAttributeKind kind) {
@@ -127,7 +65,11 @@ SymbolAttribute *gramina_ast_node_get_symattr(const AstNode *this, SymbolAttribu
         return NULL;
     }
 
-    array_foreach_ref(_GraminaSymAttr, _, attr, this->value.attributes) {
+    if (!this->value.attributes) {
+        return NULL;
+    }
+
+    array_foreach_ref(_GraminaSymAttr, _, attr, *this->value.attributes) {
         if (attr->kind == kind) {
             return attr;
         }
@@ -164,15 +106,17 @@ static String ast_node_stringify(const AstNode *this) {
     case GRAMINA_AST_IDENTIFIER:
     case GRAMINA_AST_FUNCTION_DEF:
     case GRAMINA_AST_FUNCTION_DECLARATION: {
-        if (this->value.attributes.length != 0) {
-            str_cat_cfmt(&out, "name: {s}, {sz} attribute(s)", &this->value.identifier, this->value.attributes.length);
+        StringView name = symbol_view(this->value.identifier);
+        if (this->value.attributes && this->value.attributes->length != 0) {
+            str_cat_cfmt(&out, "name: {sv}, {sz} attribute(s)", &name, this->value.attributes->length);
         } else {
-            str_cat_cfmt(&out, "name: {s}", &this->value.identifier);
+            str_cat_cfmt(&out, "name: {sv}", &name);
         }
 
         break;
     }
     case GRAMINA_AST_TYPE_ARRAY:
+    case GRAMINA_AST_TYPE_VECTOR:
         str_cat_cfmt(&out, "length: {sz}", this->value.array_length);
         break;
     default:
@@ -327,6 +271,8 @@ StringView gramina_ast_node_type_to_str(AstNodeType e) {
         return mk_sv_c("TYPE_SLICE");
     case GRAMINA_AST_TYPE_ARRAY:
         return mk_sv_c("TYPE_ARRAY");
+    case GRAMINA_AST_TYPE_VECTOR:
+        return mk_sv_c("TYPE_VECTOR");
     case GRAMINA_AST_TYPE_POINTER:
         return mk_sv_c("TYPE_POINTER");
 
@@ -345,6 +291,8 @@ StringView gramina_ast_node_type_to_str(AstNodeType e) {
         return mk_sv_c("IF_STATEMENT");
     case GRAMINA_AST_FOR_STATEMENT:
     	return mk_sv_c("FOR_STATEMENT");
+    case GRAMINA_AST_FOREACH_STATEMENT:
+    	return mk_sv_c("FOREACH_STATEMENT");
     case GRAMINA_AST_WHILE_STATEMENT:
     	return mk_sv_c("WHILE_STATEMENT");
 
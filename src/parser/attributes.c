@@ -4,11 +4,10 @@
 
 GRAMINA_IMPLEMENT_ARRAY(_GraminaSymAttr);
 
-// GRAMINA_ATTRIBUTE_METHOD currently leaks memory.
-// This will be fixed when method syntax is finalised
 void gramina_symattr_free(SymbolAttribute *this) {
     switch (this->kind) {
     case GRAMINA_ATTRIBUTE_EXTERN:
+    case GRAMINA_ATTRIBUTE_METHOD:
         str_free(&this->string);
         break;
     default:
@@ -18,6 +17,21 @@ void gramina_symattr_free(SymbolAttribute *this) {
     this->kind = GRAMINA_ATTRIBUTE_NONE;
 }
 
+SymbolAttribute gramina_symattr_dup(const SymbolAttribute *this) {
+    SymbolAttribute copy = *this;
+
+    switch (this->kind) {
+    case GRAMINA_ATTRIBUTE_EXTERN:
+    case GRAMINA_ATTRIBUTE_METHOD:
+        copy.string = str_dup(&this->string);
+        break;
+    default:
+        break;
+    }
+
+    return copy;
+}
+
 SymbolAttributeKind gramina_get_attrib_kind(const StringView *name) {
     if (false) {
     } else if (sv_cmp_c(name, "extern") == 0) {
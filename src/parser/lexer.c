@@ -4,6 +4,7 @@
 #include <stdlib.h>
 
 #include "parser/lexer.h"
+#include "parser/scan.h"
 
 #define PROP(err) do { if (err) return err; } while (0)
 #define safe_peek(S, ch_ptr) do { \
@@ -12,16 +13,19 @@
 } while (0) \
 
 typedef struct tagged_lexer_state {
+    // Position of the last consumed character
     TokenPosition pos;
 
     String pending_error;
 
-    char put;
-    char peeked;
-    Stream *source;
-    Array(GraminaToken) tokens;
+    StringView source;
+    size_t cursor;
+    TokenSlab tokens;
+    Array(_GraminaLexLiteral) literals;
 } LexerState;
 
+GRAMINA_IMPLEMENT_ARRAY(_GraminaLexLiteral);
+
 typedef struct {
     char c[4];
 } ReadableCharBuf;
@@ -54,74 +58,68 @@ static int put_err(LexerState *S, String err) {
     return GRAMINA_LEX_ERR_NONE;
 }
 
-static int unread_ch(LexerState *S, char ch) {
-    if (S->put) {
-        return GRAMINA_LEX_ERR_OCCUPIED;
-    }
+#define REST(S) ((S)->source.data + (S)->cursor)
+#define N_LEFT(S) ((S)->source.length - (S)->cursor)
 
-    S->put = ch;
+// Line breaks reset the column, both '\r' and '\n' count as one
+static void advance(LexerState *S, size_t n) {
+    size_t last;
+    size_t n_lines = scan_newlines(REST(S), n, &last);
 
-    return GRAMINA_LEX_ERR_NONE;
+    if (n_lines) {
+        S->pos.line += n_lines;
+        S->pos.column = n - last - 1;
+    } else {
+        S->pos.column += n;
+    }
+
+    S->pos.depth += n;
+    S->cursor += n;
 }
 
-static int read_ch(LexerState *S, char *ch) {
-    int status = stream_read_byte(S->source, (unsigned char *)ch);
-    PROP(status);
+// Position of the character that would be consumed next
+static TokenPosition peek_pos(const LexerState *S) {
+    TokenPosition pos = S->pos;
+    if (S->cursor >= S->source.length) {
+        return pos;
+    }
 
-    switch (*ch) {
+    switch (S->source.data[S->cursor]) {
     case '\r':
     case '\n':
-        ++S->pos.depth;
-        ++S->pos.line;
-        S->pos.column = 0;
+        ++pos.depth;
+        ++pos.line;
+        pos.column = 0;
         break;
     default:
-        ++S->pos.depth;
-        ++S->pos.column;
+        ++pos.depth;
+        ++pos.column;
         break;
     }
 
-    return GRAMINA_LEX_ERR_NONE;
+    return pos;
 }
 
-static int peek_ch(LexerState *S, char *ch) {
-    if (S->put) {
-        *ch = S->put;
-        return GRAMINA_LEX_ERR_NONE;
-    }
-
-    if (S->peeked) {
-        *ch = S->peeked;
-        return GRAMINA_LEX_ERR_NONE;
+static int peek_ch_at(const LexerState *S, size_t offset, char *ch) {
+    if (offset >= N_LEFT(S)) {
+        return GRAMINA_LEX_ERR_EOF;
     }
 
-    int status = read_ch(S, ch);
-    if (!status) {
-        S->peeked = *ch;
-        return GRAMINA_LEX_ERR_NONE;
-    }
+    *ch = REST(S)[offset];
+    return GRAMINA_LEX_ERR_NONE;
+}
 
-    return status;
+static int peek_ch(const LexerState *S, char *ch) {
+    return peek_ch_at(S, 0, ch);
 }
 
 static int consume_ch(LexerState *S) {
-    if (S->put) {
-        S->put = '\0';
-        return GRAMINA_LEX_ERR_NONE;
-    }
-
-    if (S->peeked) {
-        S->peeked = '\0';
-        return GRAMINA_LEX_ERR_NONE;
+    if (N_LEFT(S) == 0) {
+        return GRAMINA_LEX_ERR_EOF;
     }
 
-    char throw;
-    int status = read_ch(S, &throw);
-    if (!status) {
-        return GRAMINA_LEX_ERR_NONE;
-    }
-
-    return status;
+    advance(S, 1);
+    return GRAMINA_LEX_ERR_NONE;
 }
 
 static uint8_t convert_hex_digit(char ch) {
@@ -225,7 +223,9 @@ static int read_escape(LexerState *S, String *into, char quote) {
     return GRAMINA_LEX_ERR_NONE;
 }
 
-static int read_stringlike(LexerState *S, String *into, char quote) {
+// Literals without escapes are sliced straight out of the source,
+// only the ones that need unescaping get their own copy
+static int read_stringlike(LexerState *S, StringView *into, char quote) {
     char ch;
     int status = peek_ch(S, &ch);
     PROP(status);
@@ -237,24 +237,53 @@ static int read_stringlike(LexerState *S, String *into, char quote) {
 
     consume_ch(S);
 
-    while (!(status = peek_ch(S, &ch))) {
-        if (ch == '\\') {
-            consume_ch(S);
-            status = read_escape(S, into, quote);
-            PROP(status);
-            continue;
-        } else {
-            consume_ch(S);
+    size_t start = S->cursor;
+
+    bool escaped = false;
+    String unescaped = mk_str();
+
+    while (true) {
+        size_t n = scan_until(REST(S), N_LEFT(S), quote, '\\');
+        if (escaped) {
+            StringView run = sv_slice(&S->source, S->cursor, S->cursor + n);
+            str_cat_sv(&unescaped, &run);
+        }
+
+        advance(S, n);
+
+        status = peek_ch(S, &ch);
+        if (status) {
+            str_free(&unescaped);
+            return status;
         }
 
         if (ch == quote) {
             break;
         }
 
-        str_append(into, ch);
+        if (!escaped) {
+            StringView prefix = sv_slice(&S->source, start, S->cursor);
+            str_cat_sv(&unescaped, &prefix);
+            escaped = true;
+        }
+
+        consume_ch(S);
+        status = read_escape(S, &unescaped, quote);
+        if (status) {
+            str_free(&unescaped);
+            return status;
+        }
     }
 
-    PROP(status);
+    size_t end = S->cursor;
+    consume_ch(S);
+
+    if (escaped) {
+        array_append(_GraminaLexLiteral, &S->literals, unescaped);
+        *into = str_as_view(array_last(_GraminaLexLiteral, &S->literals));
+    } else {
+        *into = sv_slice(&S->source, start, end);
+    }
 
     return GRAMINA_LEX_ERR_NONE;
 }
@@ -262,40 +291,28 @@ static int read_stringlike(LexerState *S, String *into, char quote) {
 static int read_bounded_comment(LexerState *S) {
     consume_ch(S);
 
-    int st;
-    char last = '\0';
-    char ch = '\0';
     while (true) {
-        last = ch;
+        advance(S, scan_until(REST(S), N_LEFT(S), '*', '*'));
+
+        int st = consume_ch(S);
+        PROP(st);
+
+        char ch;
         st = peek_ch(S, &ch);
         PROP(st);
 
-        if (last == '*' && ch == '/') {
-            st = consume_ch(S);
-            return st;
+        if (ch == '/') {
+            return consume_ch(S);
         }
-
-        st = consume_ch(S);
-        PROP(st);
     }
-
-    return st;
 }
 
 static int read_line_comment(LexerState *S) {
     consume_ch(S);
 
-    while (true) {
-        char ch;
-        int status = peek_ch(S, &ch);
-        PROP(status);
-
-        if (ch == '\n') {
-            break;
-        }
-
-        status = consume_ch(S);
-        PROP(status);
+    advance(S, scan_until(REST(S), N_LEFT(S), '\n', '\n'));
+    if (N_LEFT(S) == 0) {
+        return GRAMINA_LEX_ERR_EOF;
     }
 
     return GRAMINA_LEX_ERR_NONE;
@@ -310,20 +327,19 @@ static int read_comment(LexerState *S) {
         return GRAMINA_LEX_ERR_NO_TOK;
     }
 
-    consume_ch(S);
-    status = peek_ch(S, &ch);
+    status = peek_ch_at(S, 1, &ch);
     PROP(status);
 
     switch (ch) {
     default:
-        status = unread_ch(S, '/');
-        PROP(status);
         return GRAMINA_LEX_ERR_NO_TOK;
     case '*':
+        consume_ch(S);
         status = read_bounded_comment(S);
         PROP(status);
         break;
     case '/':
+        consume_ch(S);
         status = read_line_comment(S);
         PROP(status);
         break;
@@ -566,7 +582,7 @@ static int read_operator(LexerState *S, TokenType *typ) {
     return GRAMINA_LEX_ERR_NONE;
 }
 
-static int read_wordlike(LexerState *S, String *into) {
+static int read_wordlike(LexerState *S) {
     char ch;
     int status = peek_ch(S, &ch);
     PROP(status);
@@ -576,16 +592,9 @@ static int read_wordlike(LexerState *S, String *into) {
         return GRAMINA_LEX_ERR_NO_TOK;
     }
 
-    while (!(status = peek_ch(S, &ch))) {
-        if (!isalnum(ch) && ch != '_') {
-            break;
-        }
-
-        str_append(into, ch);
-        consume_ch(S);
-    }
+    advance(S, scan_word(REST(S), N_LEFT(S)));
 
-    return status;
+    return GRAMINA_LEX_ERR_NONE;
 }
 
 static TokenType mk_number_literal_type(bool is_long, bool is_unsigned, bool is_floating) {
@@ -626,51 +635,52 @@ static int read_number(LexerState *S, TokenData *data, TokenType *typ) {
 
     String text = mk_str();
     while (!(status = peek_ch(S, &ch))) {
-        if (!isdigit(ch) && ch != '.' && tolower(ch) != 'e') {
+        if (isdigit(ch)) {
+            size_t n = scan_digits(REST(S), N_LEFT(S));
+            StringView digits = sv_slice(&S->source, S->cursor, S->cursor + n);
+            str_cat_sv(&text, &digits);
+
+            advance(S, n);
+            continue;
+        }
+
+        if (ch != '.' && tolower(ch) != 'e') {
             break;
         }
 
-        if (ch == '.' || tolower(ch) == 'e') {
-            if (seen_decimal) {
+        if (seen_decimal) {
+            break;
+        }
+
+        if (ch == '.') {
+            char after;
+            status = peek_ch_at(S, 1, &after);
+
+            // Leave the dot alone, it is the start of another token
+            if (status || !isdigit(after)) {
                 break;
             }
 
             consume_ch(S);
+        } else {
+            consume_ch(S);
 
-            if (tolower(ch) == 'e') {
-                char minus;
-                status = peek_ch(S, &minus);
-                if (status) {
-                    break;
-                }
-
-                if (minus == '-') {
-                    str_append(&text, 'e');
-                    ch = '-';
-                }
-            } else {
-                char after;
-                status = peek_ch(S, &after);
-                if (status) {
-                    break;
-                }
-                
-                if (!isdigit(after)) {
-                    unread_ch(S, '.');
-                    break;
-                }
+            char minus;
+            status = peek_ch(S, &minus);
+            if (status) {
+                break;
             }
 
-            seen_decimal = true;
-        } else { 
-            consume_ch(S);
+            if (minus == '-') {
+                str_append(&text, 'e');
+                ch = '-';
+            }
         }
 
+        seen_decimal = true;
         str_append(&text, ch);
     }
 
-    PROP(status);
-
     String suffixes = mk_str();
     bool reading_suffixes = true;
     while (reading_suffixes && !(status = peek_ch(S, &ch))) {
@@ -785,41 +795,43 @@ static int read_token(LexerState *S, Token *tok) {
     char ch;
     int status = 0;
 
-    while (true) {
-        status = peek_ch(S, &ch);
-        PROP(status);
+    advance(S, scan_whitespace(REST(S), N_LEFT(S)));
 
-        if (isspace(ch)) {
-            consume_ch(S);
-        } else {
-            break;
-        }
-    }
+    status = peek_ch(S, &ch);
+    PROP(status);
 
     if (ch == '/') {
         status = read_comment(S);
         if (!status) {
-            peek_ch(S, &ch);
             return GRAMINA_LEX_DONT_PUSH_TOK;
         }
+
+        if (status != GRAMINA_LEX_ERR_NO_TOK) {
+            return status;
+        }
     }
 
-    TokenPosition start_pos = S->pos;
+    TokenPosition start_pos = peek_pos(S);
+    size_t start = S->cursor;
 
-    tok->flags = 0;
     tok->data = (TokenData) {};
-    tok->contents = mk_str();
+    tok->contents = (StringView) {
+        .data = NULL,
+        .length = 0,
+    };
 
     if (isalpha(ch) || ch == '_') {
-        String word = mk_str();
-        status = read_wordlike(S, &word);
+        status = read_wordlike(S);
         if (status) {
             return status;
         }
 
-        StringView view = str_as_view(&word);
-        tok->type = classify_wordlike(&view);
-        tok->contents = word;
+        tok->contents = sv_slice(&S->source, start, S->cursor);
+        tok->type = classify_wordlike(&tok->contents);
+
+        if (tok->type == GRAMINA_TOK_IDENTIFIER) {
+            tok->data.symbol = intern(&tok->contents);
+        }
     } else if (isdigit(ch)) {
         status = read_number(S, &tok->data, &tok->type);
         if (status) {
@@ -881,7 +893,7 @@ static int read_token(LexerState *S, Token *tok) {
                 return GRAMINA_LEX_ERR_BAD_TOK;
             }
 
-            if (ch == '\'') {
+            if (ch == '\'' && tok->contents.length > 0) {
                 tok->data._char = *tok->contents.data;
             }
 
@@ -918,10 +930,14 @@ static int read_token(LexerState *S, Token *tok) {
 
     tok->pos = start_pos;
 
+    if (!tok->contents.data) {
+        tok->contents = sv_slice(&S->source, start, S->cursor);
+    }
+
     return GRAMINA_LEX_ERR_NONE;
 }
 
-LexResult gramina_lex(Stream *source) {
+LexResult gramina_lex_sv(const StringView *source) {
     LexerState S = {
         .pos = {
             .line = 1,
@@ -929,10 +945,11 @@ LexResult gramina_lex(Stream *source) {
             .depth = 0,
         },
         .pending_error = mk_str(),
-        .put = '\0',
-        .peeked = '\0',
-        .source = source,
-        .tokens = mk_array(GraminaToken),
+        .source = *source,
+        .cursor = 0,
+        // Roughly one token per four bytes of source, so growing is rare
+        .tokens = mk_token_slab(source->length / 4 + 16),
+        .literals = mk_array(_GraminaLexLiteral),
     };
 
     Token tok = {};
@@ -944,7 +961,7 @@ LexResult gramina_lex(Stream *source) {
         }
 
         if (status != GRAMINA_LEX_DONT_PUSH_TOK) {
-            array_append(GraminaToken, &S.tokens, tok);
+            token_slab_push(&S.tokens, &tok);
         }
     }
 
@@ -953,7 +970,7 @@ LexResult gramina_lex(Stream *source) {
     }
 
     TokenPosition last_pos = S.tokens.length > 0
-                           ? array_last(GraminaToken, &S.tokens)->pos
+                           ? S.tokens.positions[S.tokens.length - 1]
                            : (TokenPosition){ .line = 1, .column = 1, .depth = 0 };
 
     if (S.tokens.length > 0) {
@@ -963,30 +980,49 @@ LexResult gramina_lex(Stream *source) {
 
     tok = (Token) {
         .pos = last_pos,
-        .flags = 0,
         .type = GRAMINA_TOK_EOF,
-        .contents = mk_str(),
+        .contents = mk_sv_c(""),
         .data = {}
     };
 
-    array_append(GraminaToken, &S.tokens, tok);
+    token_slab_push(&S.tokens, &tok);
 
     return (LexResult) {
         .tokens = S.tokens,
+        .literals = S.literals,
+        .owned_source = mk_str(),
         .status = status,
-        .error_position = S.pos,
+        .error_position = peek_pos(&S),
         .error_description = S.pending_error,
     };
 }
 
+LexResult gramina_lex(Stream *source) {
+    String contents = mk_str();
+
+    int status;
+    do {
+        status = stream_read_str(source, &contents, 4096, NULL);
+    } while (!status);
+
+    StringView view = str_as_view(&contents);
+    LexResult ret = lex_sv(&view);
+
+    // The tokens point into the drained contents
+    ret.owned_source = contents;
+    return ret;
+}
+
 void gramina_lex_result_free(LexResult *this) {
     str_free(&this->error_description);
 
-    array_foreach_ref(GraminaToken, _, tok, this->tokens) {
-        token_free(tok);
+    array_foreach_ref(_GraminaLexLiteral, _, literal, this->literals) {
+        str_free(literal);
     }
 
-    array_free(GraminaToken, &this->tokens);
+    array_free(_GraminaLexLiteral, &this->literals);
+    token_slab_free(&this->tokens);
+    str_free(&this->owned_source);
 
     this->status = GRAMINA_LEX_ERR_NONE;
     this->error_position = (TokenPosition) {};
@@ -16,9 +16,12 @@
 
 #undef slice
 #define sslice(T, this, start, end) gramina_ ## T ## _slice(this, start, end)
-#define CURRENT(S) ((S)->tokens->items[(S)->index])
-#define N_AFTER(S, n) ((S)->tokens->items[(S)->index + (n)])
-#define CONSUME(S) ((S)->tokens->items[(S)->index++])
+#define CURRENT(S) token_slab_get((S)->tokens, (S)->index)
+#define CURRENT_TYPE(S) ((S)->tokens->types[(S)->index])
+#define CURRENT_POS(S) ((S)->tokens->positions[(S)->index])
+#define N_AFTER_POS(S, n) ((S)->tokens->positions[(S)->index + (n)])
+#define N_AFTER_TYPE(S, n) ((S)->tokens->types[(S)->index + (n)])
+#define CONSUME(S) ((S)->index++)
 #define SET_ERR(S, str) ((S)->has_error = true, (S)->error = (str))
 #define HAS_ERR(S) ((S)->has_error)
 #define CLEAR_ERR(S) ((S)->has_error ? str_free(&(S)->error) : 0, (S)->has_error = false)
@@ -29,7 +32,7 @@
         return NULL;                                                    \
     }                                                                   \
                                                                         \
-    TokenPosition pos = CURRENT(S).pos;                                 \
+    TokenPosition pos = CURRENT_POS(S);                                 \
                                                                         \
     AstNodeType typ;                                                    \
     AstNode *right = this ## _pr(S, &typ);                              \
@@ -37,7 +40,7 @@
         return value_node;                                              \
     }                                                                   \
                                                                         \
-    AstNode *this = mk_ast_node_lr(NULL, value_node, right);            \
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, value_node, right);            \
     this->type = typ;                                                   \
     this->pos = pos;                                                    \
                                                                         \
@@ -55,7 +58,7 @@
         return value_node;                                              \
     }                                                                   \
                                                                         \
-    AstNode *this = mk_ast_node_lr(NULL, value_node, right);            \
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, value_node, right);            \
     this->type = subtyp;                                                \
     this->pos = cur.pos;                                                \
                                                                         \
@@ -66,7 +69,8 @@ struct tagged_parser_state;
 
 typedef struct tagged_parser_state {
     size_t index;
-    const Slice(GraminaToken) *tokens;
+    const TokenSlab *tokens;
+    Arena *arena;
     struct gramina_string error;
     bool has_error;
 } ParserState;
@@ -74,24 +78,38 @@ typedef struct tagged_parser_state {
 void gramina_parse_result_free(ParseResult *this) {
     if (!this->root) {
         str_free(&this->error.description);
-    } else {
-        ast_node_free(this->root);
     }
+
+    arena_free(&this->arena);
+    this->root = NULL;
+}
+
+static StringView arena_sv_dup(ParserState *S, const StringView *sv) {
+    char *data = arena_alloc(S->arena, sv->length + 1);
+    memcpy(data, sv->data, sv->length);
+
+    return (StringView) {
+        .length = sv->length,
+        .data = data,
+    };
 }
 
 static void print_parser_state(const ParserState *S);
 static AstNode *global_statement(ParserState *S);
-ParseResult gramina_parse(const Slice(GraminaToken) *tokens) {
+ParseResult gramina_parse(const TokenSlab *tokens) {
+    Arena arena = mk_arena(GRAMINA_ARENA_DEFAULT_BLOCK_SIZE);
+
     ParserState S = {
         .index = 0,
         .tokens = tokens,
+        .arena = &arena,
         .has_error = false,
     };
 
     AstNode *last = global_statement(&S);
     AstNode *root = last;
     size_t index = (size_t)-1;
-    while (S.tokens->items[S.index].type != GRAMINA_TOK_EOF) {
+    while (S.tokens->types[S.index] != GRAMINA_TOK_EOF) {
         AstNode *st = global_statement(&S);
         if (!st) {
             break;
@@ -112,32 +130,33 @@ ParseResult gramina_parse(const Slice(GraminaToken) *tokens) {
     if (S.has_error) {
         elog_fmt("Parser: {s}\n", &S.error);
 
-        ast_node_free(root);
         root = NULL;
 
-        const Token *last = &tokens->items[S.index];
-        String contents = token_contents(last);
+        Token last = token_slab_get(tokens, S.index);
+        String contents = token_contents(&last);
         str_cat_cfmt(&S.error, ", found '{s}'", &contents);
         str_free(&contents);
     }
 
     return (ParseResult) {
         .root = root,
+        .arena = arena,
         .error = {
             .description = S.error,
-            .pos = tokens->items[S.index].pos,
+            .pos = tokens->positions[S.index],
         },
     };
 }
 
 static void print_parser_state(const ParserState *S) {
-    slice_foreach_ref(GraminaToken, i, tok, *S->tokens) {
-        StringView typ = token_type_to_str(tok->type);
+    for (size_t i = 0; i < S->tokens->length; ++i) {
+        Token tok = token_slab_get(S->tokens, i);
+        StringView typ = token_type_to_str(tok.type);
         char pre = i == S->index
                  ? '>'
                  : ' ';
 
-        String contents = token_contents(tok);
+        String contents = token_contents(&tok);
         printf("%c %.*s: %.*s\n", pre, (int)typ.length, typ.data, (int)contents.length, contents.data);
         str_free(&contents);
     }
@@ -148,7 +167,7 @@ static void print_parser_state(const ParserState *S) {
 static AstNode *typename(ParserState *S);
 static AstNode *identifier(ParserState *S);
 static AstNode *param_list_pr(ParserState *S) {
-    if (CURRENT(S).type != GRAMINA_TOK_COMMA) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_COMMA) {
         return NULL;
     }
 
@@ -161,14 +180,13 @@ static AstNode *param_list_pr(ParserState *S) {
 
     AstNode *name = identifier(S);
     if (!name) {
-        ast_node_free(type);
         return NULL;
     }
 
     ast_node_child_l(name, type);
 
     AstNode *right = param_list_pr(S);
-    AstNode *this = mk_ast_node_lr(NULL, name, right);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, name, right);
     this->type = GRAMINA_AST_PARAM_LIST;
     this->pos = type->pos;
 
@@ -176,7 +194,7 @@ static AstNode *param_list_pr(ParserState *S) {
 }
 
 static AstNode *param_list(ParserState *S) {
-    if (CURRENT(S).type == GRAMINA_TOK_PAREN_RIGHT) {
+    if (CURRENT_TYPE(S) == GRAMINA_TOK_PAREN_RIGHT) {
         return NULL;
     }
 
@@ -187,18 +205,17 @@ static AstNode *param_list(ParserState *S) {
 
     AstNode *name = identifier(S);
     if (!name) {
-        ast_node_free(type);
         return NULL;
     }
 
     ast_node_child_l(name, type);
 
-    if (CURRENT(S).type != GRAMINA_TOK_COMMA) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_COMMA) {
         return name;
     }
 
     AstNode *right = param_list_pr(S);
-    AstNode *this = mk_ast_node_lr(NULL, name, right);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, name, right);
     this->type = GRAMINA_AST_PARAM_LIST;
     this->pos = type->pos;
 
@@ -207,7 +224,7 @@ static AstNode *param_list(ParserState *S) {
 
 static AstNode *function_body(ParserState *S);
 static AstNode *function_def(ParserState *S) {
-    if (CURRENT(S).type != GRAMINA_TOK_KW_FN) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_KW_FN) {
         return NULL;
     }
 
@@ -218,10 +235,9 @@ static AstNode *function_def(ParserState *S) {
         return NULL;
     }
 
-    if (CURRENT(S).type != GRAMINA_TOK_PAREN_LEFT) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_PAREN_LEFT) {
         SET_ERR(S, mk_str_c("expected '('"));
 
-        ast_node_free(name);
         return NULL;
     }
 
@@ -229,33 +245,28 @@ static AstNode *function_def(ParserState *S) {
 
     AstNode *params = param_list(S);
     if (HAS_ERR(S)) {
-        ast_node_free(name);
         return NULL;
     }
 
-    if (CURRENT(S).type != GRAMINA_TOK_PAREN_RIGHT) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_PAREN_RIGHT) {
         if (params) {
             SET_ERR(S, mk_str_c("expected ')'"));
         } else {
             SET_ERR(S, mk_str_c("expected parameter list or ')'"));
         }
 
-        ast_node_free(name);
-        ast_node_free(params);
         return NULL;
     }
 
     CONSUME(S);
 
     AstNode *return_type = NULL;
-    if (CURRENT(S).type == GRAMINA_TOK_MINUS) {
+    if (CURRENT_TYPE(S) == GRAMINA_TOK_MINUS) {
         CONSUME(S);
 
-        if (CURRENT(S).type != GRAMINA_TOK_GREATER_THAN) {
+        if (CURRENT_TYPE(S) != GRAMINA_TOK_GREATER_THAN) {
             SET_ERR(S, mk_str_c("expected '->'"));
 
-            ast_node_free(name);
-            ast_node_free(params);
             return NULL;
         }
 
@@ -263,33 +274,26 @@ static AstNode *function_def(ParserState *S) {
 
         return_type = typename(S);
         if (HAS_ERR(S)) {
-            ast_node_free(name);
-            ast_node_free(params);
             return NULL;
         }
     }
 
-    if (CURRENT(S).type != GRAMINA_TOK_BRACE_LEFT && CURRENT(S).type != GRAMINA_TOK_SEMICOLON) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_BRACE_LEFT && CURRENT_TYPE(S) != GRAMINA_TOK_SEMICOLON) {
         SET_ERR(S, mk_str_c("expected '{' or ';'"));
 
-        ast_node_free(name);
-        ast_node_free(params);
-        ast_node_free(return_type);
         return NULL;
     }
 
-    if (CURRENT(S).type == GRAMINA_TOK_SEMICOLON) {
-        AstNode *this = mk_ast_node_lr(NULL, NULL, NULL);
+    if (CURRENT_TYPE(S) == GRAMINA_TOK_SEMICOLON) {
+        AstNode *this = mk_ast_node_lr(S->arena, NULL, NULL, NULL);
         this->type = GRAMINA_AST_FUNCTION_DECLARATION;
         this->pos = name->pos;
-        this->value.identifier = str_dup(&name->value.identifier);
+        this->value.identifier = name->value.identifier;
 
-        AstNode *typ = mk_ast_node_lr(this, params, return_type);
+        AstNode *typ = mk_ast_node_lr(S->arena, this, params, return_type);
         typ->type = GRAMINA_AST_FUNCTION_TYPE;
         typ->pos = name->pos;
 
-        ast_node_free(name);
-
         CONSUME(S);
 
         return this;
@@ -299,31 +303,25 @@ static AstNode *function_def(ParserState *S) {
 
     AstNode *contents = function_body(S);
     if (HAS_ERR(S)) {
-        ast_node_free(name);
-        ast_node_free(params);
-        ast_node_free(return_type);
         return NULL;
     }
 
-    AstNode *this = mk_ast_node_lr(NULL, NULL, contents);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, NULL, contents);
     this->type = GRAMINA_AST_FUNCTION_DEF;
     this->pos = name->pos;
-    this->value.identifier = str_dup(&name->value.identifier);
+    this->value.identifier = name->value.identifier;
 
-    AstNode *typ = mk_ast_node_lr(this, params, return_type);
+    AstNode *typ = mk_ast_node_lr(S->arena, this, params, return_type);
     typ->type = GRAMINA_AST_FUNCTION_TYPE;
     typ->pos = name->pos;
 
-    ast_node_free(name);
-
-    if (CURRENT(S).type != GRAMINA_TOK_BRACE_RIGHT) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_BRACE_RIGHT) {
         if (contents) {
             SET_ERR(S, mk_str_c("expected '}'"));
         } else {
             SET_ERR(S, mk_str_c("expected function body or '}'"));
         }
 
-        ast_node_free(contents);
         return NULL;
     }
 
@@ -337,7 +335,7 @@ static AstNode *function_body(ParserState *S) {
     AstNode *root = NULL;
     AstNode *current = root;
 
-    while (CURRENT(S).type != GRAMINA_TOK_BRACE_RIGHT) {
+    while (CURRENT_TYPE(S) != GRAMINA_TOK_BRACE_RIGHT) {
         AstNode *this = statement(S);
         if (!this) {
             if (!HAS_ERR(S)) {
@@ -358,7 +356,6 @@ static AstNode *function_body(ParserState *S) {
     }
 
     if (HAS_ERR(S)) {
-        ast_node_free(root);
         return NULL;
     }
 
@@ -373,15 +370,12 @@ static AstNode *struct_field(ParserState *S) {
 
     AstNode *field = identifier(S);
     if (!field) {
-        ast_node_free(type);
         return NULL;
     }
 
-    if (CURRENT(S).type != GRAMINA_TOK_SEMICOLON) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_SEMICOLON) {
         SET_ERR(S, mk_str_c("expected ';'"));
 
-        ast_node_free(field);
-        ast_node_free(type);
         return NULL;
     }
 
@@ -389,7 +383,7 @@ static AstNode *struct_field(ParserState *S) {
 
     ast_node_child_l(field, type);
 
-    AstNode *this = mk_ast_node_lr(NULL, field, NULL);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, field, NULL);
     this->type = GRAMINA_AST_STRUCT_FIELD;
     this->pos = type->pos;
 
@@ -397,12 +391,12 @@ static AstNode *struct_field(ParserState *S) {
 }
 
 static AstNode *struct_def(ParserState *S) {
-    if (CURRENT(S).type != GRAMINA_TOK_KW_STRUCT) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_KW_STRUCT) {
         SET_ERR(S, mk_str_c("expected 'struct'"));
         return NULL;
     }
 
-    TokenPosition def_pos = CURRENT(S).pos;
+    TokenPosition def_pos = CURRENT_POS(S);
 
     CONSUME(S);
 
@@ -411,24 +405,22 @@ static AstNode *struct_def(ParserState *S) {
         return NULL;
     }
 
-    if (CURRENT(S).type != GRAMINA_TOK_BRACE_LEFT) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_BRACE_LEFT) {
         SET_ERR(S, mk_str_c("expected '{'"));
 
-        ast_node_free(name);
         return NULL;
     }
 
     CONSUME(S);
 
-    AstNode *this = mk_ast_node_lr(NULL, name, NULL);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, name, NULL);
     this->type = GRAMINA_AST_STRUCT_DEF;
     this->pos = def_pos;
 
     AstNode *cur = this;
-    while (CURRENT(S).type != GRAMINA_TOK_BRACE_RIGHT) {
+    while (CURRENT_TYPE(S) != GRAMINA_TOK_BRACE_RIGHT) {
         AstNode *field = struct_field(S);
         if (HAS_ERR(S)) {
-            ast_node_free(this);
             return NULL;
         }
 
@@ -441,51 +433,59 @@ static AstNode *struct_def(ParserState *S) {
     return this;
 }
 
+// Moves attributes collected in a temporary array into the arena
+static Array(_GraminaSymAttr) *arena_attributes(ParserState *S, Array(_GraminaSymAttr) *attribs) {
+    if (attribs->length == 0) {
+        array_free(_GraminaSymAttr, attribs);
+        return NULL;
+    }
+
+    Array(_GraminaSymAttr) *moved = arena_alloc(S->arena, sizeof *moved);
+    *moved = (Array(_GraminaSymAttr)) {
+        .length = attribs->length,
+        .capacity = attribs->length,
+        .items = arena_alloc(S->arena, attribs->length * sizeof *moved->items),
+    };
+
+    memcpy(moved->items, attribs->items, attribs->length * sizeof *moved->items);
+    array_free(_GraminaSymAttr, attribs);
+
+    return moved;
+}
+
 static AstNode *global_statement(ParserState *S) {
     Array(_GraminaSymAttr) attribs = mk_array(_GraminaSymAttr);
-    while (CURRENT(S).type == GRAMINA_TOK_HASH) {
+    while (CURRENT_TYPE(S) == GRAMINA_TOK_HASH) {
         CONSUME(S);
 
-        if (CURRENT(S).type != GRAMINA_TOK_IDENTIFIER) {
+        if (CURRENT_TYPE(S) != GRAMINA_TOK_IDENTIFIER) {
             SET_ERR(S, mk_str_c("expected attribute name"));
 
-            array_foreach_ref(_GraminaSymAttr, _, attr, attribs) {
-                symattr_free(attr);
-            }
-
             array_free(_GraminaSymAttr, &attribs);
             return NULL;
         }
 
-        const Token *attrib_tok = &CURRENT(S);
+        StringView attrib_name = CURRENT(S).contents;
         CONSUME(S);
 
         StringView contents = mk_sv_c("");
 
-        if (CURRENT(S).type == GRAMINA_TOK_PAREN_LEFT) {
+        if (CURRENT_TYPE(S) == GRAMINA_TOK_PAREN_LEFT) {
             CONSUME(S);
 
-            if (CURRENT(S).type != GRAMINA_TOK_LIT_STR_DOUBLE) {
+            if (CURRENT_TYPE(S) != GRAMINA_TOK_LIT_STR_DOUBLE) {
                 SET_ERR(S, mk_str_c("expected string literal"));
 
-                array_foreach_ref(_GraminaSymAttr, _, attr, attribs) {
-                    symattr_free(attr);
-                }
-
                 array_free(_GraminaSymAttr, &attribs);
                 return NULL;
             }
 
-            contents = str_as_view(&CURRENT(S).contents);
+            contents = CURRENT(S).contents;
             CONSUME(S);
 
-            if (CURRENT(S).type != GRAMINA_TOK_PAREN_RIGHT) {
+            if (CURRENT_TYPE(S) != GRAMINA_TOK_PAREN_RIGHT) {
                 SET_ERR(S, mk_str_c("expected ')'"));
 
-                array_foreach_ref(_GraminaSymAttr, _, attr, attribs) {
-                    symattr_free(attr);
-                }
-
                 array_free(_GraminaSymAttr, &attribs);
                 return NULL;
             }
@@ -493,15 +493,10 @@ static AstNode *global_statement(ParserState *S) {
             CONSUME(S);
         }
 
-        StringView attrib_name = str_as_view(&attrib_tok->contents);
         SymbolAttributeKind kind = get_attrib_kind(&attrib_name);
         if (kind == GRAMINA_ATTRIBUTE_NONE) {
             SET_ERR(S, str_cfmt("unknown attribute '{sv}'", &attrib_name));
 
-            array_foreach_ref(_GraminaSymAttr, _, attr, attribs) {
-                symattr_free(attr);
-            }
-
             array_free(_GraminaSymAttr, &attribs);
             return NULL;
         }
@@ -515,13 +510,18 @@ static AstNode *global_statement(ParserState *S) {
         };
 
         if (contents.data) {
-            attrib.string = sv_dup(&contents);
+            StringView dup = arena_sv_dup(S, &contents);
+            attrib.string = (String) {
+                .length = dup.length,
+                .capacity = dup.length,
+                .data = (char *)dup.data,
+            };
         }
 
         array_append(_GraminaSymAttr, &attribs, attrib);
     }
 
-    switch (CURRENT(S).type) {
+    switch (CURRENT_TYPE(S)) {
     case GRAMINA_TOK_KW_FN: {
         AstNode *def = function_def(S);
         if (!def) {
@@ -529,19 +529,15 @@ static AstNode *global_statement(ParserState *S) {
                 SET_ERR(S, mk_str_c("expected function definition"));
             }
 
-            array_foreach_ref(_GraminaSymAttr, _, attr, attribs) {
-                symattr_free(attr);
-            }
-
             array_free(_GraminaSymAttr, &attribs);
             return NULL;
         }
 
-        AstNode *this = mk_ast_node_lr(NULL, def, NULL);
+        AstNode *this = mk_ast_node_lr(S->arena, NULL, def, NULL);
         this->type = GRAMINA_AST_GLOBAL_STATEMENT;
         this->pos = def->pos;
 
-        def->value.attributes = attribs;
+        def->value.attributes = arena_attributes(S, &attribs);
 
         return this;
     }
@@ -552,19 +548,15 @@ static AstNode *global_statement(ParserState *S) {
                 SET_ERR(S, mk_str_c("expected struct definition"));
             }
 
-            array_foreach_ref(_GraminaSymAttr, _, attr, attribs) {
-                symattr_free(attr);
-            }
-
             array_free(_GraminaSymAttr, &attribs);
             return NULL;
         }
 
-        AstNode *this = mk_ast_node_lr(NULL, def, NULL);
+        AstNode *this = mk_ast_node_lr(S->arena, NULL, def, NULL);
         this->type = GRAMINA_AST_STRUCT_DEF;
         this->pos = def->pos;
 
-        def->value.attributes = attribs;
+        def->value.attributes = arena_attributes(S, &attribs);
 
         return this;
     }
@@ -572,10 +564,6 @@ static AstNode *global_statement(ParserState *S) {
         break;
     }
 
-    array_foreach_ref(_GraminaSymAttr, _, attr, attribs) {
-        symattr_free(attr);
-    }
-
     array_free(_GraminaSymAttr, &attribs);
 
     if (!HAS_ERR(S)) {
@@ -591,28 +579,26 @@ static AstNode *expression(ParserState *S) {
 }
 
 static AstNode *expression_statement(ParserState *S) {
-    if (CURRENT(S).type == GRAMINA_TOK_SEMICOLON) {
+    if (CURRENT_TYPE(S) == GRAMINA_TOK_SEMICOLON) {
         CONSUME(S);
         return NULL;
     }
 
     AstNode *expr = expression(S);
     if (HAS_ERR(S)) {
-        ast_node_free(expr);
         return NULL;
     }
 
-    TokenPosition semicolon_pos = CURRENT(S).pos;
-    if (CURRENT(S).type != GRAMINA_TOK_SEMICOLON) {
+    TokenPosition semicolon_pos = CURRENT_POS(S);
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_SEMICOLON) {
         SET_ERR(S, mk_str_c("expected ';'"));
 
-        ast_node_free(expr);
         return NULL;
     }
 
     CONSUME(S);
 
-    AstNode *this = mk_ast_node_lr(NULL, expr, NULL);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, expr, NULL);
     this->type = GRAMINA_AST_EXPRESSION_STATEMENT;
     this->pos = expr
               ? expr->pos
@@ -623,6 +609,7 @@ static AstNode *expression_statement(ParserState *S) {
 
 static AstNode *typename(ParserState *S);
 static AstNode *identifier(ParserState *S);
+static bool at_vector_length(ParserState *S, size_t n);
 static AstNode *declaration_statement(ParserState *S) {
     AstNode *type = typename(S);
     if (!type) {
@@ -637,17 +624,16 @@ static AstNode *declaration_statement(ParserState *S) {
     if (!ident) {
         SET_ERR(S, mk_str_c("expected identifier"));
 
-        ast_node_free(type);
         return NULL;
     }
 
-    AstNode *this = mk_ast_node_lr(NULL, ident, NULL);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, ident, NULL);
     this->type = GRAMINA_AST_DECLARATION_STATEMENT;
     this->pos = type->pos;
 
     ast_node_child_l(ident, type);
 
-    if (CURRENT(S).type == GRAMINA_TOK_ASSIGN) {
+    if (CURRENT_TYPE(S) == GRAMINA_TOK_ASSIGN) {
         CONSUME(S);
 
         AstNode *expr = expression(S);
@@ -656,16 +642,14 @@ static AstNode *declaration_statement(ParserState *S) {
                 SET_ERR(S, mk_str_c("expected expression"));
             }
 
-            ast_node_free(this);
             return NULL;
         }
 
         ast_node_child_r(ident, expr);
     }
 
-    if (CURRENT(S).type != GRAMINA_TOK_SEMICOLON) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_SEMICOLON) {
         SET_ERR(S, mk_str_c("expected ';'"));
-        ast_node_free(this);
         return NULL;
     }
 
@@ -675,17 +659,17 @@ static AstNode *declaration_statement(ParserState *S) {
 }
 
 static AstNode *return_statement(ParserState *S) {
-    TokenPosition pos = CURRENT(S).pos;
-    if (CURRENT(S).type != GRAMINA_TOK_KW_RETURN) {
+    TokenPosition pos = CURRENT_POS(S);
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_KW_RETURN) {
         SET_ERR(S, mk_str_c("expected 'return'"));
         return NULL;
     }
 
     CONSUME(S);
 
-    if (CURRENT(S).type == GRAMINA_TOK_SEMICOLON) {
+    if (CURRENT_TYPE(S) == GRAMINA_TOK_SEMICOLON) {
         CONSUME(S);
-        AstNode *this = mk_ast_node(NULL);
+        AstNode *this = mk_ast_node(S->arena, NULL);
         this->type = GRAMINA_AST_RETURN_STATEMENT;
         this->pos = pos;
 
@@ -701,16 +685,15 @@ static AstNode *return_statement(ParserState *S) {
         return NULL;
     }
 
-    if (CURRENT(S).type != GRAMINA_TOK_SEMICOLON) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_SEMICOLON) {
         SET_ERR(S, mk_str_c("expected ';'"));
 
-        ast_node_free(expr);
         return NULL;
     }
 
     CONSUME(S);
 
-    AstNode *this = mk_ast_node_lr(NULL, expr, NULL);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, expr, NULL);
     this->type = GRAMINA_AST_RETURN_STATEMENT;
     this->pos = pos;
 
@@ -718,7 +701,7 @@ static AstNode *return_statement(ParserState *S) {
 }
 
 static AstNode *statement_block(ParserState *S) {
-    if (CURRENT(S).type != GRAMINA_TOK_BRACE_LEFT) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_BRACE_LEFT) {
         SET_ERR(S, mk_str_c("expected '{'"));
         return NULL;
     }
@@ -730,7 +713,7 @@ static AstNode *statement_block(ParserState *S) {
         return NULL;
     }
 
-    if (CURRENT(S).type != GRAMINA_TOK_BRACE_RIGHT) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_BRACE_RIGHT) {
         SET_ERR(S, mk_str_c("expected '}'"));
 
         return NULL;
@@ -742,8 +725,8 @@ static AstNode *statement_block(ParserState *S) {
 }
 
 static AstNode *if_statement(ParserState *S) {
-    TokenPosition pos = CURRENT(S).pos;
-    if (CURRENT(S).type != GRAMINA_TOK_KW_IF) {
+    TokenPosition pos = CURRENT_POS(S);
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_KW_IF) {
         SET_ERR(S, mk_str_c("expected 'if'"));
         return NULL;
     }
@@ -757,36 +740,35 @@ static AstNode *if_statement(ParserState *S) {
 
     AstNode *body = statement_block(S);
     if (HAS_ERR(S)) {
-        ast_node_free(cond);
         return NULL;
     }
 
     AstNode *else_clause = NULL;
-    if (CURRENT(S).type == GRAMINA_TOK_KW_ELSE) {
-        TokenPosition else_pos = CURRENT(S).pos;
+    if (CURRENT_TYPE(S) == GRAMINA_TOK_KW_ELSE) {
+        TokenPosition else_pos = CURRENT_POS(S);
         CONSUME(S);
 
-        if (CURRENT(S).type == GRAMINA_TOK_KW_IF) {
+        if (CURRENT_TYPE(S) == GRAMINA_TOK_KW_IF) {
             AstNode *else_if = if_statement(S);
-            else_clause = mk_ast_node_lr(NULL, else_if, NULL);
+            else_clause = mk_ast_node_lr(S->arena, NULL, else_if, NULL);
         } else {
             AstNode *else_body = statement_block(S);
-            else_clause = mk_ast_node_lr(NULL, else_body, NULL);
+            else_clause = mk_ast_node_lr(S->arena, NULL, else_body, NULL);
         }
 
         else_clause->type = GRAMINA_AST_ELSE_CLAUSE;
         else_clause->pos = else_pos;
     }
 
-    AstNode *linker = mk_ast_node_lr(NULL, body, else_clause);
+    AstNode *linker = mk_ast_node_lr(S->arena, NULL, body, else_clause);
     linker->type = GRAMINA_AST_CONTROL_FLOW;
     linker->pos = pos;
 
-    AstNode *this = mk_ast_node_lr(NULL, cond, linker);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, cond, linker);
     this->type = GRAMINA_AST_IF_STATEMENT;
     this->pos = pos;
 
-    AstNode *wrapper = mk_ast_node_lr(NULL, this, NULL);
+    AstNode *wrapper = mk_ast_node_lr(S->arena, NULL, this, NULL);
     wrapper->type = GRAMINA_AST_CONTROL_FLOW;
     wrapper->pos = pos;
 
@@ -794,8 +776,8 @@ static AstNode *if_statement(ParserState *S) {
 }
 
 static AstNode *for_statement(ParserState *S) {
-    TokenPosition pos = CURRENT(S).pos;
-    if (CURRENT(S).type != GRAMINA_TOK_KW_FOR) {
+    TokenPosition pos = CURRENT_POS(S);
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_KW_FOR) {
         SET_ERR(S, mk_str_c("expected 'for'"));
         return NULL;
     }
@@ -803,7 +785,7 @@ static AstNode *for_statement(ParserState *S) {
     CONSUME(S);
 
     AstNode *decl = NULL;
-    if (CURRENT(S).type != GRAMINA_TOK_SEMICOLON) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_SEMICOLON) {
         decl = declaration_statement(S);
         if (HAS_ERR(S)) {
             return NULL;
@@ -813,10 +795,9 @@ static AstNode *for_statement(ParserState *S) {
     }
 
     AstNode *cond = NULL;
-    if (CURRENT(S).type != GRAMINA_TOK_SEMICOLON) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_SEMICOLON) {
         cond = expression(S);
         if (HAS_ERR(S)) {
-            ast_node_free(decl);
             return NULL;
         }
     }
@@ -824,28 +805,22 @@ static AstNode *for_statement(ParserState *S) {
     CONSUME(S);
 
     AstNode *incr = NULL;
-    if (CURRENT(S).type != GRAMINA_TOK_BRACE_LEFT) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_BRACE_LEFT) {
         incr = expression(S);
         if (HAS_ERR(S)) {
-            ast_node_free(decl);
-            ast_node_free(cond);
             return NULL;
         }
     }
 
     AstNode *body = statement_block(S);
     if (HAS_ERR(S)) {
-        ast_node_free(decl);
-        ast_node_free(cond);
-        ast_node_free(incr);
-
         return NULL;
     }
 
-    AstNode *st_condition = mk_ast_node_lr(NULL, cond, incr);
-    AstNode *st_declaration = mk_ast_node_lr(NULL, decl, st_condition);
-    AstNode *this = mk_ast_node_lr(NULL, st_declaration, body);
-    AstNode *wrapper = mk_ast_node_lr(NULL, this, NULL);
+    AstNode *st_condition = mk_ast_node_lr(S->arena, NULL, cond, incr);
+    AstNode *st_declaration = mk_ast_node_lr(S->arena, NULL, decl, st_condition);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, st_declaration, body);
+    AstNode *wrapper = mk_ast_node_lr(S->arena, NULL, this, NULL);
 
     st_condition->type = GRAMINA_AST_EXPRESSION_STATEMENT;
     st_declaration->type = GRAMINA_AST_DECLARATION_STATEMENT;
@@ -860,9 +835,73 @@ static AstNode *for_statement(ParserState *S) {
     return wrapper;
 }
 
+// The iterated expression sits where a declaration keeps its initialiser
+static AstNode *foreach_statement(ParserState *S) {
+    TokenPosition pos = CURRENT_POS(S);
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_KW_FOREACH) {
+        SET_ERR(S, mk_str_c("expected 'foreach'"));
+        return NULL;
+    }
+
+    CONSUME(S);
+
+    AstNode *type = typename(S);
+    if (!type) {
+        if (!HAS_ERR(S)) {
+            SET_ERR(S, mk_str_c("expected typename"));
+        }
+
+        return NULL;
+    }
+
+    AstNode *ident = identifier(S);
+    if (!ident) {
+        SET_ERR(S, mk_str_c("expected identifier"));
+        return NULL;
+    }
+
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_COLON) {
+        SET_ERR(S, mk_str_c("expected ':'"));
+        return NULL;
+    }
+
+    CONSUME(S);
+
+    AstNode *iterated = expression(S);
+    if (!iterated) {
+        if (!HAS_ERR(S)) {
+            SET_ERR(S, mk_str_c("expected expression"));
+        }
+
+        return NULL;
+    }
+
+    AstNode *body = statement_block(S);
+    if (HAS_ERR(S)) {
+        return NULL;
+    }
+
+    ast_node_child_l(ident, type);
+    ast_node_child_r(ident, iterated);
+
+    AstNode *st_declaration = mk_ast_node_lr(S->arena, NULL, ident, NULL);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, st_declaration, body);
+    AstNode *wrapper = mk_ast_node_lr(S->arena, NULL, this, NULL);
+
+    st_declaration->type = GRAMINA_AST_DECLARATION_STATEMENT;
+    this->type = GRAMINA_AST_FOREACH_STATEMENT;
+    wrapper->type = GRAMINA_AST_CONTROL_FLOW;
+
+    st_declaration->pos = type->pos;
+    this->pos = pos;
+    wrapper->pos = pos;
+
+    return wrapper;
+}
+
 static AstNode *while_statement(ParserState *S) {
-    TokenPosition pos = CURRENT(S).pos;
-    if (CURRENT(S).type != GRAMINA_TOK_KW_WHILE) {
+    TokenPosition pos = CURRENT_POS(S);
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_KW_WHILE) {
         SET_ERR(S, mk_str_c("expected 'while'"));
         return NULL;
     }
@@ -876,15 +915,14 @@ static AstNode *while_statement(ParserState *S) {
 
     AstNode *body = statement_block(S);
     if (HAS_ERR(S)) {
-        ast_node_free(exp);
         return NULL;
     }
 
-    AstNode *this = mk_ast_node_lr(NULL, exp, body);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, exp, body);
     this->type = GRAMINA_AST_WHILE_STATEMENT;
     this->pos = pos;
 
-    AstNode *wrapper = mk_ast_node_lr(NULL, this, NULL);
+    AstNode *wrapper = mk_ast_node_lr(S->arena, NULL, this, NULL);
     wrapper->type = GRAMINA_AST_CONTROL_FLOW;
     wrapper->pos = pos;
 
@@ -892,15 +930,24 @@ static AstNode *while_statement(ParserState *S) {
 }
 
 static AstNode *statement(ParserState *S) {
-    switch (CURRENT(S).type) {
+    switch (CURRENT_TYPE(S)) {
     case GRAMINA_TOK_KW_RETURN:
         return return_statement(S);
     case GRAMINA_TOK_KW_FOR:
         return for_statement(S);
+    case GRAMINA_TOK_KW_FOREACH:
+        return foreach_statement(S);
     case GRAMINA_TOK_KW_WHILE:
         return while_statement(S);
     case GRAMINA_TOK_KW_IF:
         return if_statement(S);
+    case GRAMINA_TOK_IDENTIFIER:
+        // `float<8> v` would otherwise parse as a chain of comparisons
+        if (at_vector_length(S, 1)) {
+            return declaration_statement(S);
+        }
+
+        break;
     default:
         break;
     }
@@ -918,15 +965,15 @@ static AstNode *statement(ParserState *S) {
 }
 
 static AstNode *lit_bool(ParserState *S) {
-    if (CURRENT(S).type != GRAMINA_TOK_KW_TRUE
-     && CURRENT(S).type != GRAMINA_TOK_KW_FALSE) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_KW_TRUE
+     && CURRENT_TYPE(S) != GRAMINA_TOK_KW_FALSE) {
         return NULL;
     }
 
-    AstNode *this = mk_ast_node(NULL);
+    AstNode *this = mk_ast_node(S->arena, NULL);
     this->type = GRAMINA_AST_VAL_BOOL;
-    this->pos = CURRENT(S).pos;
-    this->value.logical = CURRENT(S).type == GRAMINA_TOK_KW_TRUE;
+    this->pos = CURRENT_POS(S);
+    this->value.logical = CURRENT_TYPE(S) == GRAMINA_TOK_KW_TRUE;
 
     CONSUME(S);
 
@@ -939,32 +986,32 @@ static AstNode *lit_number(ParserState *S) {
 
     switch (cur.type) {
     case GRAMINA_TOK_LIT_F32:
-        this = mk_ast_node(NULL);
+        this = mk_ast_node(S->arena, NULL);
         this->type = GRAMINA_AST_VAL_F32;
         this->value.f32 = cur.data.f32;
         break;
     case GRAMINA_TOK_LIT_F64:
-        this = mk_ast_node(NULL);
+        this = mk_ast_node(S->arena, NULL);
         this->type = GRAMINA_AST_VAL_F64;
         this->value.f64 = cur.data.f64;
         break;
     case GRAMINA_TOK_LIT_I32:
-        this = mk_ast_node(NULL);
+        this = mk_ast_node(S->arena, NULL);
         this->type = GRAMINA_AST_VAL_I32;
         this->value.i32 = cur.data.i32;
         break;
     case GRAMINA_TOK_LIT_U32:
-        this = mk_ast_node(NULL);
+        this = mk_ast_node(S->arena, NULL);
         this->type = GRAMINA_AST_VAL_U32;
         this->value.u32 = cur.data.u32;
         break;
     case GRAMINA_TOK_LIT_I64:
-        this = mk_ast_node(NULL);
+        this = mk_ast_node(S->arena, NULL);
         this->type = GRAMINA_AST_VAL_I64;
         this->value.i64 = cur.data.i64;
         break;
     case GRAMINA_TOK_LIT_U64:
-        this = mk_ast_node(NULL);
+        this = mk_ast_node(S->arena, NULL);
         this->type = GRAMINA_AST_VAL_U64;
         this->value.u64 = cur.data.u64;
         break;
@@ -984,14 +1031,14 @@ static AstNode *lit_quoted(ParserState *S) {
 
     switch (cur.type) {
     case GRAMINA_TOK_LIT_STR_SINGLE:
-        this = mk_ast_node(NULL);
+        this = mk_ast_node(S->arena, NULL);
         this->type = GRAMINA_AST_VAL_CHAR;
         this->value._char = cur.data._char;
         break;
     case GRAMINA_TOK_LIT_STR_DOUBLE:
-        this = mk_ast_node(NULL);
+        this = mk_ast_node(S->arena, NULL);
         this->type = GRAMINA_AST_VAL_STRING;
-        this->value.string = str_dup(&cur.contents);
+        this->value.string = arena_sv_dup(S, &cur.contents);
         break;
     default:
         return NULL;
@@ -1004,10 +1051,10 @@ static AstNode *lit_quoted(ParserState *S) {
 }
 
 static AstNode *keyword_op(ParserState *S) {
-    TokenPosition pos = CURRENT(S).pos;
+    TokenPosition pos = CURRENT_POS(S);
 
     AstNodeType op;
-    switch (CURRENT(S).type) {
+    switch (CURRENT_TYPE(S)) {
     case GRAMINA_TOK_KW_SIZEOF:
         op = GRAMINA_AST_OP_SIZEOF;
         break;
@@ -1021,7 +1068,7 @@ static AstNode *keyword_op(ParserState *S) {
     CONSUME(S);
 
     AstNode *typ = typename(S);
-    AstNode *node = mk_ast_node_lr(NULL, typ, NULL);
+    AstNode *node = mk_ast_node_lr(S->arena, NULL, typ, NULL);
     node->type = op;
     node->pos = pos;
 
@@ -1036,27 +1083,17 @@ static AstNode *identifier(ParserState *S) {
         return NULL;
     }
 
-    AstNode *node = mk_ast_node(NULL);
+    AstNode *node = mk_ast_node(S->arena, NULL);
     node->type = GRAMINA_AST_IDENTIFIER;
-    node->value.identifier = str_dup(&cur.contents);
+    node->value.identifier = cur.data.symbol;
     node->pos = cur.pos;
 
     CONSUME(S);
     return node;
 }
 
-static bool handle_array_type(ParserState *S, AstNode **cur, bool *const_next) {
-    *cur = mk_ast_node_lr(NULL, *cur, NULL);
-    (*cur)->type = GRAMINA_AST_TYPE_ARRAY;
-    (*cur)->pos = N_AFTER(S, -1).pos;
-
-    if (*const_next) {
-        (*cur)->flags |= GRAMINA_AST_CONST_TYPE;
-        *const_next = false;
-    }
-
-    const Token *tok = &CURRENT(S);
-
+// Returns false if the token is not a positive integer literal
+static bool positive_length(const Token *tok, uint64_t *length) {
     switch (tok->type) {
     case GRAMINA_TOK_LIT_U32:
     case GRAMINA_TOK_LIT_U64: {
@@ -1066,11 +1103,11 @@ static bool handle_array_type(ParserState *S, AstNode **cur, bool *const_next) {
 
         // This check is necessary since length could be `0`, which passes all other checks
         if (n <= 0) {
-            goto err;
+            return false;
         }
 
-        (*cur)->value.array_length = n;
-        break;
+        *length = n;
+        return true;
     }
     case GRAMINA_TOK_LIT_I32:
     case GRAMINA_TOK_LIT_I64: {
@@ -1080,22 +1117,36 @@ static bool handle_array_type(ParserState *S, AstNode **cur, bool *const_next) {
 
         // This check is necessary since length could be `0`, which passes all other checks
         if (n <= 0) {
-            goto err;
+            return false;
         }
 
-        (*cur)->value.array_length = n;
-        break;
+        *length = n;
+        return true;
     }
-
-    err:
     default:
+        return false;
+    }
+}
+
+static bool handle_array_type(ParserState *S, AstNode **cur, bool *const_next) {
+    *cur = mk_ast_node_lr(S->arena, NULL, *cur, NULL);
+    (*cur)->type = GRAMINA_AST_TYPE_ARRAY;
+    (*cur)->pos = N_AFTER_POS(S, -1);
+
+    if (*const_next) {
+        (*cur)->flags |= GRAMINA_AST_CONST_TYPE;
+        *const_next = false;
+    }
+
+    Token cur_tok = CURRENT(S);
+    if (!positive_length(&cur_tok, &(*cur)->value.array_length)) {
         SET_ERR(S, mk_str_c("array length must be a positive integer literal"));
         return true;
     }
 
     CONSUME(S);
 
-    if (CURRENT(S).type != GRAMINA_TOK_SUBSCRIPT_RIGHT) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_SUBSCRIPT_RIGHT) {
         SET_ERR(S, mk_str_c("unterminated '['"));
         return true;
     }
@@ -1105,18 +1156,61 @@ static bool handle_array_type(ParserState *S, AstNode **cur, bool *const_next) {
     return false;
 }
 
+/**
+ * Whether `<N>` starts `n` tokens ahead. Anything else after a type name is
+ * left alone, so `sizeof int < x` still compares.
+ */
+static bool at_vector_length(ParserState *S, size_t n) {
+    if (N_AFTER_TYPE(S, n) != GRAMINA_TOK_LESS_THAN) {
+        return false;
+    }
+
+    switch (N_AFTER_TYPE(S, n + 1)) {
+    case GRAMINA_TOK_LIT_I32:
+    case GRAMINA_TOK_LIT_U32:
+    case GRAMINA_TOK_LIT_I64:
+    case GRAMINA_TOK_LIT_U64:
+        return N_AFTER_TYPE(S, n + 2) == GRAMINA_TOK_GREATER_THAN;
+    default:
+        return false;
+    }
+}
+
+static AstNode *vector_type(ParserState *S, AstNode *lane) {
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, lane, NULL);
+    this->type = GRAMINA_AST_TYPE_VECTOR;
+    this->pos = CURRENT_POS(S);
+
+    // Constness belongs to the whole vector
+    this->flags |= lane->flags & GRAMINA_AST_CONST_TYPE;
+    lane->flags &= ~GRAMINA_AST_CONST_TYPE;
+
+    CONSUME(S);
+
+    Token cur_tok = CURRENT(S);
+    if (!positive_length(&cur_tok, &this->value.array_length)) {
+        SET_ERR(S, mk_str_c("vector length must be a positive integer literal"));
+        return NULL;
+    }
+
+    CONSUME(S);
+    CONSUME(S);
+
+    return this;
+}
+
 static AstNode *typename(ParserState *S) {
     bool const_next = false;
 
-    if (CURRENT(S).type == GRAMINA_TOK_KW_CONST) {
+    if (CURRENT_TYPE(S) == GRAMINA_TOK_KW_CONST) {
         const_next = true;
         CONSUME(S);
     }
 
-    if (CURRENT(S).type == GRAMINA_TOK_DOLLAR) {
-        AstNode *this = mk_ast_node(NULL);
+    if (CURRENT_TYPE(S) == GRAMINA_TOK_DOLLAR) {
+        AstNode *this = mk_ast_node(S->arena, NULL);
         this->type = GRAMINA_AST_REFLECT;
-        this->pos = CURRENT(S).pos;
+        this->pos = CURRENT_POS(S);
         if (const_next) {
             this->flags |= GRAMINA_AST_CONST_TYPE;
         }
@@ -1137,19 +1231,26 @@ static AstNode *typename(ParserState *S) {
 
     const_next = false;
 
+    if (at_vector_length(S, 0)) {
+        cur = vector_type(S, cur);
+        if (!cur) {
+            return NULL;
+        }
+    }
+
     bool loop = true;
     while (loop) {
-        switch (CURRENT(S).type) {
+        switch (CURRENT_TYPE(S)) {
         case GRAMINA_TOK_KW_CONST:
             const_next = true;
             CONSUME(S);
             break;
         case GRAMINA_TOK_AMPERSAND:
         case GRAMINA_TOK_AND:
-            for (size_t i = 0; i < (CURRENT(S).type == GRAMINA_TOK_AND ? 2 : 1); ++i) {
-                cur = mk_ast_node_lr(NULL, cur, NULL);
+            for (size_t i = 0; i < (CURRENT_TYPE(S) == GRAMINA_TOK_AND ? 2 : 1); ++i) {
+                cur = mk_ast_node_lr(S->arena, NULL, cur, NULL);
                 cur->type = GRAMINA_AST_TYPE_POINTER;
-                cur->pos = CURRENT(S).pos;
+                cur->pos = CURRENT_POS(S);
 
                 if (const_next) {
                     cur->flags |= GRAMINA_AST_CONST_TYPE;
@@ -1161,11 +1262,11 @@ static AstNode *typename(ParserState *S) {
             break;
         case GRAMINA_TOK_SUBSCRIPT_LEFT:
             CONSUME(S);
-            switch (CURRENT(S).type) {
+            switch (CURRENT_TYPE(S)) {
             case GRAMINA_TOK_SUBSCRIPT_RIGHT:
-                cur = mk_ast_node_lr(NULL, cur, NULL);
+                cur = mk_ast_node_lr(S->arena, NULL, cur, NULL);
                 cur->type = GRAMINA_AST_TYPE_SLICE;
-                cur->pos = N_AFTER(S, -1).pos;
+                cur->pos = N_AFTER_POS(S, -1);
 
                 if (const_next) {
                     cur->flags |= GRAMINA_AST_CONST_TYPE;
@@ -1179,7 +1280,6 @@ static AstNode *typename(ParserState *S) {
             case GRAMINA_TOK_LIT_I64:
             case GRAMINA_TOK_LIT_U64:
                 if (handle_array_type(S, &cur, &const_next)) {
-                    ast_node_free(cur);
                     return NULL;
                 }
 
@@ -1187,7 +1287,6 @@ static AstNode *typename(ParserState *S) {
             default:
                 SET_ERR(S, mk_str_c("expected ']' or integer literal"));
 
-                ast_node_free(cur);
                 return NULL;
             }
 
@@ -1202,7 +1301,7 @@ static AstNode *typename(ParserState *S) {
 }
 
 static AstNode *value(ParserState *S) {
-    switch (CURRENT(S).type) {
+    switch (CURRENT_TYPE(S)) {
     case GRAMINA_TOK_LIT_F32:
     case GRAMINA_TOK_LIT_F64:
     case GRAMINA_TOK_LIT_I32:
@@ -1228,8 +1327,8 @@ static AstNode *value(ParserState *S) {
 }
 
 static AstNode *cast(ParserState *S) {
-    TokenPosition pos = CURRENT(S).pos;
-    if (CURRENT(S).type != GRAMINA_TOK_BACKSLASH) {
+    TokenPosition pos = CURRENT_POS(S);
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_BACKSLASH) {
         SET_ERR(S, mk_str_c("expected '\\'"));
         return NULL;
     }
@@ -1241,10 +1340,9 @@ static AstNode *cast(ParserState *S) {
         return NULL;
     }
 
-    if (CURRENT(S).type != GRAMINA_TOK_PAREN_LEFT) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_PAREN_LEFT) {
         SET_ERR(S, mk_str_c("expected '('"));
 
-        ast_node_free(into);
         return NULL;
     }
 
@@ -1252,20 +1350,18 @@ static AstNode *cast(ParserState *S) {
 
     AstNode *expr = expression(S);
     if (!expr) {
-        ast_node_free(into);
         return NULL;
     }
 
-    if (CURRENT(S).type != GRAMINA_TOK_PAREN_RIGHT) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_PAREN_RIGHT) {
         SET_ERR(S, mk_str_c("expected ')'"));
 
-        ast_node_free(into);
         return NULL;
     }
 
     CONSUME(S);
 
-    AstNode *this = mk_ast_node_lr(NULL, into, expr);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, into, expr);
     this->type = GRAMINA_AST_OP_CAST;
     this->pos = pos;
 
@@ -1280,7 +1376,7 @@ static AstNode *factor(ParserState *S) {
 
     CLEAR_ERR(S);
 
-    switch (CURRENT(S).type) {
+    switch (CURRENT_TYPE(S)) {
     case GRAMINA_TOK_BACKSLASH:
         return cast(S);
     case GRAMINA_TOK_PAREN_LEFT:
@@ -1298,10 +1394,9 @@ static AstNode *factor(ParserState *S) {
         return NULL;
     }
 
-    if (CURRENT(S).type != GRAMINA_TOK_PAREN_RIGHT) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_PAREN_RIGHT) {
         SET_ERR(S, mk_str_c("expected ')'"));
 
-        ast_node_free(expr_node);
         return NULL;
     }
 
@@ -1311,7 +1406,7 @@ static AstNode *factor(ParserState *S) {
 }
 
 static AstNode *expression_list_pr(ParserState *S) {
-    if (CURRENT(S).type != GRAMINA_TOK_COMMA) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_COMMA) {
         return NULL;
     }
 
@@ -1327,14 +1422,13 @@ static AstNode *expression_list_pr(ParserState *S) {
     AstNode *after = expression_list_pr(S);
     if (!after) {
         if (HAS_ERR(S)) {
-            ast_node_free(expr);
             return NULL;
         }
 
         return expr;
     }
 
-    AstNode *this = mk_ast_node_lr(NULL, expr, after);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, expr, after);
     this->type = GRAMINA_AST_EXPRESSION_LIST;
     this->pos = expr->pos;
 
@@ -1347,28 +1441,27 @@ static AstNode *expression_list(ParserState *S) {
         return NULL;
     }
 
-    if (CURRENT(S).type != GRAMINA_TOK_COMMA) {
+    if (CURRENT_TYPE(S) != GRAMINA_TOK_COMMA) {
         return expr;
     }
 
     AstNode *list = expression_list_pr(S);
     if (!list && HAS_ERR(S)) {
-        ast_node_free(expr);
-
         return NULL;
     }
 
-    AstNode *this = mk_ast_node_lr(NULL, expr, list);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, expr, list);
     this->type = GRAMINA_AST_EXPRESSION_LIST;
     this->pos = expr->pos;
 
     return this;
 }
 
-static AstNode *access_exp_pr(ParserState *S) {
+// Returns the innermost access node, `*top` receives the outermost one
+static AstNode *access_exp_pr(ParserState *S, AstNode **top) {
     AstNodeType typ;
 
-    switch (CURRENT(S).type) {
+    switch (CURRENT_TYPE(S)) {
     case GRAMINA_TOK_STATIC_MEMBER:
         typ = GRAMINA_AST_OP_STATIC_MEMBER;
         break;
@@ -1388,7 +1481,7 @@ static AstNode *access_exp_pr(ParserState *S) {
         return NULL;
     }
 
-    TokenPosition pos = CURRENT(S).pos;
+    TokenPosition pos = CURRENT_POS(S);
 
     CONSUME(S);
 
@@ -1407,7 +1500,7 @@ static AstNode *access_exp_pr(ParserState *S) {
         break;
     }
     case GRAMINA_AST_OP_CALL: {
-        if (CURRENT(S).type == GRAMINA_TOK_PAREN_RIGHT) {
+        if (CURRENT_TYPE(S) == GRAMINA_TOK_PAREN_RIGHT) {
             CONSUME(S);
 
             right = NULL;
@@ -1419,9 +1512,7 @@ static AstNode *access_exp_pr(ParserState *S) {
             return NULL;
         }
 
-        if (CURRENT(S).type != GRAMINA_TOK_PAREN_RIGHT) {
-            ast_node_free(params);
-
+        if (CURRENT_TYPE(S) != GRAMINA_TOK_PAREN_RIGHT) {
             SET_ERR(S, mk_str_c("expected ')'"));
 
             return NULL;
@@ -1438,10 +1529,9 @@ static AstNode *access_exp_pr(ParserState *S) {
             return NULL;
         }
 
-        if (CURRENT(S).type != GRAMINA_TOK_SUBSCRIPT_RIGHT) {
+        if (CURRENT_TYPE(S) != GRAMINA_TOK_SUBSCRIPT_RIGHT) {
             SET_ERR(S, mk_str_c("expected ']'"));
 
-            ast_node_free(params);
             return NULL;
         }
 
@@ -1454,11 +1544,15 @@ static AstNode *access_exp_pr(ParserState *S) {
         return NULL;
     }
 
-    AstNode *parent = access_exp_pr(S);
-    AstNode *this = mk_ast_node_lr(parent, NULL, right);
+    AstNode *parent = access_exp_pr(S, top);
+    AstNode *this = mk_ast_node_lr(S->arena, parent, NULL, right);
     this->type = typ;
     this->pos = pos;
 
+    if (!parent) {
+        *top = this;
+    }
+
     return this;
 }
 
@@ -1468,10 +1562,10 @@ static AstNode *access_exp(ParserState *S) {
         return NULL;
     }
 
-    AstNode *lowest = access_exp_pr(S);
+    AstNode *top = NULL;
+    AstNode *lowest = access_exp_pr(S, &top);
     if (!lowest) {
         if (HAS_ERR(S)) {
-            ast_node_free(from);
             return NULL;
         }
 
@@ -1480,11 +1574,6 @@ static AstNode *access_exp(ParserState *S) {
 
     ast_node_child_l(lowest, from);
 
-    AstNode *top = lowest;
-    while (top->parent) {
-        top = top->parent;
-    }
-
     return top;
 }
 
@@ -1513,7 +1602,7 @@ static AstNode *evaluative_exp_pr(ParserState *S, AstNode *higher_tree, AstNodeT
         return higher_tree;
     }
 
-    AstNode *this = mk_ast_node_lr(NULL, subtree, NULL);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, subtree, NULL);
     this->type = subtyp;
     this->pos = cur.pos;
 
@@ -1532,7 +1621,7 @@ static AstNode *evaluative_exp(ParserState *S) {
         return higher_tree;
     }
 
-    AstNode *this = mk_ast_node_lr(NULL, subtree, NULL);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, subtree, NULL);
     this->type = typ;
 
     return this;
@@ -1541,7 +1630,7 @@ static AstNode *evaluative_exp(ParserState *S) {
 static AstNode *unary_exp(ParserState *S) {
     AstNodeType typ = GRAMINA_AST_INVALID;
 
-    switch (CURRENT(S).type) {
+    switch (CURRENT_TYPE(S)) {
     case GRAMINA_TOK_PLUS:
         typ = GRAMINA_AST_OP_UNARY_PLUS;
         break;
@@ -1568,11 +1657,11 @@ static AstNode *unary_exp(ParserState *S) {
         return evaluative_exp(S);
     }
 
-    TokenPosition pos = CURRENT(S).pos;
+    TokenPosition pos = CURRENT_POS(S);
     CONSUME(S);
 
     AstNode *next_op = unary_exp(S);
-    AstNode *this = mk_ast_node_lr(NULL, next_op, NULL);
+    AstNode *this = mk_ast_node_lr(S->arena, NULL, next_op, NULL);
     this->type = typ;
     this->pos = pos;
 
@@ -0,0 +1,384 @@
+#define GRAMINA_NO_NAMESPACE
+
+#include <stdint.h>
+
+#include "parser/scan.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#  define GRAMINA_SCAN_X86
+#  include <immintrin.h>
+#endif
+
+typedef struct {
+    ScanBackend backend;
+    size_t (*whitespace)(const char *data, size_t length);
+    size_t (*word)(const char *data, size_t length);
+    size_t (*digits)(const char *data, size_t length);
+    size_t (*until)(const char *data, size_t length, char a, char b);
+    size_t (*newlines)(const char *data, size_t length, size_t *last);
+} ScanKernels;
+
+static bool is_whitespace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static bool is_word(char c) {
+    return (c >= 'a' && c <= 'z')
+        || (c >= 'A' && c <= 'Z')
+        || (c >= '0' && c <= '9')
+        || c == '_';
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool is_newline(char c) {
+    return c == '\n' || c == '\r';
+}
+
+static size_t scalar_whitespace(const char *data, size_t length) {
+    size_t i = 0;
+    while (i < length && is_whitespace(data[i])) {
+        ++i;
+    }
+
+    return i;
+}
+
+static size_t scalar_word(const char *data, size_t length) {
+    size_t i = 0;
+    while (i < length && is_word(data[i])) {
+        ++i;
+    }
+
+    return i;
+}
+
+static size_t scalar_digits(const char *data, size_t length) {
+    size_t i = 0;
+    while (i < length && is_digit(data[i])) {
+        ++i;
+    }
+
+    return i;
+}
+
+static size_t scalar_until(const char *data, size_t length, char a, char b) {
+    size_t i = 0;
+    while (i < length && data[i] != a && data[i] != b) {
+        ++i;
+    }
+
+    return i;
+}
+
+static size_t scalar_newlines(const char *data, size_t length, size_t *last) {
+    size_t count = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (is_newline(data[i])) {
+            ++count;
+            *last = i;
+        }
+    }
+
+    return count;
+}
+
+static const ScanKernels scalar_kernels = {
+    .backend = GRAMINA_SCAN_SCALAR,
+    .whitespace = scalar_whitespace,
+    .word = scalar_word,
+    .digits = scalar_digits,
+    .until = scalar_until,
+    .newlines = scalar_newlines,
+};
+
+#ifdef GRAMINA_SCAN_X86
+
+/**
+ * The vector kernels compute a bitmask of matching bytes per chunk, the first
+ * clear (or set) bit then gives the end of the run. Whatever is left after the
+ * last full chunk goes through the scalar kernels.
+ *
+ * Range checks use signed compares, bytes >= 0x80 are negative and never match.
+ */
+
+static uint32_t sse2_whitespace_mask(__m128i v) {
+    __m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    __m128i ctrl = _mm_and_si128(
+        _mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)),
+        _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1))
+    );
+
+    return _mm_movemask_epi8(_mm_or_si128(space, ctrl));
+}
+
+static uint32_t sse2_digit_mask(__m128i v) {
+    __m128i digit = _mm_and_si128(
+        _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+        _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1))
+    );
+
+    return _mm_movemask_epi8(digit);
+}
+
+static uint32_t sse2_word_mask(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i alpha = _mm_and_si128(
+        _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+        _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1))
+    );
+
+    __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+
+    return _mm_movemask_epi8(_mm_or_si128(alpha, underscore)) | sse2_digit_mask(v);
+}
+
+#define SSE2_RUN_KERNEL(name, mask_fn, scalar_fn) \
+static size_t name(const char *data, size_t length) { \
+    size_t i = 0; \
+    for (; i + 16 <= length; i += 16) { \
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + i)); \
+        uint32_t mask = mask_fn(v); \
+        if (mask != 0xFFFF) { \
+            return i + __builtin_ctz(~mask); \
+        } \
+    } \
+    \
+    return i + scalar_fn(data + i, length - i); \
+}
+
+SSE2_RUN_KERNEL(sse2_whitespace, sse2_whitespace_mask, scalar_whitespace)
+SSE2_RUN_KERNEL(sse2_word, sse2_word_mask, scalar_word)
+SSE2_RUN_KERNEL(sse2_digits, sse2_digit_mask, scalar_digits)
+
+static size_t sse2_until(const char *data, size_t length, char a, char b) {
+    __m128i va = _mm_set1_epi8(a);
+    __m128i vb = _mm_set1_epi8(b);
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+        uint32_t mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    return i + scalar_until(data + i, length - i, a, b);
+}
+
+static size_t sse2_newlines(const char *data, size_t length, size_t *last) {
+    __m128i lf = _mm_set1_epi8('\n');
+    __m128i cr = _mm_set1_epi8('\r');
+
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+        uint32_t mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+        if (mask) {
+            count += __builtin_popcount(mask);
+            *last = i + 31 - __builtin_clz(mask);
+        }
+    }
+
+    size_t tail_last;
+    size_t tail_count = scalar_newlines(data + i, length - i, &tail_last);
+    if (tail_count) {
+        *last = i + tail_last;
+    }
+
+    return count + tail_count;
+}
+
+static const ScanKernels sse2_kernels = {
+    .backend = GRAMINA_SCAN_SSE2,
+    .whitespace = sse2_whitespace,
+    .word = sse2_word,
+    .digits = sse2_digits,
+    .until = sse2_until,
+    .newlines = sse2_newlines,
+};
+
+#define GRAMINA_AVX2 __attribute__((target("avx2")))
+
+GRAMINA_AVX2 static uint32_t avx2_whitespace_mask(__m256i v) {
+    __m256i space = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+    __m256i ctrl = _mm256_and_si256(
+        _mm256_cmpgt_epi8(v, _mm256_set1_epi8('\t' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), v)
+    );
+
+    return _mm256_movemask_epi8(_mm256_or_si256(space, ctrl));
+}
+
+GRAMINA_AVX2 static uint32_t avx2_digit_mask(__m256i v) {
+    __m256i digit = _mm256_and_si256(
+        _mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v)
+    );
+
+    return _mm256_movemask_epi8(digit);
+}
+
+GRAMINA_AVX2 static uint32_t avx2_word_mask(__m256i v) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i alpha = _mm256_and_si256(
+        _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+        _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower)
+    );
+
+    __m256i underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+
+    return _mm256_movemask_epi8(_mm256_or_si256(alpha, underscore)) | avx2_digit_mask(v);
+}
+
+#define AVX2_RUN_KERNEL(name, mask_fn, sse2_fn) \
+GRAMINA_AVX2 static size_t name(const char *data, size_t length) { \
+    size_t i = 0; \
+    for (; i + 32 <= length; i += 32) { \
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i)); \
+        uint32_t mask = mask_fn(v); \
+        if (mask != 0xFFFFFFFF) { \
+            return i + __builtin_ctz(~mask); \
+        } \
+    } \
+    \
+    return i + sse2_fn(data + i, length - i); \
+}
+
+AVX2_RUN_KERNEL(avx2_whitespace, avx2_whitespace_mask, sse2_whitespace)
+AVX2_RUN_KERNEL(avx2_word, avx2_word_mask, sse2_word)
+AVX2_RUN_KERNEL(avx2_digits, avx2_digit_mask, sse2_digits)
+
+GRAMINA_AVX2 static size_t avx2_until(const char *data, size_t length, char a, char b) {
+    __m256i va = _mm256_set1_epi8(a);
+    __m256i vb = _mm256_set1_epi8(b);
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    return i + sse2_until(data + i, length - i, a, b);
+}
+
+GRAMINA_AVX2 static size_t avx2_newlines(const char *data, size_t length, size_t *last) {
+    __m256i lf = _mm256_set1_epi8('\n');
+    __m256i cr = _mm256_set1_epi8('\r');
+
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)));
+        if (mask) {
+            count += __builtin_popcount(mask);
+            *last = i + 31 - __builtin_clz(mask);
+        }
+    }
+
+    size_t tail_last;
+    size_t tail_count = sse2_newlines(data + i, length - i, &tail_last);
+    if (tail_count) {
+        *last = i + tail_last;
+    }
+
+    return count + tail_count;
+}
+
+static const ScanKernels avx2_kernels = {
+    .backend = GRAMINA_SCAN_AVX2,
+    .whitespace = avx2_whitespace,
+    .word = avx2_word,
+    .digits = avx2_digits,
+    .until = avx2_until,
+    .newlines = avx2_newlines,
+};
+
+#endif
+
+static const ScanKernels *kernels = NULL;
+
+// Lexers on several -j threads can pick the kernels at the same time
+#if defined(__GNUC__) || defined(__clang__)
+#  define LOAD_KERNELS() __atomic_load_n(&kernels, __ATOMIC_ACQUIRE)
+#  define STORE_KERNELS(k) __atomic_store_n(&kernels, (k), __ATOMIC_RELEASE)
+#else
+#  define LOAD_KERNELS() kernels
+#  define STORE_KERNELS(k) (kernels = (k))
+#endif
+
+static const ScanKernels *get_kernels() {
+    const ScanKernels *chosen = LOAD_KERNELS();
+    if (chosen) {
+        return chosen;
+    }
+
+#ifdef GRAMINA_SCAN_X86
+    __builtin_cpu_init();
+    chosen = __builtin_cpu_supports("avx2")
+           ? &avx2_kernels
+           : &sse2_kernels;
+#else
+    chosen = &scalar_kernels;
+#endif
+
+    // Every thread that gets here chooses the same kernels
+    STORE_KERNELS(chosen);
+
+    return chosen;
+}
+
+bool gramina_scan_use_backend(ScanBackend backend) {
+    switch (backend) {
+    case GRAMINA_SCAN_SCALAR:
+        STORE_KERNELS(&scalar_kernels);
+        return true;
+#ifdef GRAMINA_SCAN_X86
+    case GRAMINA_SCAN_SSE2:
+        STORE_KERNELS(&sse2_kernels);
+        return true;
+    case GRAMINA_SCAN_AVX2:
+        __builtin_cpu_init();
+        if (!__builtin_cpu_supports("avx2")) {
+            return false;
+        }
+
+        STORE_KERNELS(&avx2_kernels);
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+ScanBackend gramina_scan_current_backend() {
+    return get_kernels()->backend;
+}
+
+size_t gramina_scan_whitespace(const char *data, size_t length) {
+    return get_kernels()->whitespace(data, length);
+}
+
+size_t gramina_scan_word(const char *data, size_t length) {
+    return get_kernels()->word(data, length);
+}
+
+size_t gramina_scan_digits(const char *data, size_t length) {
+    return get_kernels()->digits(data, length);
+}
+
+size_t gramina_scan_until(const char *data, size_t length, char a, char b) {
+    return get_kernels()->until(data, length, a, b);
+}
+
+size_t gramina_scan_newlines(const char *data, size_t length, size_t *last) {
+    return get_kernels()->newlines(data, length, last);
+}
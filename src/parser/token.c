@@ -1,57 +1,146 @@
 #define GRAMINA_NO_NAMESPACE
 
+#include <string.h>
+
 #include "parser/token.h"
 
 GRAMINA_IMPLEMENT_ARRAY(GraminaToken)
 GRAMINA_IMPLEMENT_ARRAY(GraminaTokenType)
 
-void gramina_token_free(Token *this) {
-    str_free(&this->contents);
+TokenSlab gramina_mk_token_slab(size_t capacity) {
+    TokenSlab this = {
+        .length = 0,
+        .capacity = 0,
+        .types = NULL,
+        .positions = NULL,
+        .data = NULL,
+        .contents = NULL,
+    };
+
+    token_slab_reserve(&this, capacity);
 
-    this->pos.line = 0;
-    this->pos.column = 0;
-    this->pos.depth = 0;
-    this->type = GRAMINA_TOK_ILL_FORMED;
-    this->flags = 0;
+    return this;
 }
 
+void gramina_token_slab_reserve(TokenSlab *this, size_t capacity) {
+    if (this->capacity >= capacity) {
+        return;
+    }
+
+    this->types = gramina_realloc(this->types, capacity * sizeof *this->types);
+    this->positions = gramina_realloc(this->positions, capacity * sizeof *this->positions);
+    this->data = gramina_realloc(this->data, capacity * sizeof *this->data);
+    this->contents = gramina_realloc(this->contents, capacity * sizeof *this->contents);
+
+    gramina_assert(this->types && this->positions && this->data && this->contents, "alloc failed");
+
+    this->capacity = capacity;
+}
+
+void gramina_token_slab_push(TokenSlab *this, const Token *tok) {
+    if (this->length >= this->capacity) {
+        token_slab_reserve(this, this->capacity * 2 + 16);
+    }
+
+    size_t i = this->length++;
+
+    this->types[i] = tok->type;
+    this->positions[i] = tok->pos;
+    this->data[i] = tok->data;
+    this->contents[i] = tok->contents;
+}
+
+Token gramina_token_slab_get(const TokenSlab *this, size_t index) {
+    return (Token) {
+        .type = this->types[index],
+        .pos = this->positions[index],
+        .data = this->data[index],
+        .contents = this->contents[index],
+    };
+}
+
+void gramina_token_slab_free(TokenSlab *this) {
+    gramina_free(this->types);
+    gramina_free(this->positions);
+    gramina_free(this->data);
+    gramina_free(this->contents);
+
+    *this = mk_token_slab(0);
+}
+
+#define KEYWORD_IS(w, kw) (memcmp((w)->data, (kw), sizeof(kw) - 1) == 0)
+
+// Keywords are dispatched on length first and then on the leading character,
+// so an identifier costs at most one `memcmp` against a single candidate.
+// Keep this in sync with the keyword list in `TokenType`.
 TokenType gramina_classify_wordlike(const StringView *w) {
-    if (false) {
-    } else if (sv_cmp_c(w, "true") == 0) {
-        return GRAMINA_TOK_KW_TRUE;
-    } else if (sv_cmp_c(w, "false") == 0) {
-        return GRAMINA_TOK_KW_FALSE;
-    } else if (sv_cmp_c(w, "const") == 0) {
-        return GRAMINA_TOK_KW_CONST;
-    } else if (sv_cmp_c(w, "import") == 0) {
-        return GRAMINA_TOK_KW_IMPORT;
-    } else if (sv_cmp_c(w, "fence") == 0) {
-        return GRAMINA_TOK_KW_FENCE;
-    } else if (sv_cmp_c(w, "fn") == 0) {
-        return GRAMINA_TOK_KW_FN;
-    } else if (sv_cmp_c(w, "struct") == 0) {
-        return GRAMINA_TOK_KW_STRUCT;
-    } else if (sv_cmp_c(w, "if") == 0) {
-        return GRAMINA_TOK_KW_IF;
-    } else if (sv_cmp_c(w, "else") == 0) {
-        return GRAMINA_TOK_KW_ELSE;
-    } else if (sv_cmp_c(w, "for") == 0) {
-        return GRAMINA_TOK_KW_FOR;
-    } else if (sv_cmp_c(w, "foreach") == 0) {
-        return GRAMINA_TOK_KW_FOREACH;
-    } else if (sv_cmp_c(w, "while") == 0) {
-        return GRAMINA_TOK_KW_WHILE;
-    } else if (sv_cmp_c(w, "return") == 0) {
-        return GRAMINA_TOK_KW_RETURN;
-    } else if (sv_cmp_c(w, "sizeof") == 0) {
-        return GRAMINA_TOK_KW_SIZEOF;
-    } else if (sv_cmp_c(w, "alignof") == 0) {
-        return GRAMINA_TOK_KW_ALIGNOF;
-    } else {
-        return GRAMINA_TOK_IDENTIFIER;
+    switch (w->length) {
+    case 2:
+        switch (w->data[0]) {
+        case 'f':
+            return KEYWORD_IS(w, "fn") ? GRAMINA_TOK_KW_FN : GRAMINA_TOK_IDENTIFIER;
+        case 'i':
+            return KEYWORD_IS(w, "if") ? GRAMINA_TOK_KW_IF : GRAMINA_TOK_IDENTIFIER;
+        }
+        break;
+    case 3:
+        if (KEYWORD_IS(w, "for")) {
+            return GRAMINA_TOK_KW_FOR;
+        }
+        break;
+    case 4:
+        switch (w->data[0]) {
+        case 't':
+            return KEYWORD_IS(w, "true") ? GRAMINA_TOK_KW_TRUE : GRAMINA_TOK_IDENTIFIER;
+        case 'e':
+            return KEYWORD_IS(w, "else") ? GRAMINA_TOK_KW_ELSE : GRAMINA_TOK_IDENTIFIER;
+        }
+        break;
+    case 5:
+        switch (w->data[0]) {
+        case 'c':
+            return KEYWORD_IS(w, "const") ? GRAMINA_TOK_KW_CONST : GRAMINA_TOK_IDENTIFIER;
+        case 'w':
+            return KEYWORD_IS(w, "while") ? GRAMINA_TOK_KW_WHILE : GRAMINA_TOK_IDENTIFIER;
+        case 'f':
+            if (KEYWORD_IS(w, "false")) {
+                return GRAMINA_TOK_KW_FALSE;
+            } else if (KEYWORD_IS(w, "fence")) {
+                return GRAMINA_TOK_KW_FENCE;
+            }
+            break;
+        }
+        break;
+    case 6:
+        switch (w->data[0]) {
+        case 'i':
+            return KEYWORD_IS(w, "import") ? GRAMINA_TOK_KW_IMPORT : GRAMINA_TOK_IDENTIFIER;
+        case 'r':
+            return KEYWORD_IS(w, "return") ? GRAMINA_TOK_KW_RETURN : GRAMINA_TOK_IDENTIFIER;
+        case 's':
+            if (KEYWORD_IS(w, "struct")) {
+                return GRAMINA_TOK_KW_STRUCT;
+            } else if (KEYWORD_IS(w, "sizeof")) {
+                return GRAMINA_TOK_KW_SIZEOF;
+            }
+            break;
+        }
+        break;
+    case 7:
+        switch (w->data[0]) {
+        case 'f':
+            return KEYWORD_IS(w, "foreach") ? GRAMINA_TOK_KW_FOREACH : GRAMINA_TOK_IDENTIFIER;
+        case 'a':
+            return KEYWORD_IS(w, "alignof") ? GRAMINA_TOK_KW_ALIGNOF : GRAMINA_TOK_IDENTIFIER;
+        }
+        break;
     }
+
+    return GRAMINA_TOK_IDENTIFIER;
 }
 
+#undef KEYWORD_IS
+
 
 String gramina_token_contents(const Token *this) {
     switch (this->type) {
@@ -181,7 +270,7 @@ String gramina_token_contents(const Token *this) {
     case GRAMINA_TOK_EOF:
         return mk_str_c("<eof>");
     default:
-        return str_dup(&this->contents);
+        return sv_dup(&this->contents);
     }
 }
 
@@ -11,3 +11,17 @@ TEST(ArrayBadLen);
 TEST(ArrayOk);
 TEST(Pipe);
 TEST(SliceRef);
+TEST(UsizeNarrow);
+TEST(LexerScan);
+TEST(KeywordClassify);
+TEST(Hashmap);
+TEST(SessionReuse);
+TEST(Foreach);
+TEST(Vector);
+TEST(ReadonlyParam);
+TEST(ReturnInPlace);
+TEST(LtoExports);
+TEST(Partition);
+TEST(CacheKey);
+TEST(CacheTrim);
+TEST(Server);
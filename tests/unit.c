@@ -93,6 +93,20 @@ int main(int argc, char **argv) {
         MAKE_TEST(ArrayOk),
         MAKE_TEST(Pipe),
         MAKE_TEST(SliceRef),
+        MAKE_TEST(UsizeNarrow),
+        MAKE_TEST(LexerScan),
+        MAKE_TEST(KeywordClassify),
+        MAKE_TEST(Hashmap),
+        MAKE_TEST(SessionReuse),
+        MAKE_TEST(Foreach),
+        MAKE_TEST(Vector),
+        MAKE_TEST(ReadonlyParam),
+        MAKE_TEST(ReturnInPlace),
+        MAKE_TEST(LtoExports),
+        MAKE_TEST(Partition),
+        MAKE_TEST(CacheKey),
+        MAKE_TEST(CacheTrim),
+        MAKE_TEST(Server),
     };
 
     size_t n_tests = (sizeof tests) / (sizeof tests[0]);
@@ -0,0 +1,177 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tester.h"
+
+#include "common/log.h"
+
+#define CACHE_DIR "local/cache"
+#define BINARY "local/cache_test"
+
+// Padding functions make the entry big enough for LRU trimming to measure in MiB
+static void write_source(const char *path, int exit_code, size_t n_padding) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        test_fail_cmsg("Cannot write test source");
+    }
+
+    fprintf(file, "#extern(\"exit\")\nfn Exit(int status);\n\n");
+
+    for (size_t i = 0; i < n_padding; ++i) {
+        fprintf(file, "fn Pad%zu(int x) -> int { return x * %zu + %d; }\n", i, i, exit_code);
+    }
+
+    fprintf(file, "\n#extern(\"_start\")\nfn entry() {\n    Exit(%d);\n}\n", exit_code);
+    fclose(file);
+}
+
+static void run_tool(const char *first, ...) {
+    Subprocess sp = mk_sbp();
+
+    va_list args;
+    va_start(args, first);
+    for (const char *arg = first; arg; arg = va_arg(args, const char *)) {
+        sbp_arg_cstr(&sp, arg);
+    }
+    va_end(args);
+
+    run_command(&sp);
+    sbp_free(&sp);
+}
+
+/**
+ * Compiles `source` into `BINARY` with the cache enabled, the remaining
+ * arguments are passed on as well. True if the cache statistics the
+ * compiler reports contain `report`.
+ */
+static bool compile_cached(const char *compiler, const char *source, const char *report, ...) {
+    Subprocess sp = mk_sbp();
+    sbp_arg_cstr(&sp, compiler);
+    sbp_arg_cstr(&sp, source);
+    sbp_arg_cstr(&sp, "--cache");
+    sbp_arg_cstr(&sp, CACHE_DIR);
+    sbp_arg_cstr(&sp, "--log-level");
+    sbp_arg_cstr(&sp, "info");
+    set_compilation_output(&sp, BINARY);
+    add_libc(&sp);
+
+    va_list args;
+    va_start(args, report);
+    for (const char *arg = va_arg(args, const char *); arg; arg = va_arg(args, const char *)) {
+        sbp_arg_cstr(&sp, arg);
+    }
+    va_end(args);
+
+    sbp_run(&sp);
+
+    // The report is printed last, so read everything the compiler prints
+    String output = mk_str();
+    Stream stream = sbp_stream(&sp);
+    int status;
+    while (!(status = stream_read_str(&stream, &output, 4096, NULL))) {}
+
+    sbp_wait(&sp);
+
+    str_append(&output, '\0');
+
+    bool ok = status == EOF
+           && sp.exit_code == 0
+           && strstr(output.data, report);
+
+    if (!ok) {
+        elog_fmt("Expected '{cstr}' from:\n{cstr}\n", report, output.data);
+    }
+
+    str_free(&output);
+    sbp_free(&sp);
+
+    return ok;
+}
+
+static int run_binary(void) {
+    int exit_code = -1;
+    execute(BINARY, prog) {
+        sbp_wait(&prog);
+        exit_code = prog.exit_code;
+    }
+
+    return exit_code;
+}
+
+// Each part of the key has to turn a hit into a miss, otherwise a stale module is linked
+TEST(CacheKey) {
+    const char *compiler = get_compiler();
+    const char *source = "local/cache_key.lawn";
+
+    run_tool("rm", "-rf", CACHE_DIR, NULL);
+
+    write_source(source, 3, 0);
+    bool ok = compile_cached(compiler, source, "0 hits, 1 misses, 1 stored", NULL)
+           && run_binary() == 3
+           && compile_cached(compiler, source, "1 hits, 0 misses, 0 stored", NULL)
+           && run_binary() == 3;
+
+    write_source(source, 4, 0);
+    ok = ok
+      && compile_cached(compiler, source, "0 hits, 1 misses, 1 stored", NULL)
+      && run_binary() == 4
+      && compile_cached(compiler, source, "0 hits, 1 misses, 1 stored", "-O", "2", NULL)
+      && compile_cached(compiler, source, "1 hits, 0 misses, 0 stored", "-O", "2", NULL)
+      && compile_cached(compiler, source, "0 hits, 1 misses, 1 stored", "--mcpu", "native", NULL);
+
+    // A copy is a different binary as far as the cache is concerned
+    run_tool("cp", compiler, "local/gramina_copy", NULL);
+    ok = ok
+      && compile_cached("local/gramina_copy", source, "0 hits, 1 misses, 1 stored", NULL)
+      && run_binary() == 4;
+
+    if (!ok) {
+        test_fail();
+    }
+
+    test_ok();
+}
+
+// About 400 KiB of bitcode per source, so a 1 MiB cache holds two of them
+TEST(CacheTrim) {
+    const char *compiler = get_compiler();
+    const char *sources[] = {
+        "local/cache_trim_0.lawn",
+        "local/cache_trim_1.lawn",
+        "local/cache_trim_2.lawn",
+    };
+
+    run_tool("rm", "-rf", CACHE_DIR, NULL);
+
+    for (size_t i = 0; i < 3; ++i) {
+        write_source(sources[i], i, 3500);
+    }
+
+    // Entries are ordered by modification time, which has a resolution of a second
+    bool ok = compile_cached(compiler, sources[0], "1 stored, 0 evicted", "--cache-size", "1", NULL);
+    sleep(1);
+    ok = ok && compile_cached(compiler, sources[1], "1 stored, 0 evicted", "--cache-size", "1", NULL);
+    sleep(1);
+
+    // A hit makes the first entry the most recently used one
+    ok = ok && compile_cached(compiler, sources[0], "1 hits", "--cache-size", "1", NULL);
+    sleep(1);
+
+    ok = ok
+      && compile_cached(compiler, sources[2], "1 stored, 1 evicted", "--cache-size", "1", NULL)
+      && compile_cached(compiler, sources[0], "1 hits", "--cache-size", "1", NULL)
+      && compile_cached(compiler, sources[2], "1 hits", "--cache-size", "1", NULL)
+      && compile_cached(compiler, sources[1], "1 misses", "--cache-size", "1", NULL)
+      && run_binary() == 1;
+
+    // Nothing fits into an empty cache
+    ok = ok && compile_cached(compiler, sources[0], "evicted", "--cache-size", "0", NULL);
+
+    if (!ok) {
+        test_fail();
+    }
+
+    test_ok();
+}
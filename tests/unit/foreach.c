@@ -0,0 +1,18 @@
+#include "tester.h"
+
+TEST(Foreach) {
+    Stream ok = mk_stream_open_c("gramina/foreach_ok.lawn", "r");
+    Stream scalar = mk_stream_open_c("gramina/foreach_scalar.lawn", "r");
+
+    bool success_ok = check_compilation_success(&ok);
+    bool success_scalar = check_compilation_success(&scalar);
+
+    stream_free(&ok);
+    stream_free(&scalar);
+
+    if (success_ok && !success_scalar) {
+        test_ok();
+    } else {
+        test_fail();
+    }
+}
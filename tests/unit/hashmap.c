@@ -0,0 +1,64 @@
+#include "tester.h"
+
+#include "common/hashmap.h"
+#include "common/intern.h"
+
+#define N_KEYS 5000
+
+TEST(Hashmap) {
+    Hashmap map = mk_hashmap(0);
+    Symbol keys[N_KEYS];
+
+    for (size_t i = 0; i < N_KEYS; ++i) {
+        String name = str_cfmt("key_{sz}", i);
+        StringView view = str_as_view(&name);
+        keys[i] = intern(&view);
+        str_free(&name);
+
+        hashmap_set_sym(&map, keys[i], (void *)(keys + i));
+    }
+
+    // Removing every third key exercises backward shifting across runs
+    for (size_t i = 0; i < N_KEYS; i += 3) {
+        hashmap_remove_sym(&map, keys[i]);
+    }
+
+    size_t expected = N_KEYS - (N_KEYS + 2) / 3;
+    if (hashmap_count(&map) != expected) {
+        hashmap_free(&map);
+        test_fail_msg(str_cfmt("expected {sz} entries, got {sz}", expected, hashmap_count(&map)));
+    }
+
+    for (size_t i = 0; i < N_KEYS; ++i) {
+        void *value = hashmap_get_sym(&map, keys[i]);
+        void *wanted = i % 3 == 0 ? NULL : (void *)(keys + i);
+
+        if (value != wanted) {
+            hashmap_free(&map);
+            test_fail_msg(str_cfmt("wrong value for key {sz}", i));
+        }
+    }
+
+    size_t visited = 0;
+    hashmap_foreach(Symbol, key, value, map) {
+        if (value != hashmap_get_sym(&map, key)) {
+            hashmap_free(&map);
+            test_fail_msg(mk_str_c("foreach yielded a stale entry"));
+        }
+
+        ++visited;
+    }
+
+    hashmap_free(&map);
+
+    if (visited != expected) {
+        test_fail_msg(str_cfmt("foreach visited {sz} entries, expected {sz}", visited, expected));
+    }
+
+    StringView key = mk_sv_c("key_1");
+    if (hashmap_get(&map, key) != NULL) {
+        test_fail_msg(mk_str_c("freed map still has entries"));
+    }
+
+    test_ok();
+}
@@ -0,0 +1,77 @@
+#include <time.h>
+
+#include "tester.h"
+
+#include "common/log.h"
+#include "parser/token.h"
+
+static const struct {
+    const char *word;
+    TokenType type;
+} words[] = {
+    { "true", GRAMINA_TOK_KW_TRUE },
+    { "false", GRAMINA_TOK_KW_FALSE },
+    { "const", GRAMINA_TOK_KW_CONST },
+    { "import", GRAMINA_TOK_KW_IMPORT },
+    { "fence", GRAMINA_TOK_KW_FENCE },
+    { "fn", GRAMINA_TOK_KW_FN },
+    { "struct", GRAMINA_TOK_KW_STRUCT },
+    { "if", GRAMINA_TOK_KW_IF },
+    { "else", GRAMINA_TOK_KW_ELSE },
+    { "for", GRAMINA_TOK_KW_FOR },
+    { "foreach", GRAMINA_TOK_KW_FOREACH },
+    { "while", GRAMINA_TOK_KW_WHILE },
+    { "return", GRAMINA_TOK_KW_RETURN },
+    { "sizeof", GRAMINA_TOK_KW_SIZEOF },
+    { "alignof", GRAMINA_TOK_KW_ALIGNOF },
+
+    { "", GRAMINA_TOK_IDENTIFIER },
+    { "f", GRAMINA_TOK_IDENTIFIER },
+    { "fo", GRAMINA_TOK_IDENTIFIER },
+    { "fore", GRAMINA_TOK_IDENTIFIER },
+    { "foreac", GRAMINA_TOK_IDENTIFIER },
+    { "foreachh", GRAMINA_TOK_IDENTIFIER },
+    { "fenc", GRAMINA_TOK_IDENTIFIER },
+    { "falsey", GRAMINA_TOK_IDENTIFIER },
+    { "sizeOf", GRAMINA_TOK_IDENTIFIER },
+    { "structs", GRAMINA_TOK_IDENTIFIER },
+    { "value", GRAMINA_TOK_IDENTIFIER },
+    { "x", GRAMINA_TOK_IDENTIFIER },
+    { "i32", GRAMINA_TOK_IDENTIFIER },
+    { "another_identifier", GRAMINA_TOK_IDENTIFIER },
+};
+
+#define N_WORDS (sizeof words / sizeof words[0])
+#define BENCH_ROUNDS 200000
+
+TEST(KeywordClassify) {
+    StringView views[N_WORDS];
+
+    for (size_t i = 0; i < N_WORDS; ++i) {
+        views[i] = mk_sv_c(words[i].word);
+
+        TokenType type = classify_wordlike(&views[i]);
+        if (type != words[i].type) {
+            test_fail_msg(str_cfmt("'{cstr}' classified as {sv}", words[i].word, token_type_to_str(type)));
+        }
+    }
+
+    // Not a pass/fail criterion, only reported so regressions on the
+    // lexer's hottest path are visible in the test log.
+    volatile size_t sink = 0;
+    clock_t start = clock();
+
+    for (size_t r = 0; r < BENCH_ROUNDS; ++r) {
+        for (size_t i = 0; i < N_WORDS; ++i) {
+            sink += classify_wordlike(&views[i]);
+        }
+    }
+
+    clock_t elapsed = clock() - start;
+    double ns = (double)elapsed * 1e9 / CLOCKS_PER_SEC / ((double)BENCH_ROUNDS * N_WORDS);
+
+    vlog_fmt("Keyword classification: {f64} ns per word\n", ns);
+    (void)sink;
+
+    test_ok();
+}
@@ -0,0 +1,67 @@
+#include <string.h>
+
+#include "tester.h"
+
+static bool link_lto(const char *mode) {
+    Subprocess compiler = mk_sbp();
+    sbp_arg_cstr(&compiler, get_compiler());
+    sbp_arg_cstr(&compiler, "gramina/lto_exports.lawn");
+    sbp_arg_cstr(&compiler, mode);
+    sbp_arg_cstr(&compiler, "--export");
+    sbp_arg_cstr(&compiler, "Exported");
+    set_compilation_output(&compiler, "local/lto_exports");
+    add_libc(&compiler);
+
+    sbp_run_sync(&compiler);
+    bool ok = compiler.exit_code == 0;
+    sbp_free(&compiler);
+
+    if (!ok) {
+        return false;
+    }
+
+    int exit_code = -1;
+    execute("local/lto_exports", prog) {
+        sbp_wait(&prog);
+        exit_code = prog.exit_code;
+    }
+
+    if (exit_code) {
+        return false;
+    }
+
+    // Exported definitions stay global, everything else may be inlined away
+    String symbols = mk_str();
+
+    Subprocess nm = mk_sbp();
+    sbp_arg_cstr(&nm, "nm");
+    sbp_arg_cstr(&nm, "local/lto_exports");
+    sbp_run(&nm);
+
+    // A read returns whatever the pipe holds, which may not be everything yet
+    Stream stream = sbp_stream(&nm);
+    int status;
+    while (!(status = stream_read_str(&stream, &symbols, 4096, NULL))) {}
+
+    sbp_wait(&nm);
+    sbp_free(&nm);
+
+    str_append(&symbols, '\0');
+
+    ok = status == EOF
+      && strstr(symbols.data, " T lto_callback\n")
+      && strstr(symbols.data, " T Exported\n")
+      && !strstr(symbols.data, " T Internal\n");
+
+    str_free(&symbols);
+
+    return ok;
+}
+
+TEST(LtoExports) {
+    if (!link_lto("--lto") || !link_lto("--thin-lto")) {
+        test_fail();
+    }
+
+    test_ok();
+}
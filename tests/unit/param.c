@@ -0,0 +1,60 @@
+#include "tester.h"
+
+#include <string.h>
+
+#include <llvm-c/Core.h>
+
+#include "compiler/compiler.h"
+#include "parser/lexer.h"
+#include "parser/parser.h"
+
+static const char *source =
+    "struct Pair { int a; int b; }\n"
+    "fn Read(Pair p) -> int { return p.a + p.b; }\n"
+    "fn Assign(Pair p) -> int { p.a = 3; return p.a + p.b; }\n"
+    "fn Address(Pair p) -> int { Pair& q = &p; return q.a; }\n";
+
+static bool has_attribute(LLVMModuleRef mod, const char *fn_name, const char *attr) {
+    LLVMValueRef fn = LLVMGetNamedFunction(mod, fn_name);
+    unsigned kind = LLVMGetEnumAttributeKindForName(attr, strlen(attr));
+
+    // The struct is the first and only parameter
+    return fn && LLVMGetEnumAttributeAtIndex(fn, 1, kind) != NULL;
+}
+
+// Struct parameters the body only reads are passed without a `byval` copy
+TEST(ReadonlyParam) {
+    StringView source_view = mk_sv_c(source);
+    LexResult lexed = lex_sv(&source_view);
+    ParseResult parsed = parse(&lexed.tokens);
+
+    CompileResult result = compile(parsed.root);
+
+    bool ok = result.status == GRAMINA_COMPILE_ERR_NONE;
+
+    if (ok) {
+        LLVMModuleRef mod = result.module;
+
+        ok = has_attribute(mod, "Read", "readonly")
+          && has_attribute(mod, "Read", "nocapture")
+          && !has_attribute(mod, "Read", "noalias")
+          && !has_attribute(mod, "Read", "byval")
+          && has_attribute(mod, "Assign", "byval")
+          && !has_attribute(mod, "Assign", "readonly")
+          && has_attribute(mod, "Address", "byval")
+          && !has_attribute(mod, "Address", "readonly");
+
+        LLVMDisposeModule(mod);
+    } else {
+        str_free(&result.error.description);
+    }
+
+    parse_result_free(&parsed);
+    lex_result_free(&lexed);
+
+    if (ok) {
+        test_ok();
+    } else {
+        test_fail();
+    }
+}
@@ -0,0 +1,75 @@
+#include <string.h>
+
+#include "tester.h"
+
+typedef struct {
+    String output;
+    int exit_code;
+} RunResult;
+
+// Links gramina/partition.lawn with `jobs` threads and runs the result
+static bool build_and_run(const char *jobs, const char *out, RunResult *result) {
+    Subprocess compiler = mk_sbp();
+    sbp_arg_cstr(&compiler, get_compiler());
+    sbp_arg_cstr(&compiler, "gramina/partition.lawn");
+    sbp_arg_cstr(&compiler, "-j");
+    sbp_arg_cstr(&compiler, jobs);
+    set_compilation_output(&compiler, out);
+    add_libc(&compiler);
+
+    sbp_run_sync(&compiler);
+    bool ok = compiler.exit_code == 0;
+    sbp_free(&compiler);
+
+    if (!ok) {
+        return false;
+    }
+
+    *result = (RunResult) {
+        .output = mk_str(),
+        .exit_code = -1,
+    };
+
+    execute(out, prog) {
+        // A read returns whatever the pipe holds, which may not be everything yet
+        Stream stream = sbp_stream(&prog);
+        int status;
+        while (!(status = stream_read_str(&stream, &result->output, 1024, NULL))) {}
+
+        ok = status == EOF;
+
+        sbp_wait(&prog);
+        result->exit_code = prog.exit_code;
+    }
+
+    return ok;
+}
+
+// Each of the 4 objects defines only some functions, the linked binary must not notice
+TEST(Partition) {
+    RunResult single;
+    RunResult split;
+
+    if (!build_and_run("1", "local/partition_single", &single)) {
+        test_fail();
+    }
+
+    if (!build_and_run("4", "local/partition_split", &split)) {
+        str_free(&single.output);
+        test_fail();
+    }
+
+    bool ok = single.exit_code == 25
+           && split.exit_code == single.exit_code
+           && single.output.length > 0
+           && str_cmp(&single.output, &split.output) == 0;
+
+    str_free(&single.output);
+    str_free(&split.output);
+
+    if (!ok) {
+        test_fail();
+    }
+
+    test_ok();
+}
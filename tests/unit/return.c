@@ -0,0 +1,30 @@
+#include "tester.h"
+
+// The program exits with the number of the first check that failed
+TEST(ReturnInPlace) {
+    Subprocess compiler = mk_sbp();
+    sbp_arg_cstr(&compiler, get_compiler());
+    sbp_arg_cstr(&compiler, "gramina/return_in_place.lawn");
+    set_compilation_output(&compiler, "local/return_in_place");
+    add_libc(&compiler);
+
+    sbp_run_sync(&compiler);
+    if (compiler.exit_code) {
+        sbp_free(&compiler);
+        test_fail();
+    }
+
+    sbp_free(&compiler);
+
+    int exit_code = -1;
+    execute("local/return_in_place", prog) {
+        sbp_wait(&prog);
+        exit_code = prog.exit_code;
+    }
+
+    if (exit_code) {
+        test_fail_msg(str_cfmt("Check {i32} failed", (int32_t)exit_code));
+    }
+
+    test_ok();
+}
@@ -0,0 +1,57 @@
+#include <string.h>
+
+#include "tester.h"
+
+#include "parser/scan.h"
+
+static const char *sample =
+    "fn Main() -> int {\n"
+    "    \t  int value_23 = 1234567890123456789012345678901234567890;\n\r\n"
+    "    /* a long comment that spans well over thirty two bytes * / **/\n"
+    "    return \"string with \\\"escapes\\\" and more text to fill a chunk\";\n"
+    "}                                                                 \n"
+    "identifier_that_is_longer_than_thirty_two_bytes_for_sure \x80\xff\n";
+
+static void check_backend(ScanBackend backend) {
+    if (!scan_use_backend(backend)) {
+        return;
+    }
+
+    size_t length = strlen(sample);
+    for (size_t i = 0; i < length; ++i) {
+        const char *data = sample + i;
+        size_t n = length - i;
+
+        scan_use_backend(GRAMINA_SCAN_SCALAR);
+
+        size_t ws = scan_whitespace(data, n);
+        size_t word = scan_word(data, n);
+        size_t digits = scan_digits(data, n);
+        size_t until = scan_until(data, n, '*', '"');
+        size_t last = 0;
+        size_t lines = scan_newlines(data, n, &last);
+
+        scan_use_backend(backend);
+
+        size_t vec_last = 0;
+        if (scan_whitespace(data, n) != ws
+         || scan_word(data, n) != word
+         || scan_digits(data, n) != digits
+         || scan_until(data, n, '*', '"') != until
+         || scan_newlines(data, n, &vec_last) != lines
+         || vec_last != last) {
+            test_fail_msg(str_cfmt("backend {i32} disagrees at offset {sz}", (int32_t)backend, i));
+        }
+    }
+}
+
+TEST(LexerScan) {
+    ScanBackend original = scan_current_backend();
+
+    check_backend(GRAMINA_SCAN_SSE2);
+    check_backend(GRAMINA_SCAN_AVX2);
+
+    scan_use_backend(original);
+
+    test_ok();
+}
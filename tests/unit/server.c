@@ -0,0 +1,153 @@
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "tester.h"
+
+#include "common/log.h"
+
+#define SOCKET "local/test_server.sock"
+
+// Reads everything `sp` prints until it exits, true if that contains `expected`
+static bool output_contains(Subprocess *sp, const char *expected) {
+    String output = mk_str();
+    Stream stream = sbp_stream(sp);
+    int status;
+    while (!(status = stream_read_str(&stream, &output, 4096, NULL))) {}
+
+    sbp_wait(sp);
+
+    str_append(&output, '\0');
+
+    bool found = status == EOF && strstr(output.data, expected);
+    if (!found) {
+        elog_fmt("Expected '{cstr}' from:\n{cstr}\n", expected, output.data);
+    }
+
+    str_free(&output);
+
+    return found;
+}
+
+static bool compile_through(const char *log_level, const char *expected) {
+    Subprocess client = mk_sbp();
+    sbp_arg_cstr(&client, get_compiler());
+    sbp_arg_cstr(&client, "gramina/exit.lawn");
+    sbp_arg_cstr(&client, "--connect");
+    sbp_arg_cstr(&client, SOCKET);
+    sbp_arg_cstr(&client, "--log-level");
+    sbp_arg_cstr(&client, log_level);
+    set_compilation_output(&client, "local/server_exit");
+    add_libc(&client);
+
+    sbp_run(&client);
+
+    bool ok = output_contains(&client, expected)
+           && client.exit_code == 0;
+
+    sbp_free(&client);
+
+    return ok;
+}
+
+/**
+ * Once the server says it is ready, it waits for the request of the returned
+ * connection. Sending nothing keeps the server on it, closing it sends the
+ * server on to the next one.
+ */
+static int occupy_server(void) {
+    struct sockaddr_un addr = {
+        .sun_family = AF_UNIX,
+        .sun_path = SOCKET,
+    };
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    char ready;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof addr) || recv(fd, &ready, 1, 0) != 1) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// Its stdout is a pipe, so the server's own log may not show up in time
+static bool wait_until_listening(void) {
+    for (int tries = 0; tries < 500; ++tries) {
+        int fd = occupy_server();
+        if (fd >= 0) {
+            close(fd);
+            return true;
+        }
+
+        usleep(10000);
+    }
+
+    return false;
+}
+
+TEST(Server) {
+    // The server must not have a cache of its own, only the one a client forwards
+    unsetenv("GRAMINA_CACHE_DIR");
+    unlink(SOCKET);
+
+    Subprocess rm = mk_sbp();
+    sbp_arg_cstr(&rm, "rm");
+    sbp_arg_cstr(&rm, "-rf");
+    sbp_arg_cstr(&rm, "local/server_cache");
+    run_command(&rm);
+    sbp_free(&rm);
+
+    Subprocess server = mk_sbp();
+    sbp_arg_cstr(&server, get_compiler());
+    sbp_arg_cstr(&server, "--server");
+    sbp_arg_cstr(&server, SOCKET);
+    sbp_arg_cstr(&server, "--log-level");
+    sbp_arg_cstr(&server, "info");
+    sbp_run(&server);
+
+    bool ok = wait_until_listening();
+
+    // Only a server keeps the previous bodies around
+    ok = ok
+      && compile_through("all", "Registering function")
+      && compile_through("all", "Reusing the previous body");
+
+    setenv("GRAMINA_CACHE_DIR", "local/server_cache", true);
+    ok = ok && compile_through("info", "Cache: 0 hits, 1 misses, 1 stored");
+    unsetenv("GRAMINA_CACHE_DIR");
+
+    int exit_code = -1;
+    execute("local/server_exit", prog) {
+        sbp_wait(&prog);
+        exit_code = prog.exit_code;
+    }
+
+    ok = ok && exit_code == 0;
+
+    int busy = occupy_server();
+    ok = ok
+      && busy >= 0
+      && compile_through("all", "is busy, compiling locally");
+
+    if (busy >= 0) {
+        close(busy);
+    }
+
+    kill(sbp_pid(&server), SIGTERM);
+    sbp_wait(&server);
+    sbp_free(&server);
+
+    if (!ok) {
+        test_fail();
+    }
+
+    test_ok();
+}
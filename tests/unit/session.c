@@ -0,0 +1,102 @@
+#include "tester.h"
+
+#include <llvm-c/Analysis.h>
+#include <llvm-c/Core.h>
+#include <llvm-c/TargetMachine.h>
+
+#include "compiler/compiler.h"
+#include "compiler/session.h"
+#include "parser/lexer.h"
+#include "parser/parser.h"
+
+static const char *original =
+    "struct Pair { int a; int b; }\n"
+    "fn sum(Pair p) -> int { return p.a + p.b; }\n"
+    "fn twice(int x) -> int { return x * 2; }\n"
+    "fn main() -> int { Pair p; p.a = 1; p.b = 2; return twice(sum(p)); }\n";
+
+// Only the body of `twice` changes, its callers stay
+static const char *body_changed =
+    "struct Pair { int a; int b; }\n"
+    "fn sum(Pair p) -> int { return p.a + p.b; }\n"
+    "fn twice(int x) -> int { return x * 3; }\n"
+    "fn main() -> int { Pair p; p.a = 1; p.b = 2; return twice(sum(p)); }\n";
+
+// Every function that mentions `Pair` has to be rebuilt
+static const char *struct_changed =
+    "struct Pair { int a; int b; int c; }\n"
+    "fn sum(Pair p) -> int { return p.a + p.b; }\n"
+    "fn twice(int x) -> int { return x * 3; }\n"
+    "fn main() -> int { Pair p; p.a = 1; p.b = 2; return twice(sum(p)); }\n";
+
+static bool check(CompileSession *session, LLVMTargetMachineRef tm, const char *source, size_t n_reused) {
+    StringView source_view = mk_sv_c(source);
+    LexResult lexed = lex_sv(&source_view);
+    ParseResult parsed = parse(&lexed.tokens);
+
+    LLVMContextRef context = LLVMContextCreate();
+    CompileResult result = compile_in_session(session, parsed.root, tm, context);
+
+    bool ok = result.status == GRAMINA_COMPILE_ERR_NONE
+           && session->n_reused == n_reused
+           && session->n_reused + session->n_compiled == 3;
+
+    if (ok) {
+        ok = !LLVMVerifyModule(result.module, LLVMReturnStatusAction, NULL);
+
+        const char *names[] = { "sum", "twice", "main" };
+        for (size_t i = 0; ok && i < 3; ++i) {
+            LLVMValueRef fn = LLVMGetNamedFunction(result.module, names[i]);
+            ok = fn && !LLVMIsDeclaration(fn);
+        }
+    }
+
+    if (result.status) {
+        str_free(&result.error.description);
+    } else {
+        LLVMDisposeModule(result.module);
+    }
+
+    LLVMContextDispose(context);
+    parse_result_free(&parsed);
+    lex_result_free(&lexed);
+
+    return ok;
+}
+
+TEST(SessionReuse) {
+    char *triple = LLVMGetDefaultTargetTriple();
+    LLVMTargetRef target;
+    if (LLVMGetTargetFromTriple(triple, &target, NULL)) {
+        LLVMDisposeMessage(triple);
+        test_fail();
+    }
+
+    LLVMTargetMachineRef tm = LLVMCreateTargetMachine(
+        target,
+        triple,
+        "generic",
+        "",
+        LLVMCodeGenLevelNone,
+        LLVMRelocDefault,
+        LLVMCodeModelDefault
+    );
+
+    LLVMDisposeMessage(triple);
+
+    CompileSession session = mk_compile_session();
+
+    bool ok = check(&session, tm, original, 0)
+           && check(&session, tm, original, 3)
+           && check(&session, tm, body_changed, 2)
+           && check(&session, tm, struct_changed, 1);
+
+    compile_session_free(&session);
+    LLVMDisposeTargetMachine(tm);
+
+    if (ok) {
+        test_ok();
+    } else {
+        test_fail();
+    }
+}
@@ -49,3 +49,21 @@ TEST(SliceRef) {
         test_ok();
     }
 }
+
+// `usize` narrows into smaller unsigned types with a warning, but never changes signedness
+TEST(UsizeNarrow) {
+    Stream narrow = mk_stream_open_c("gramina/usize_narrow.lawn", "r");
+    Stream sign = mk_stream_open_c("gramina/usize_sign.lawn", "r");
+
+    bool success_narrow = check_compilation_success(&narrow);
+    bool success_sign = check_compilation_success(&sign);
+
+    stream_free(&narrow);
+    stream_free(&sign);
+
+    if (success_narrow && !success_sign) {
+        test_ok();
+    } else {
+        test_fail();
+    }
+}
@@ -1,9 +1,17 @@
 #include "tester.h"
 
+#include <llvm-c/Core.h>
+#include <llvm-c/Target.h>
+
 #include "compiler/type.h"
 
 static void test_primitives(void) {
-    Type t = type_from_primitive(GRAMINA_PRIMITIVE_BOOL);
+    CompilerState S = {
+        .llvm_context = LLVMGetGlobalContext(),
+        .types = mk_type_table(),
+    };
+
+    Type t = type_from_primitive(&S, GRAMINA_PRIMITIVE_BOOL);
     String s = type_to_str(&t);
 
     if (str_cmp_c(&s, "bool")) {
@@ -22,63 +30,143 @@ static void test_primitives(void) {
     }
 
     str_free(&s);
+    type_table_free(&S.types);
 }
 
 static void test_slice(void) {
-    Type el = type_from_primitive(GRAMINA_PRIMITIVE_BYTE);
-    Type t = mk_slice_type(&el);
+    // Slice lengths are as wide as a pointer
+    CompilerState S = {
+        .llvm_context = LLVMGetGlobalContext(),
+        .llvm_target_data = LLVMCreateTargetData(""),
+        .types = mk_type_table(),
+    };
+
+    Type el = type_from_primitive(&S, GRAMINA_PRIMITIVE_BYTE);
+    Type t = mk_slice_type(&S, &el);
     t.is_const = true;
 
     String s = type_to_str(&t);
+    LLVMDisposeTargetData(S.llvm_target_data);
+
     if (str_cmp_c(&s, "byte const[]")) {
-        type_free(&t);
+        type_table_free(&S.types);
         str_free(&s);
         test_fail();
     }
 
-    type_free(&t);
+    type_table_free(&S.types);
     str_free(&s);
 }
 
 static void test_array(void) {
-    Type el = type_from_primitive(GRAMINA_PRIMITIVE_BYTE);
+    CompilerState S = {
+        .llvm_context = LLVMGetGlobalContext(),
+        .types = mk_type_table(),
+    };
+
+    Type el = type_from_primitive(&S, GRAMINA_PRIMITIVE_BYTE);
     el.is_const = true;
 
-    Type t = mk_array_type(&el, 23);
+    Type t = mk_array_type(&S, &el, 23);
     t.is_const = true;
 
     String s = type_to_str(&t);
     if (str_cmp_c(&s, "const byte const[23]")) {
-        type_free(&t);
+        type_table_free(&S.types);
         str_free(&s);
         test_fail();
     }
 
-    type_free(&t);
+    type_table_free(&S.types);
     str_free(&s);
 }
 
 static void test_ptr(void) {
-    Type el = type_from_primitive(GRAMINA_PRIMITIVE_FLOAT);
-    Type t = mk_pointer_type(&el);
+    CompilerState S = {
+        .llvm_context = LLVMGetGlobalContext(),
+        .types = mk_type_table(),
+    };
+
+    Type el = type_from_primitive(&S, GRAMINA_PRIMITIVE_FLOAT);
+    Type t = mk_pointer_type(&S, &el);
 
     String s = type_to_str(&t);
 
     if (str_cmp_c(&s, "float&")) {
-        type_free(&t);
+        type_table_free(&S.types);
         str_free(&s);
         test_fail();
     }
 
-    type_free(&t);
+    type_table_free(&S.types);
     str_free(&s);
 }
 
+static void test_interning(void) {
+    CompilerState S = {
+        .llvm_context = LLVMGetGlobalContext(),
+        .llvm_target_data = LLVMCreateTargetData(""),
+        .types = mk_type_table(),
+    };
+
+    Type el = type_from_primitive(&S, GRAMINA_PRIMITIVE_INT);
+    Type a = mk_pointer_type(&S, &el);
+    Type b = mk_pointer_type(&S, &el);
+
+    el.is_const = true;
+    Type c = mk_pointer_type(&S, &el);
+
+    Type inner = mk_slice_type(&S, &a);
+    Type outer = mk_slice_type(&S, &c);
+
+    bool ok = a.pointer_type == b.pointer_type
+           && a.pointer_type != c.pointer_type
+           && type_is_same(&a, &c)
+           && type_is_same(&inner, &outer)
+           && inner.slice_type != outer.slice_type;
+
+    // A const copy of a struct still shares the plain struct's fields
+    LLVMTypeRef llvm_pair = LLVMStructCreateNamed(S.llvm_context, "InternPair");
+    LLVMStructSetBody(llvm_pair, (LLVMTypeRef [1]) { LLVMFloatType() }, 1, false);
+
+    Type pair = *type_table_intern(&S.types, &(Type) {
+        .kind = GRAMINA_TYPE_STRUCT,
+        .fields = mk_hashmap(1),
+        .llvm = llvm_pair,
+    });
+
+    Type const_pair = pair;
+    const_pair.is_const = true;
+
+    Type d = mk_pointer_type(&S, &const_pair);
+    Type e = mk_pointer_type(&S, &const_pair);
+
+    ok = ok
+      && d.pointer_type == e.pointer_type
+      && d.pointer_type->is_const
+      && d.pointer_type->fields.items != pair.fields.items;
+
+    type_table_free(&S.types);
+    LLVMDisposeTargetData(S.llvm_target_data);
+
+    // Taking the address of a field of a const struct interns the same copy
+    ok = ok && check_compilation_success_cstr(
+        "struct Inner { float x; }\n"
+        "struct Outer { Inner a; }\n"
+        "fn Get(const Outer& o) -> float { const Inner& p = &o.a; return p.x; }\n"
+    );
+
+    if (!ok) {
+        test_fail();
+    }
+}
+
 void TEST_TypeConstructor() {
     test_primitives();
     test_slice();
     test_array();
     test_ptr();
+    test_interning();
     test_ok();
 }
 
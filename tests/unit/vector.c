@@ -0,0 +1,18 @@
+#include "tester.h"
+
+TEST(Vector) {
+    Stream ok = mk_stream_open_c("gramina/vector_ok.lawn", "r");
+    Stream lane = mk_stream_open_c("gramina/vector_lane.lawn", "r");
+
+    bool success_ok = check_compilation_success(&ok);
+    bool success_lane = check_compilation_success(&lane);
+
+    stream_free(&ok);
+    stream_free(&lane);
+
+    if (success_ok && !success_lane) {
+        test_ok();
+    } else {
+        test_fail();
+    }
+}
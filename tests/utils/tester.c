@@ -68,8 +68,7 @@ bool check_compilation_success(Stream *source) {
         return false;
     }
 
-    Slice(GraminaToken) tokens = array_as_slice(GraminaToken, &lres.tokens);
-    ParseResult pres = parse(&tokens);
+    ParseResult pres = parse(&lres.tokens);
     if (!pres.root) {
         lex_result_free(&lres);
         parse_result_free(&pres);